@@ -0,0 +1,267 @@
+#pragma once
+
+#include "ISingle.h"
+#include "Testing/ArTest20.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief loads every asset once, however many times (and with whatever spelling of the path)
+	 *		  it's asked for, and hands out shared handles to it.
+	 *		  an asset stays loaded while the cache holds it; the cache only lets go of assets nobody
+	 *		  else holds a handle to, least recently requested first, when it goes over its byte budget.
+	 * @tparam TAsset => anything; its size comes from the sizer passed to the constructor.
+	*/
+	template <class TAsset>
+	class AssetCache : Details::ISingle
+	{
+	public:
+
+		using Handle = std::shared_ptr<TAsset const>;
+		using Loader = std::function<TAsset(std::filesystem::path const&)>;
+		using Sizer = std::function<std::size_t(TAsset const&)>;
+
+		constexpr static std::size_t sc_NoBudget{std::numeric_limits<std::size_t>::max()};
+
+	private:
+
+		struct Entry
+		{
+			Handle pAsset;
+			std::size_t bytes;
+			std::uint64_t lastUse;
+		};
+
+	public:
+
+		/**
+		 * @param loader => called on a miss with the normalized path; may throw, nothing is cached then.
+		 * @param sizer => the number of bytes an asset costs, called once per load.
+		 * @param budget => the bytes the cache tries to stay under (see Trim).
+		*/
+		AssetCache(Loader loader, Sizer sizer, std::size_t budget = sc_NoBudget)
+			: loader_{std::move(loader)}, sizer_{std::move(sizer)}, budget_{budget}
+		{
+		}
+
+	public:
+
+		/**
+		 * @brief loads the asset only if it's not in the cache already; trims the cache after loading.
+		*/
+		Handle Get(std::filesystem::path const& path)
+		{
+			auto const normalized{Normalize(path)};
+			auto const key{normalized.native()};
+			if (auto const it{entries_.find(key)}; it != entries_.end())
+			{
+				++hits_;
+				it->second.lastUse = ++clock_;
+				return it->second.pAsset;
+			}
+
+			++misses_;
+			auto pAsset{std::make_shared<TAsset const>(loader_(normalized))};
+			auto const bytes{sizer_(*pAsset)};
+			entries_.emplace(key, Entry{pAsset, bytes, ++clock_});
+			bytes_ += bytes;
+			Trim();
+			return pAsset;
+		}
+
+		/**
+		 * @return true if the path (in any spelling) is loaded.
+		*/
+		bool Contains(std::filesystem::path const& path) const
+		{
+			return entries_.contains(Normalize(path).native());
+		}
+
+		/**
+		 * @brief drops assets nobody holds a handle to, least recently requested first,
+		 *		  until the cache fits in its budget (or only held assets are left).
+		*/
+		void Trim()
+		{
+			if (bytes_ <= budget_)
+			{
+				return;
+			}
+
+			std::vector<typename decltype(entries_)::iterator> unused{};
+			for (auto it{entries_.begin()}; it != entries_.end(); ++it)
+			{
+				if (it->second.pAsset.use_count() == 1)
+				{
+					unused.push_back(it);
+				}
+			}
+			std::ranges::sort(unused, {}, [](auto const& it) { return it->second.lastUse; });
+			for (auto const& it : unused)
+			{
+				if (bytes_ <= budget_)
+				{
+					break;
+				}
+				bytes_ -= it->second.bytes;
+				entries_.erase(it);
+				++evictions_;
+			}
+		}
+
+		/**
+		 * @brief drops every asset nobody holds a handle to, whatever the budget.
+		*/
+		void ReleaseUnused()
+		{
+			std::erase_if(entries_, [this](auto const& pair) {
+				if (pair.second.pAsset.use_count() != 1)
+				{
+					return false;
+				}
+				bytes_ -= pair.second.bytes;
+				++evictions_;
+				return true;
+			});
+		}
+
+		/**
+		 * @brief takes effect right away; a smaller budget trims the cache.
+		*/
+		void SetBudget(std::size_t budget)
+		{
+			budget_ = budget;
+			Trim();
+		}
+
+		/**
+		 * @brief sets hits, misses and evictions back to zero.
+		*/
+		void ResetCounters() noexcept
+		{
+			hits_ = misses_ = evictions_ = 0U;
+		}
+
+		/**
+		 * @return an absolute path without "." or "..", so every spelling of a file maps to one asset.
+		 *		   case does not matter on windows.
+		*/
+		static std::filesystem::path Normalize(std::filesystem::path const& path)
+		{
+			auto normalized{std::filesystem::absolute(path).lexically_normal()};
+#ifdef _WIN32
+			auto str{normalized.native()};
+			std::ranges::transform(str, str.begin(), [](wchar_t c) {
+				return c < 128 ? static_cast<wchar_t>(std::tolower(static_cast<int>(c))) : c;
+			});
+			normalized = std::move(str);
+#endif
+			return normalized;
+		}
+
+	public:
+
+		/**
+		 * @return the bytes of every loaded asset, held or not.
+		*/
+		std::size_t Bytes() const noexcept
+		{ return bytes_; }
+
+		std::size_t Budget() const noexcept
+		{ return budget_; }
+
+		/**
+		 * @return true when held assets alone do not fit in the budget.
+		*/
+		bool IsOverBudget() const noexcept
+		{ return bytes_ > budget_; }
+
+		std::size_t Size() const noexcept
+		{ return entries_.size(); }
+
+		std::uint64_t Hits() const noexcept
+		{ return hits_; }
+
+		std::uint64_t Misses() const noexcept
+		{ return misses_; }
+
+		std::uint64_t Evictions() const noexcept
+		{ return evictions_; }
+
+	private:
+		Loader loader_;
+		Sizer sizer_;
+		std::unordered_map<std::filesystem::path::string_type, Entry> entries_{};
+
+		std::size_t budget_;
+		std::size_t bytes_{};
+		// bumped on every request, orders entries by their last use.
+		std::uint64_t clock_{};
+
+		std::uint64_t hits_{};
+		std::uint64_t misses_{};
+		std::uint64_t evictions_{};
+	};
+
+	inline void TestAssetCache()
+	{
+		using namespace ArTest;
+		std::ofstream file{"AssetCacheTestResults.txt"};
+		Tester tester{file};
+
+		// the "asset" is its own path, and costs as many bytes as the path has characters.
+		std::size_t loads{};
+		auto const loader = [&](std::filesystem::path const& path) { ++loads; return path.string(); };
+		auto const sizer = [](std::string const& asset) { return asset.size(); };
+
+		tester.NewTest("Every spelling loads once") = [&] {
+			loads = 0U;
+			AssetCache<std::string> cache{loader, sizer};
+			auto const a{cache.Get("Resources/car.png")};
+			auto const b{cache.Get("Resources/./sub/../car.png")};
+			tester.PassIf(a == b);
+			tester.PassIfEqual(std::size_t{loads}, std::size_t{1U});
+			tester.PassIfEqual(cache.Hits(), std::uint64_t{1U});
+			tester.PassIfEqual(cache.Bytes(), a->size());
+			tester.PassIf(cache.Contains("Resources//car.png"));
+		};
+
+		tester.NewTest("Budget only evicts unused assets") = [&] {
+			loads = 0U;
+			AssetCache<std::string> cache{loader, sizer};
+			auto const pHeld{cache.Get("own")};
+			cache.Get("old");
+			cache.Get("new");
+			auto const oneAsset{cache.Bytes() / 3U};
+			cache.SetBudget(oneAsset * 2U);
+			// "old" was requested before "new", so it goes first.
+			tester.PassIfEqual(cache.Size(), std::size_t{2U});
+			tester.PassIf(not cache.Contains("old"));
+			tester.PassIf(cache.Contains("new"));
+
+			cache.SetBudget(0U);
+			tester.PassIf(cache.Contains("own"));
+			tester.PassIf(cache.IsOverBudget());
+			tester.PassIfEqual(cache.Evictions(), std::uint64_t{2U});
+
+			cache.SetBudget(AssetCache<std::string>::sc_NoBudget);
+			cache.Get("new");
+			tester.PassIfEqual(std::size_t{loads}, std::size_t{4U});
+			cache.ReleaseUnused();
+			tester.PassIfEqual(cache.Size(), std::size_t{1U});
+			tester.PassIfEqual(cache.Bytes(), pHeld->size());
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -0,0 +1,41 @@
+#include "CachedGeometry.h"
+
+#include <algorithm>
+
+namespace ArEngine2D {
+	CachedGeometry::CachedGeometry(Details::Ptr<ID2D1PathGeometry> pGeometry, std::span<Vec2 const> vertices)
+		: pGeometry_{std::move(pGeometry)}, vertices_{vertices.begin(), vertices.end()}
+	{
+		assert(not vertices.empty() && "Tried to cache an empty geometry");
+		bounds_ = {vertices[0].x, vertices[0].y, vertices[0].x, vertices[0].y};
+		for (auto const& vert : vertices)
+		{
+			bounds_.left   = std::min(bounds_.left, vert.x);
+			bounds_.top    = std::min(bounds_.top, vert.y);
+			bounds_.right  = std::max(bounds_.right, vert.x);
+			bounds_.bottom = std::max(bounds_.bottom, vert.y);
+		}
+	}
+	bool CachedGeometry::Matches(std::span<Vec2 const> vertices) const noexcept
+	{
+		return std::ranges::equal(vertices_, vertices, [](Vec2 const& lhs, Vec2 const& rhs) {
+			return lhs.x == rhs.x and lhs.y == rhs.y;
+		});
+	}
+	bool CachedGeometry::IsInitialized() const noexcept
+	{
+		return pGeometry_;
+	}
+	std::span<Vec2 const> CachedGeometry::Vertices() const noexcept
+	{
+		return vertices_;
+	}
+	D2D1_RECT_F CachedGeometry::Bounds() const noexcept
+	{
+		return bounds_;
+	}
+	Details::Ptr<ID2D1PathGeometry> const& CachedGeometry::D2DPtr() const noexcept
+	{
+		return pGeometry_;
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include "ImplUtil.h"
+#include "Vec2.h"
+
+#include <d2d1.h>
+
+#include <span>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief a closed polygon turned into a direct2d path geometry once, so it can be drawn
+	 *		  (or filled) any number of times without rebuilding it.
+	 *		  copies share the same geometry.
+	*/
+	class CachedGeometry
+	{
+	private:
+		using self = CachedGeometry;
+
+	public:
+
+		CachedGeometry() = default;
+
+		/**
+		 * @brief users may not call this; use Grafix::CacheGeometry instead.
+		*/
+		CachedGeometry(Details::Ptr<ID2D1PathGeometry> pGeometry, std::span<Vec2 const> vertices);
+
+		CachedGeometry(self const&)			   = default;
+		CachedGeometry(self&&) noexcept		   = default;
+		self& operator=(self const&)		   = default;
+		self& operator=(self&&) noexcept	   = default;
+
+	public:
+
+		/**
+		 * @return true if the geometry was built with the exact same vertices.
+		*/
+		bool Matches(std::span<Vec2 const> vertices) const noexcept;
+
+		/**
+		 * @return true if the geometry was built.
+		*/
+		bool IsInitialized() const noexcept;
+
+	public:
+
+		/**
+		 * @return the vertices the geometry was built from.
+		*/
+		std::span<Vec2 const> Vertices() const noexcept;
+
+		/**
+		 * @return the axis aligned bounding box of the vertices (before any transformation).
+		*/
+		D2D1_RECT_F Bounds() const noexcept;
+
+		/**
+		 * @return a pointer to the direct2d geometry; users may not release the data through this pointer.
+		*/
+		Details::Ptr<ID2D1PathGeometry> const& D2DPtr() const noexcept;
+
+	private:
+		Details::Ptr<ID2D1PathGeometry> pGeometry_{};
+		std::vector<Vec2> vertices_{};
+		D2D1_RECT_F bounds_{};
+	};
+}
@@ -1,9 +1,10 @@
 #include "Car.h"
 
 namespace ArTran {
-	void Car::Initialize(std::wstring_view spriteFileName)
+	void Car::Initialize(Sprite const& sprite)
 	{
-		image_.Initialize(spriteFileName);
+		// shares the bitmap.
+		image_ = sprite;
 	}
 	void Car::Accelerate(float force)
 	{
@@ -18,7 +18,7 @@ namespace ArTran {
 
 	public:
 
-		void Initialize(std::wstring_view spriteFileName);
+		void Initialize(Sprite const& sprite);
 		void Accelerate(float force);
 		void Decelerate(float force);
 		void ShiftToNextGear();
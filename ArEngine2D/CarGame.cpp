@@ -3,7 +3,7 @@
 namespace ArTran {
 	void CarGame::OnUserCreate()
 	{
-		car_.Initialize(L"Resources\\car.png");
+		car_.Initialize(*zoomedSprites_.Get(L"Resources\\car.png"));
 	}
 
 	void CarGame::OnUserUpdate(float dt)
@@ -17,24 +17,22 @@ namespace ArTran {
 	void CarGame::OnUserDraw(Grafix& gfx)
 	{
 		gfx.ClearScreen(Colors::DarkOrange);
-		auto const topTran{Transform{}.Rotate(arrowAngle_).Translate(mouse.loc)};
-		gfx.PushTransform(topTran);
-		{
-			Vec2 const headLoc{200.f, 0.f};
-			gfx.DrawArrow({}, headLoc, Colors::MediumPurple, 5.f);
+		// the big arrow follows the mouse, and the small one spins on top of its head.
+		Vec2 const headLoc{200.f, 0.f};
+		auto const bigTran{Transform{}.Rotate(arrowAngle_).Translate(mouse.loc)};
+		gfx.DefineLayer("big arrow", 1, bigTran);
+		gfx.DefineLayer("small arrow", 2, bigTran >> Transform{}
+			.Translate(-mouse.loc)
+			.Translate(headLoc)
+			.Rotate(arrowAngle_)
+			.Translate(mouse.loc)
+		);
 
-			gfx.PushTransform(Transform{}
-				.Translate(-mouse.loc)
-				.Translate(headLoc)
-				.Rotate(arrowAngle_)
-				.Translate(mouse.loc)
-			);
-			{
-				gfx.DrawArrow({}, headLoc * 0.5f, Colors::Yellow, 3.f);
-				gfx.PopTransform();
-			}
-			gfx.PopTransform();
-		}
+		gfx.UseLayer("big arrow");
+		gfx.DrawArrow({}, headLoc, Colors::MediumPurple, 5.f);
+		gfx.UseLayer("small arrow");
+		gfx.DrawArrow({}, headLoc * 0.5f, Colors::Yellow, 3.f);
+		gfx.UseLayer(Grafix::sc_DefaultLayer);
 
 		//car_.Draw(gfx, 5.f);
 	}
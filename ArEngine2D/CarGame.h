@@ -22,6 +22,8 @@ namespace ArTran {
 		void UpdateInput(float dt);
 
 	private:
+		// the car is drawn scaled, so it's loaded with mip levels.
+		SpriteCache zoomedSprites_{SpriteCache::sc_NoBudget, true};
 		Car car_{};
 
 		float arrowAngle_{};
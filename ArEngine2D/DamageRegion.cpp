@@ -0,0 +1,157 @@
+#include "DamageRegion.h"
+
+#include "SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace ArEngine2D {
+	namespace {
+		float AreaOf(RawRect const& rect) noexcept
+		{
+			return rect.Width() * rect.Height();
+		}
+	}
+
+	DamageRegion::DamageRegion(RawRect const& bounds)
+		: bounds_{bounds}
+	{ }
+	void DamageRegion::SetBounds(RawRect const& bounds)
+	{
+		bounds_ = bounds;
+		rects_.clear();
+	}
+	void DamageRegion::Add(RawRect const& rect)
+	{
+		// whole pixels, so the rects stay exact and clipping to them never leaves seams.
+		Insert(RawRect{
+			std::floor(rect.left), std::floor(rect.top), std::ceil(rect.right), std::ceil(rect.bottom)
+		}.Intersection(bounds_));
+	}
+	void DamageRegion::AddAll()
+	{
+		rects_.clear();
+		Insert(bounds_);
+	}
+	void DamageRegion::Clear() noexcept
+	{
+		rects_.clear();
+	}
+	void DamageRegion::AddChanges(DrawCommandBuffer const& before, std::span<std::uint64_t const> beforeImages,
+		DrawCommandBuffer const& after, std::span<std::uint64_t const> afterImages)
+	{
+		auto const lhs{before.Commands()};
+		auto const rhs{after.Commands()};
+		auto const same = [&](std::size_t l, std::size_t r) {
+			return DrawCommandBuffer::SameDrawing(before, lhs[l], after, rhs[r]) and
+				(lhs[l].kind != DrawCommandKind::Sprite or beforeImages[lhs[l].resource] == afterImages[rhs[r].resource]);
+		};
+
+		// a command added or removed only shifts the ones after it, which still draw the same
+		// pixels in the same order; only what is between the common ends can have changed.
+		auto const shorter{std::min(lhs.size(), rhs.size())};
+		std::size_t prefix{};
+		while (prefix < shorter and same(prefix, prefix))
+		{
+			++prefix;
+		}
+		std::size_t suffix{};
+		while (suffix < shorter - prefix and same(lhs.size() - 1U - suffix, rhs.size() - 1U - suffix))
+		{
+			++suffix;
+		}
+
+		auto const lhsCount{lhs.size() - prefix - suffix};
+		auto const rhsCount{rhs.size() - prefix - suffix};
+		for (std::size_t i{prefix}, lim{prefix + std::max(lhsCount, rhsCount)}; i < lim; ++i)
+		{
+			auto const bInBefore{i < prefix + lhsCount};
+			auto const bInAfter{i < prefix + rhsCount};
+			if (bInBefore and bInAfter and same(i, i))
+			{
+				continue;
+			}
+
+			if (bInBefore)
+			{
+				Add(SoftwareRasterizer::DeviceBounds(before, lhs[i]));
+			}
+			if (bInAfter)
+			{
+				Add(SoftwareRasterizer::DeviceBounds(after, rhs[i]));
+			}
+		}
+	}
+	std::span<RawRect const> DamageRegion::Rects() const noexcept
+	{
+		return rects_;
+	}
+	bool DamageRegion::IsEmpty() const noexcept
+	{
+		return rects_.empty();
+	}
+	std::uint64_t DamageRegion::Area() const noexcept
+	{
+		std::uint64_t area{};
+		for (auto const& rect : rects_)
+		{
+			area += static_cast<std::uint64_t>(AreaOf(rect));
+		}
+		return area;
+	}
+	RawRect const& DamageRegion::Bounds() const noexcept
+	{
+		return bounds_;
+	}
+	void DamageRegion::Insert(RawRect rect)
+	{
+		if (rect.IsEmpty())
+		{
+			return;
+		}
+
+		// swallow everything the rect overlaps; the union may overlap more, so go again.
+		for (auto it{rects_.begin()}; it != rects_.end();)
+		{
+			if (it->Intersects(rect))
+			{
+				rect = rect.Union(*it);
+				rects_.erase(it);
+				it = rects_.begin();
+			}
+			else
+			{
+				++it;
+			}
+		}
+		rects_.push_back(rect);
+
+		if (rects_.size() <= sc_MaxRects)
+		{
+			return;
+		}
+
+		// too many; merge the pair that adds the least area.
+		std::size_t bestI{};
+		std::size_t bestJ{1U};
+		auto bestGrowth{std::numeric_limits<float>::max()};
+		for (std::size_t i{}; i < rects_.size(); ++i)
+		{
+			for (auto j{i + 1U}; j < rects_.size(); ++j)
+			{
+				auto const growth{AreaOf(rects_[i].Union(rects_[j])) - AreaOf(rects_[i]) - AreaOf(rects_[j])};
+				if (growth < bestGrowth)
+				{
+					bestGrowth = growth;
+					bestI = i;
+					bestJ = j;
+				}
+			}
+		}
+		auto const merged{rects_[bestI].Union(rects_[bestJ])};
+		rects_.erase(rects_.begin() + static_cast<std::ptrdiff_t>(bestJ));
+		rects_.erase(rects_.begin() + static_cast<std::ptrdiff_t>(bestI));
+		Insert(merged);
+	}
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#include "RawTypes.h"
+#include "DrawCommandBuffer.h"
+#include "Testing/ArTest20.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief the parts of a frame that have to be drawn again, as a few non overlapping rectangles
+	 *		  snapped to whole pixels and kept inside the bounds of the target.
+	 *		  does not depend on direct2d; Grafix uses it for retained mode.
+	*/
+	class DamageRegion
+	{
+	public:
+
+		// past this, the two rectangles that grow the least when merged are merged.
+		constexpr static std::size_t sc_MaxRects{8U};
+
+	public:
+
+		DamageRegion() = default;
+		explicit DamageRegion(RawRect const& bounds);
+
+	public:
+
+		/**
+		 * @brief the damage is cleared as well.
+		*/
+		void SetBounds(RawRect const& bounds);
+
+		void Add(RawRect const& rect);
+		void AddAll();
+		void Clear() noexcept;
+
+		/**
+		 * @brief skips the commands both lists start and end with, compares the rest position by
+		 *		  position, and damages the bounds of every command that changed (where it was, and
+		 *		  where it is now), or that only one of them has. so a command added or removed
+		 *		  anywhere only damages itself, as long as the others stay the same.
+		 * @param beforeImages, afterImages => tell sprite images apart; the resource of every sprite
+		 *		  command is an index into them, and equal values mean the same image.
+		*/
+		void AddChanges(DrawCommandBuffer const& before, std::span<std::uint64_t const> beforeImages,
+			DrawCommandBuffer const& after, std::span<std::uint64_t const> afterImages
+		);
+
+	public:
+
+		std::span<RawRect const> Rects() const noexcept;
+		bool IsEmpty() const noexcept;
+
+		/**
+		 * @return the number of damaged pixels.
+		*/
+		std::uint64_t Area() const noexcept;
+
+		RawRect const& Bounds() const noexcept;
+
+	private:
+		void Insert(RawRect rect);
+
+	private:
+		RawRect bounds_{};
+		std::vector<RawRect> rects_{};
+	};
+
+	inline void TestDamageRegion()
+	{
+		using namespace ArTest;
+		std::ofstream file{"DamageRegionTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Snapping and clamping") = [&] {
+			DamageRegion region{{0.f, 0.f, 100.f, 50.f}};
+			region.Add({10.4f, 10.6f, 19.2f, 20.f});
+			region.Add({90.f, 40.f, 150.f, 70.f});
+			region.Add({200.f, 0.f, 300.f, 10.f});
+			tester.PassIfEqual(region.Rects().size(), std::size_t{2U});
+			tester.PassIf(region.Rects()[0] == RawRect{10.f, 10.f, 20.f, 20.f});
+			tester.PassIf(region.Rects()[1] == RawRect{90.f, 40.f, 100.f, 50.f});
+			tester.PassIfEqual(region.Area(), std::uint64_t{100U + 100U});
+
+			region.AddAll();
+			tester.PassIfEqual(region.Rects().size(), std::size_t{1U});
+			tester.PassIfEqual(region.Area(), std::uint64_t{5000U});
+			region.Clear();
+			tester.PassIf(region.IsEmpty());
+		};
+
+		tester.NewTest("Overlaps merge") = [&] {
+			DamageRegion region{{0.f, 0.f, 100.f, 100.f}};
+			region.Add({0.f, 0.f, 10.f, 10.f});
+			region.Add({20.f, 0.f, 30.f, 10.f});
+			// touches both, so everything becomes one rect.
+			region.Add({5.f, 5.f, 25.f, 6.f});
+			tester.PassIfEqual(region.Rects().size(), std::size_t{1U});
+			tester.PassIf(region.Rects()[0] == RawRect{0.f, 0.f, 30.f, 10.f});
+
+			for (int i{}; i < 20; ++i)
+			{
+				auto const f{static_cast<float>(i * 4)};
+				region.Add({f, 50.f, f + 1.f, 51.f});
+			}
+			tester.PassIfLessEq(region.Rects().size(), std::size_t{DamageRegion::sc_MaxRects});
+		};
+
+		tester.NewTest("Command changes") = [&] {
+			DamageRegion region{{0.f, 0.f, 100.f, 100.f}};
+			DrawCommandBuffer before{};
+			DrawCommandBuffer after{};
+			for (auto* pBuffer : {&before, &after})
+			{
+				pBuffer->SetColor({1.f, 0.f, 0.f, 1.f});
+				pBuffer->AddRectangle({10.f, 10.f, 20.f, 20.f}, 1.f, true);
+				pBuffer->AddSprite(0U, {50.f, 50.f, 60.f, 60.f}, {0.f, 0.f, 10.f, 10.f}, 1.f, 0U);
+			}
+			std::uint64_t const images[]{7U};
+			region.AddChanges(before, images, after, images);
+			tester.PassIf(region.IsEmpty());
+
+			// only the image changes.
+			std::uint64_t const otherImages[]{8U};
+			region.AddChanges(before, images, after, otherImages);
+			tester.PassIfEqual(region.Rects().size(), std::size_t{1U});
+			tester.PassIf(region.Rects()[0] == RawRect{49.f, 49.f, 61.f, 61.f});
+
+			// the rectangle moves, and a line is added.
+			region.Clear();
+			after.Reset();
+			after.SetColor({1.f, 0.f, 0.f, 1.f});
+			after.AddRectangle({30.f, 10.f, 40.f, 20.f}, 1.f, true);
+			after.AddSprite(0U, {50.f, 50.f, 60.f, 60.f}, {0.f, 0.f, 10.f, 10.f}, 1.f, 0U);
+			after.AddLine({0.f, 90.f}, {10.f, 90.f}, 2.f);
+			region.AddChanges(before, images, after, images);
+			tester.PassIfEqual(region.Rects().size(), std::size_t{3U});
+			// the line is clamped at the left edge.
+			tester.PassIfEqual(region.Area(), std::uint64_t{12U * 12U * 2U + 12U * 4U});
+		};
+
+		tester.NewTest("Inserted commands only damage themselves") = [&] {
+			DamageRegion region{{0.f, 0.f, 100.f, 100.f}};
+			DrawCommandBuffer before{};
+			DrawCommandBuffer after{};
+			after.SetColor({0.f, 1.f, 0.f, 1.f});
+			after.AddRectangle({0.f, 0.f, 10.f, 10.f}, 1.f, true);
+			for (auto* pBuffer : {&before, &after})
+			{
+				pBuffer->SetColor({1.f, 0.f, 0.f, 1.f});
+				for (int i{}; i < 8; ++i)
+				{
+					auto const f{static_cast<float>(i * 10)};
+					pBuffer->AddRectangle({f, 50.f, f + 5.f, 55.f}, 1.f, true);
+				}
+			}
+			std::uint64_t const images[]{0U};
+			region.AddChanges(before, images, after, images);
+			// a pixel of margin around it, clamped at the corner.
+			tester.PassIfEqual(region.Area(), std::uint64_t{11U * 11U});
+
+			// and removed from the middle.
+			region.Clear();
+			DrawCommandBuffer removed{};
+			removed.SetColor({0.f, 1.f, 0.f, 1.f});
+			removed.AddRectangle({0.f, 0.f, 10.f, 10.f}, 1.f, true);
+			removed.SetColor({1.f, 0.f, 0.f, 1.f});
+			for (int i{}; i < 8; ++i)
+			{
+				if (i != 3)
+				{
+					auto const f{static_cast<float>(i * 10)};
+					removed.AddRectangle({f, 50.f, f + 5.f, 55.f}, 1.f, true);
+				}
+			}
+			region.AddChanges(after, images, removed, images);
+			tester.PassIfEqual(region.Area(), std::uint64_t{7U * 7U});
+		};
+
+		tester.OutputResults();
+	}
+}
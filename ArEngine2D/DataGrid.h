@@ -110,7 +110,7 @@ namespace ArFac {
 		 * @return a reference to the element at that column and row.
 		*/
 		constexpr TElement const& At(std::size_t col, std::size_t row) const noexcept
-		{ return const_cast<self&>(*this).AT(col, row); }
+		{ return const_cast<self&>(*this).At(col, row); }
 
 		/**
 		 * @brief calling this with an invalid Coord is undefined.
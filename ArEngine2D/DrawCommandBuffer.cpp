@@ -0,0 +1,338 @@
+#include "DrawCommandBuffer.h"
+
+#include "Hash.h"
+#include "RadixSort.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace ArEngine2D {
+	void DrawCommandBuffer::SetTransform(RawMatrix const& transform)
+	{
+		if (not transforms_.empty() and transforms_[currTransform_] == transform)
+		{
+			return;
+		}
+
+		auto const hash{Details::Hash::Value(transform)};
+		if (auto const it{transformLut_.find(hash)};
+			it != transformLut_.end() and transforms_[it->second] == transform)
+		{
+			currTransform_ = it->second;
+			return;
+		}
+
+		currTransform_ = static_cast<std::uint32_t>(transforms_.size());
+		transforms_.push_back(transform);
+		// on a (very unlikely) collision the old entry stays, the new one just won't be shared.
+		transformLut_.try_emplace(hash, currTransform_);
+	}
+
+	void DrawCommandBuffer::SetColor(RawColor const& color)
+	{
+		if (not colors_.empty() and colors_[currColor_] == color)
+		{
+			return;
+		}
+
+		auto const hash{Details::Hash::Value(color)};
+		if (auto const it{colorLut_.find(hash)};
+			it != colorLut_.end() and colors_[it->second] == color)
+		{
+			currColor_ = it->second;
+			return;
+		}
+
+		currColor_ = static_cast<std::uint32_t>(colors_.size());
+		colors_.push_back(color);
+		colorLut_.try_emplace(hash, currColor_);
+	}
+
+	void DrawCommandBuffer::SetLayer(std::int16_t layer) noexcept
+	{
+		currLayer_ = layer;
+	}
+
+	void DrawCommandBuffer::SetDepth(std::int16_t depth) noexcept
+	{
+		currDepth_ = depth;
+	}
+
+	void DrawCommandBuffer::AddClear(RawColor const& color)
+	{
+		SetColor(color);
+		NewCommand(DrawCommandKind::Clear);
+	}
+
+	void DrawCommandBuffer::AddLine(RawPoint const& from, RawPoint const& to, float thick)
+	{
+		auto& cmd{NewCommand(DrawCommandKind::Line)};
+		cmd.data[0] = from.x;
+		cmd.data[1] = from.y;
+		cmd.data[2] = to.x;
+		cmd.data[3] = to.y;
+		cmd.data[4] = thick;
+	}
+
+	void DrawCommandBuffer::AddEllipse(RawPoint const& center, float rx, float ry, float thick, bool bFill)
+	{
+		auto& cmd{NewCommand(bFill ? DrawCommandKind::FillEllipse : DrawCommandKind::DrawEllipse)};
+		cmd.data[0] = center.x;
+		cmd.data[1] = center.y;
+		cmd.data[2] = rx;
+		cmd.data[3] = ry;
+		cmd.data[4] = thick;
+	}
+
+	void DrawCommandBuffer::AddRectangle(RawRect const& rect, float thick, bool bFill)
+	{
+		auto& cmd{NewCommand(bFill ? DrawCommandKind::FillRectangle : DrawCommandKind::DrawRectangle)};
+		cmd.data[0] = rect.left;
+		cmd.data[1] = rect.top;
+		cmd.data[2] = rect.right;
+		cmd.data[3] = rect.bottom;
+		cmd.data[4] = thick;
+	}
+
+	void DrawCommandBuffer::AddPolygon(std::span<RawPoint const> vertices, float thick, bool bFill)
+	{
+		auto& cmd{NewCommand(bFill ? DrawCommandKind::FillPolygon : DrawCommandKind::DrawPolygon)};
+		cmd.resource = PackRange(vertexPool_.size(), vertices.size());
+		cmd.data[4] = thick;
+		vertexPool_.insert(vertexPool_.end(), vertices.begin(), vertices.end());
+	}
+
+	void DrawCommandBuffer::AddSprite(std::uint64_t image, RawRect const& dest, RawRect const& src, float opacity, std::uint8_t interpolation)
+	{
+		auto& cmd{NewCommand(DrawCommandKind::Sprite)};
+		cmd.flags = interpolation;
+		cmd.resource = image;
+		cmd.data[0] = dest.left;
+		cmd.data[1] = dest.top;
+		cmd.data[2] = dest.right;
+		cmd.data[3] = dest.bottom;
+		cmd.data[4] = src.left;
+		cmd.data[5] = src.top;
+		cmd.data[6] = src.right;
+		cmd.data[7] = src.bottom;
+		cmd.data[8] = opacity;
+	}
+
+	void DrawCommandBuffer::AddText(std::string_view text, RawRect const& rect, float size, std::uint32_t fontFamily, std::uint8_t fontWeight,
+		RawPoint const& extent)
+	{
+		auto& cmd{NewCommand(DrawCommandKind::Text)};
+		cmd.flags = fontWeight;
+		cmd.resource = PackRange(textPool_.size(), text.size());
+		cmd.data[0] = rect.left;
+		cmd.data[1] = rect.top;
+		cmd.data[2] = rect.right;
+		cmd.data[3] = rect.bottom;
+		cmd.data[4] = size;
+		// font ids are tiny, so this is exact.
+		cmd.data[5] = static_cast<float>(fontFamily);
+		cmd.data[6] = extent.x;
+		cmd.data[7] = extent.y;
+		textPool_.append(text);
+	}
+
+	void DrawCommandBuffer::Sort()
+	{
+		std::size_t segBegin{};
+		while (segBegin < commands_.size())
+		{
+			auto const segEnd{static_cast<std::size_t>(std::find_if(commands_.begin() + segBegin, commands_.end(), 
+				[](DrawCommand const& cmd) { return cmd.kind == DrawCommandKind::Clear; }
+			) - commands_.begin())};
+			SortRange(segBegin, segEnd);
+			segBegin = segEnd + 1U;
+		}
+	}
+
+	void DrawCommandBuffer::SortRange(std::size_t first, std::size_t last)
+	{
+		auto const count{last - first};
+		if (count < 2U)
+		{
+			return;
+		}
+
+		sortKeys_.resize(count);
+		sortOrder_.resize(count);
+		for (std::size_t i{}; i < count; ++i)
+		{
+			sortKeys_[i] = SortKey(commands_[first + i]);
+			sortOrder_[i] = static_cast<std::uint32_t>(i);
+		}
+		Details::RadixSort::Sort(sortKeys_, sortOrder_, sortKeysScratch_, sortOrderScratch_);
+
+		sortedCommands_.clear();
+		for (auto const index : sortOrder_)
+		{
+			sortedCommands_.push_back(commands_[first + index]);
+		}
+		std::ranges::copy(sortedCommands_, commands_.begin() + static_cast<std::ptrdiff_t>(first));
+	}
+
+	void DrawCommandBuffer::Reset()
+	{
+		commands_.clear();
+		transforms_.clear();
+		colors_.clear();
+		transformLut_.clear();
+		colorLut_.clear();
+		vertexPool_.clear();
+		textPool_.clear();
+		currLayer_ = 0;
+		currDepth_ = 0;
+
+		SetTransform(RawMatrix::Identity());
+		SetColor({0.f, 0.f, 0.f, 1.f});
+	}
+
+	std::span<DrawCommand const> DrawCommandBuffer::Commands() const noexcept
+	{
+		return commands_;
+	}
+
+	std::size_t DrawCommandBuffer::Size() const noexcept
+	{
+		return commands_.size();
+	}
+
+	bool DrawCommandBuffer::IsEmpty() const noexcept
+	{
+		return commands_.empty();
+	}
+
+	std::int16_t DrawCommandBuffer::Layer() const noexcept
+	{
+		return currLayer_;
+	}
+
+	std::int16_t DrawCommandBuffer::Depth() const noexcept
+	{
+		return currDepth_;
+	}
+
+	RawMatrix const& DrawCommandBuffer::TransformOf(DrawCommand const& command) const noexcept
+	{
+		assert(command.transform < transforms_.size() && "DrawCommand from another buffer");
+		return transforms_[command.transform];
+	}
+
+	RawColor const& DrawCommandBuffer::ColorOf(DrawCommand const& command) const noexcept
+	{
+		assert(command.color < colors_.size() && "DrawCommand from another buffer");
+		return colors_[command.color];
+	}
+
+	std::span<RawPoint const> DrawCommandBuffer::VerticesOf(DrawCommand const& command) const noexcept
+	{
+		assert((command.kind == DrawCommandKind::DrawPolygon or command.kind == DrawCommandKind::FillPolygon) &&
+			"Only polygons have vertices");
+		return std::span{vertexPool_}.subspan(RangeFirst(command.resource), RangeCount(command.resource));
+	}
+
+	std::string_view DrawCommandBuffer::TextOf(DrawCommand const& command) const noexcept
+	{
+		assert(command.kind == DrawCommandKind::Text && "Only text commands have text");
+		return std::string_view{textPool_}.substr(RangeFirst(command.resource), RangeCount(command.resource));
+	}
+
+	DrawCommandBuffer::StateChanges DrawCommandBuffer::CountStateChanges() const noexcept
+	{
+		StateChanges changes{};
+		DrawCommand const* pLast{};
+		for (auto const& cmd : commands_)
+		{
+			if (cmd.kind == DrawCommandKind::Clear)
+			{
+				continue;
+			}
+			changes.transformChanges += (not pLast or pLast->transform != cmd.transform);
+			changes.colorChanges += (not pLast or pLast->color != cmd.color);
+			pLast = &cmd;
+		}
+		return changes;
+	}
+
+	bool DrawCommandBuffer::SameDrawing(DrawCommandBuffer const& lhsBuffer, DrawCommand const& lhs,
+		DrawCommandBuffer const& rhsBuffer, DrawCommand const& rhs) noexcept
+	{
+		// bitwise, so a NaN is never "changed" one frame and "the same" the next.
+		if (lhs.kind != rhs.kind or lhs.flags != rhs.flags or std::memcmp(lhs.data, rhs.data, sizeof(lhs.data)) != 0)
+		{
+			return false;
+		}
+		if (lhs.kind != DrawCommandKind::Clear and lhsBuffer.TransformOf(lhs) != rhsBuffer.TransformOf(rhs))
+		{
+			return false;
+		}
+		if (lhs.kind != DrawCommandKind::Sprite and lhsBuffer.ColorOf(lhs) != rhsBuffer.ColorOf(rhs))
+		{
+			return false;
+		}
+
+		switch (lhs.kind)
+		{
+		case DrawCommandKind::DrawPolygon:
+		case DrawCommandKind::FillPolygon:
+			return std::ranges::equal(lhsBuffer.VerticesOf(lhs), rhsBuffer.VerticesOf(rhs));
+		case DrawCommandKind::Text:
+			return lhsBuffer.TextOf(lhs) == rhsBuffer.TextOf(rhs);
+		default:
+			return true;
+		}
+	}
+
+	DrawCommand& DrawCommandBuffer::NewCommand(DrawCommandKind kind)
+	{
+		// first use without a Reset, and nothing was set yet.
+		if (transforms_.empty())
+		{
+			SetTransform(RawMatrix::Identity());
+		}
+		if (colors_.empty())
+		{
+			SetColor({0.f, 0.f, 0.f, 1.f});
+		}
+
+		auto& cmd{commands_.emplace_back()};
+		cmd.kind = kind;
+		cmd.layer = currLayer_;
+		cmd.depth = currDepth_;
+		cmd.transform = currTransform_;
+		cmd.color = currColor_;
+		return cmd;
+	}
+
+	std::uint64_t DrawCommandBuffer::SortKey(DrawCommand const& command) noexcept
+	{
+		constexpr std::uint32_t MaxState{(1U << 14U) - 1U};
+		// flipping the sign bit makes signed values sort as unsigned ones.
+		auto const layer{static_cast<std::uint16_t>(command.layer) ^ 0x8000U};
+		auto const depth{static_cast<std::uint16_t>(command.depth) ^ 0x8000U};
+		return (static_cast<std::uint64_t>(layer) << 48U)
+			| (static_cast<std::uint64_t>(depth) << 32U)
+			| (static_cast<std::uint64_t>(std::min(command.transform, MaxState)) << 18U)
+			| (static_cast<std::uint64_t>(std::min(command.color, MaxState)) << 4U)
+			| static_cast<std::uint64_t>(command.kind);
+	}
+
+	std::uint64_t DrawCommandBuffer::PackRange(std::size_t first, std::size_t count) noexcept
+	{
+		return (static_cast<std::uint64_t>(first) << 32U) | static_cast<std::uint32_t>(count);
+	}
+
+	std::size_t DrawCommandBuffer::RangeFirst(std::uint64_t range) noexcept
+	{
+		return static_cast<std::size_t>(range >> 32U);
+	}
+
+	std::size_t DrawCommandBuffer::RangeCount(std::uint64_t range) noexcept
+	{
+		return static_cast<std::size_t>(range & 0xFFFF'FFFFU);
+	}
+}
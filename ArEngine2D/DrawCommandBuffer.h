@@ -0,0 +1,356 @@
+#pragma once
+
+#include "RawTypes.h"
+#include "Testing/ArTest20.h"
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ArEngine2D {
+	enum class DrawCommandKind : std::uint8_t
+	{
+		Clear,
+		Line,
+		DrawEllipse,
+		FillEllipse,
+		DrawRectangle,
+		FillRectangle,
+		DrawPolygon,
+		FillPolygon,
+		Sprite,
+		Text,
+	};
+
+	/**
+	 * @brief a single recorded draw call. what data means depends on the kind:
+	 *		  Line:				 Point(0) = from, Point(1) = to, data[4] = thickness.
+	 *		  Draw/FillEllipse:	 Point(0) = center, Point(1) = radii, data[4] = thickness.
+	 *		  Draw/FillRectangle: RectAt(0) = the rectangle, data[4] = thickness.
+	 *		  Draw/FillPolygon:	 resource = range in the vertex pool, data[4] = thickness.
+	 *		  Sprite:			 RectAt(0) = destination, RectAt(1) = source, data[8] = opacity,
+	 *							 flags = interpolation mode, resource = backend image handle.
+	 *		  Text:				 RectAt(0) = layout rectangle, data[4] = size, data[5] = font family,
+	 *							 Point(3) = laid out size (zero if unknown),
+	 *							 flags = font weight, resource = range in the text pool.
+	*/
+	struct DrawCommand
+	{
+		DrawCommandKind kind;
+		std::uint8_t flags;
+		std::int16_t layer;
+		// order inside of the layer, higher is drawn later.
+		std::int16_t depth;
+		// index into the transform table of the buffer.
+		std::uint32_t transform;
+		// index into the color table of the buffer.
+		std::uint32_t color;
+		std::uint64_t resource;
+		float data[10];
+
+		constexpr RawPoint Point(std::size_t i) const noexcept
+		{ return {data[2 * i], data[2 * i + 1]}; }
+
+		constexpr RawRect RectAt(std::size_t i) const noexcept
+		{ return {data[4 * i], data[4 * i + 1], data[4 * i + 2], data[4 * i + 3]}; }
+	};
+
+	static_assert(std::is_trivially_copyable_v<DrawCommand>, "DrawCommand must stay a POD");
+
+	/**
+	 * @brief records draw calls for a frame instead of submitting them immediately, so they can be
+	 *		  sorted to minimize state changes and consumed by any backend.
+	 *		  does not depend on direct2d, so it can be tested anywhere.
+	 *
+	 *		  after sorting, draw order is only kept between layers and depths, and across Clear
+	 *		  commands; inside the same layer and depth, commands are grouped by (transform, color, kind).
+	*/
+	class DrawCommandBuffer
+	{
+	public:
+
+		struct StateChanges
+		{
+			std::uint32_t transformChanges;
+			std::uint32_t colorChanges;
+		};
+
+	public:
+
+		DrawCommandBuffer() = default;
+
+	public:
+
+		/**
+		 * @brief every command added after this call uses this transform.
+		*/
+		void SetTransform(RawMatrix const& transform);
+
+		/**
+		 * @brief every command added after this call uses this color.
+		*/
+		void SetColor(RawColor const& color);
+
+		/**
+		 * @brief every command added after this call goes into this layer; lower layers are drawn first.
+		*/
+		void SetLayer(std::int16_t layer) noexcept;
+
+		/**
+		 * @brief every command added after this call gets this depth; inside of a layer, lower depths are drawn first.
+		*/
+		void SetDepth(std::int16_t depth) noexcept;
+
+		/**
+		 * @brief clears the whole target with the color; commands are never sorted across a clear.
+		*/
+		void AddClear(RawColor const& color);
+		void AddLine(RawPoint const& from, RawPoint const& to, float thick);
+		void AddEllipse(RawPoint const& center, float rx, float ry, float thick, bool bFill);
+		void AddRectangle(RawRect const& rect, float thick, bool bFill);
+
+		/**
+		 * @brief the vertices are copied into the buffer.
+		*/
+		void AddPolygon(std::span<RawPoint const> vertices, float thick, bool bFill);
+
+		/**
+		 * @param image => a handle only the backend knows how to use.
+		 * @param interpolation => backend defined as well.
+		*/
+		void AddSprite(std::uint64_t image, RawRect const& dest, RawRect const& src, float opacity, std::uint8_t interpolation);
+
+		/**
+		 * @brief the text is copied into the buffer.
+		 * @param rect => left and top are where the text starts, right and bottom clip it.
+		 * @param extent => the size of the laid out text if the caller knows it; only used for bounds.
+		*/
+		void AddText(std::string_view text, RawRect const& rect, float size, std::uint32_t fontFamily, std::uint8_t fontWeight,
+			RawPoint const& extent = {}
+		);
+
+		/**
+		 * @brief stable sort by (layer, depth, transform, color, kind), never moving a command across a clear.
+		 *		  a radix sort on packed keys, so its cost grows linearly with the number of commands.
+		*/
+		void Sort();
+
+		/**
+		 * @brief removes every command so the buffer can be reused for the next frame;
+		 *		  does not free any memory.
+		*/
+		void Reset();
+
+	public:
+
+		std::span<DrawCommand const> Commands() const noexcept;
+		std::size_t Size() const noexcept;
+		bool IsEmpty() const noexcept;
+		std::int16_t Layer() const noexcept;
+		std::int16_t Depth() const noexcept;
+
+		RawMatrix const& TransformOf(DrawCommand const& command) const noexcept;
+		RawColor const& ColorOf(DrawCommand const& command) const noexcept;
+		std::span<RawPoint const> VerticesOf(DrawCommand const& command) const noexcept;
+		std::string_view TextOf(DrawCommand const& command) const noexcept;
+
+		/**
+		 * @return how many times the transform and the color change when the commands are
+		 *		   submitted in their current order (the first command counts as a change).
+		*/
+		StateChanges CountStateChanges() const noexcept;
+
+		/**
+		 * @return true if both commands draw the exact same thing; state and pooled data are compared
+		 *		   by value, so the commands may come from different buffers. sprite images are not
+		 *		   compared, since only the backend knows what the handles mean.
+		*/
+		static bool SameDrawing(DrawCommandBuffer const& lhsBuffer, DrawCommand const& lhs,
+			DrawCommandBuffer const& rhsBuffer, DrawCommand const& rhs) noexcept;
+
+	private:
+		DrawCommand& NewCommand(DrawCommandKind kind);
+		void SortRange(std::size_t first, std::size_t last);
+
+		/**
+		 * @return (layer, depth, transform, color, kind) packed into 64 bits, in that order of importance.
+		 *		   state indices past 14 bits share the last value, which only costs some grouping.
+		*/
+		static std::uint64_t SortKey(DrawCommand const& command) noexcept;
+
+		static std::uint64_t PackRange(std::size_t first, std::size_t count) noexcept;
+		static std::size_t RangeFirst(std::uint64_t range) noexcept;
+		static std::size_t RangeCount(std::uint64_t range) noexcept;
+
+	private:
+		std::vector<DrawCommand> commands_{};
+
+		// deduplicated state, so equal transforms and colors get equal indices.
+		std::vector<RawMatrix> transforms_{};
+		std::vector<RawColor> colors_{};
+		std::unordered_map<std::uint64_t, std::uint32_t> transformLut_{};
+		std::unordered_map<std::uint64_t, std::uint32_t> colorLut_{};
+
+		std::vector<RawPoint> vertexPool_{};
+		std::string textPool_{};
+
+		std::uint32_t currTransform_{};
+		std::uint32_t currColor_{};
+		std::int16_t currLayer_{};
+		std::int16_t currDepth_{};
+
+		// kept between sorts so they do not allocate every frame.
+		std::vector<std::uint64_t> sortKeys_{};
+		std::vector<std::uint32_t> sortOrder_{};
+		std::vector<std::uint64_t> sortKeysScratch_{};
+		std::vector<std::uint32_t> sortOrderScratch_{};
+		std::vector<DrawCommand> sortedCommands_{};
+	};
+
+	inline void TestDrawCommandBuffer()
+	{
+		using namespace ArTest;
+		std::ofstream file{"DrawCommandBufferTestResults.txt"};
+		Tester tester{file};
+
+		constexpr RawColor red{1.f, 0.f, 0.f, 1.f};
+		constexpr RawColor blue{0.f, 0.f, 1.f, 1.f};
+		constexpr auto moved{RawMatrix::Translation(10.f, 20.f)};
+
+		tester.NewTest("Recording") = [&] {
+			DrawCommandBuffer buffer{};
+			buffer.Reset();
+			buffer.SetColor(red);
+			buffer.AddLine({0.f, 0.f}, {1.f, 1.f}, 2.f);
+			buffer.AddRectangle({0.f, 0.f, 4.f, 3.f}, 1.f, true);
+
+			tester.PassIfEqual(buffer.Size(), 2U);
+			auto const cmds{buffer.Commands()};
+			tester.PassIf(cmds[0].kind == DrawCommandKind::Line);
+			tester.PassIf(cmds[0].Point(1) == RawPoint{1.f, 1.f});
+			tester.PassIfEqual(cmds[0].data[4], 2.f);
+			tester.PassIf(cmds[1].kind == DrawCommandKind::FillRectangle);
+			tester.PassIf(cmds[1].RectAt(0) == RawRect{0.f, 0.f, 4.f, 3.f});
+			tester.PassIf(buffer.ColorOf(cmds[1]) == red);
+			tester.PassIf(buffer.TransformOf(cmds[1]) == RawMatrix::Identity());
+		};
+
+		tester.NewTest("Equal state shares an index") = [&] {
+			DrawCommandBuffer buffer{};
+			buffer.SetColor(red);
+			buffer.AddLine({}, {}, 1.f);
+			buffer.SetColor(blue);
+			buffer.AddLine({}, {}, 1.f);
+			buffer.SetColor(red);
+			buffer.AddLine({}, {}, 1.f);
+
+			auto const cmds{buffer.Commands()};
+			tester.PassIfEqual(cmds[0].color, cmds[2].color);
+			tester.PassIfNotEqual(cmds[0].color, cmds[1].color);
+		};
+
+		tester.NewTest("Pooled data") = [&] {
+			DrawCommandBuffer buffer{};
+			std::array const tri{RawPoint{0.f, 0.f}, RawPoint{1.f, 0.f}, RawPoint{0.f, 1.f}};
+			buffer.AddPolygon(tri, 1.f, false);
+			buffer.AddText("hello", {5.f, 5.f, 100.f, 100.f}, 12.f, 0U, 1U);
+			buffer.AddPolygon(std::span{tri}.first(2), 1.f, true);
+
+			auto const cmds{buffer.Commands()};
+			tester.PassIfEqual(buffer.VerticesOf(cmds[0]).size(), 3U);
+			tester.PassIf(buffer.VerticesOf(cmds[0])[2] == tri[2]);
+			tester.PassIf(buffer.TextOf(cmds[1]) == "hello");
+			tester.PassIfEqual(buffer.VerticesOf(cmds[2]).size(), 2U);
+			tester.PassIf(buffer.VerticesOf(cmds[2])[1] == tri[1]);
+		};
+
+		tester.NewTest("Sort groups state and keeps layers") = [&] {
+			DrawCommandBuffer buffer{};
+			for (int i{}; i < 4; ++i)
+			{
+				buffer.SetTransform((i % 2) ? moved : RawMatrix::Identity());
+				buffer.SetColor((i % 2) ? blue : red);
+				buffer.AddLine({static_cast<float>(i), 0.f}, {}, 1.f);
+			}
+			buffer.SetLayer(-1);
+			buffer.AddLine({-1.f, 0.f}, {}, 1.f);
+
+			auto const before{buffer.CountStateChanges()};
+			buffer.Sort();
+			auto const after{buffer.CountStateChanges()};
+			tester.PassIfEqual(before.colorChanges, 4U);
+			tester.PassIfEqual(after.colorChanges, 3U);
+			tester.PassIfEqual(after.transformChanges, 3U);
+
+			auto const cmds{buffer.Commands()};
+			// the lower layer goes first, equal keys keep their recording order.
+			tester.PassIfEqual(cmds[0].data[0], -1.f);
+			tester.PassIfEqual(cmds[1].data[0], 0.f);
+			tester.PassIfEqual(cmds[2].data[0], 2.f);
+			tester.PassIfEqual(cmds[3].data[0], 1.f);
+			tester.PassIfEqual(cmds[4].data[0], 3.f);
+		};
+
+		tester.NewTest("Sort by depth") = [&] {
+			DrawCommandBuffer buffer{};
+			buffer.SetLayer(1);
+			buffer.SetDepth(-3);
+			buffer.AddLine({0.f, 0.f}, {}, 1.f);
+			buffer.SetLayer(0);
+			buffer.SetDepth(7);
+			buffer.AddLine({1.f, 0.f}, {}, 1.f);
+			buffer.SetDepth(-7);
+			buffer.AddLine({2.f, 0.f}, {}, 1.f);
+			buffer.SetColor(red);
+			buffer.AddLine({3.f, 0.f}, {}, 1.f);
+			buffer.SetColor({0.f, 0.f, 0.f, 1.f});
+			buffer.AddLine({4.f, 0.f}, {}, 1.f);
+			buffer.Sort();
+
+			// layers first, then depths (negative ones included), then state.
+			auto const cmds{buffer.Commands()};
+			tester.PassIfEqual(cmds[0].data[0], 2.f);
+			tester.PassIfEqual(cmds[1].data[0], 4.f);
+			tester.PassIfEqual(cmds[2].data[0], 3.f);
+			tester.PassIfEqual(cmds[3].data[0], 1.f);
+			tester.PassIfEqual(cmds[4].data[0], 0.f);
+		};
+
+		tester.NewTest("Sort never crosses a clear") = [&] {
+			DrawCommandBuffer buffer{};
+			buffer.SetLayer(5);
+			buffer.AddLine({1.f, 0.f}, {}, 1.f);
+			buffer.AddClear(blue);
+			buffer.SetLayer(0);
+			buffer.AddLine({2.f, 0.f}, {}, 1.f);
+			buffer.Sort();
+
+			auto const cmds{buffer.Commands()};
+			tester.PassIfEqual(cmds[0].data[0], 1.f);
+			tester.PassIf(cmds[1].kind == DrawCommandKind::Clear);
+			tester.PassIfEqual(cmds[2].data[0], 2.f);
+		};
+
+		tester.NewTest("Reset") = [&] {
+			DrawCommandBuffer buffer{};
+			buffer.SetColor(blue);
+			buffer.SetLayer(3);
+			buffer.SetDepth(2);
+			buffer.AddText("abc", {}, 1.f, 0U, 0U);
+			buffer.Reset();
+			tester.PassIf(buffer.IsEmpty());
+			tester.PassIfEqual(buffer.Layer(), 0);
+			tester.PassIfEqual(buffer.Depth(), 0);
+
+			buffer.AddLine({}, {}, 1.f);
+			tester.PassIf(buffer.ColorOf(buffer.Commands()[0]) == RawColor{0.f, 0.f, 0.f, 1.f});
+		};
+
+		tester.OutputResults();
+	}
+}
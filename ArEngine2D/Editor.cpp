@@ -1,8 +1,28 @@
 #include "Editor.h"
 
+#include "DrawCommandBuffer.h"
+#include "SoftwareRasterizer.h"
+
+#include <bit>
 #include <random>
 
 namespace ArFac {
+	namespace {
+		RawColor ToRaw(ColorF const& color) noexcept
+		{
+			return std::bit_cast<RawColor>(color.ToD2DColor());
+		}
+
+		// the same shape as Grafix::DrawArrow.
+		void AddArrow(DrawCommandBuffer& commands, Vec2 const& from, Vec2 const& to, float thick)
+		{
+			auto const [southEast, southWest]{Grafix::ArrowHead(from, to)};
+			commands.AddLine({from.x, from.y}, {to.x, to.y}, thick);
+			commands.AddLine({to.x, to.y}, {southEast.x, southEast.y}, thick);
+			commands.AddLine({to.x, to.y}, {southWest.x, southWest.y}, thick);
+		}
+	}
+
 	Editor::BlockInfo::BlockInfo() :
 		id{Block::TypeToID(Block::Type::Floor)},
 		dir{Dir::Right}
@@ -13,9 +33,14 @@ namespace ArFac {
 	{}
 
 	Editor::Editor(Engine& game) : 
-		mouse_{game.mouse}, keyboard_{game.keyboard}, 
+		mouse_{game.mouse}, keyboard_{game.keyboard}, jobs_{game.jobs},
 		cam_{game.mouse}
-	{ }
+	{
+		for (auto& chunks : chunks_)
+		{
+			chunks.resize(ChunkCols() * ChunkRows());
+		}
+	}
 
 	void Editor::UpdateInput(float dt)
 	{
@@ -75,10 +100,31 @@ namespace ArFac {
 
 	void Editor::Draw(Grafix& gfx)
 	{
-		DrawGrid(gfx, sc_BackgroundColor, sc_LineColor, 1.f);
+		DrawGrid(gfx);
 		DrawUI(gfx);
 	}
 
+	void Editor::SetDetailThresholds(DetailThresholds const& thresholds) noexcept
+	{
+		assert(thresholds.noArrows >= thresholds.noOutlines and thresholds.noOutlines >= thresholds.colorMap
+			&& "Detail thresholds must not increase");
+		thresholds_ = thresholds;
+	}
+
+	Editor::DetailThresholds const& Editor::GetDetailThresholds() const noexcept
+	{ return thresholds_; }
+
+	Editor::Detail Editor::CurrDetail() const noexcept
+	{ return DetailAt(cam_.Scale(), thresholds_); }
+
+	Editor::Detail Editor::DetailAt(float scale, DetailThresholds const& thresholds) noexcept
+	{
+		if (scale < thresholds.colorMap)	return Detail::ColorMap;
+		if (scale < thresholds.noOutlines)	return Detail::NoOutlines;
+		if (scale < thresholds.noArrows)	return Detail::NoArrows;
+		return Detail::Full;
+	}
+
 	void Editor::DrawUI(Grafix& gfx)
 	{
 		gfx.FillRectangle(mouse_.loc - Vec2{-30.f, 30.f}, 50.f, 50.f, IDToColor(heldBlock_.id));
@@ -86,55 +132,219 @@ namespace ArFac {
 			std::string{Block::TypeToString(Block::IDToType(heldBlock_.id))}, Colors::White, 20.f);
 	}
 
-	void Editor::DrawGrid(Grafix& gfx, ColorF bgColor, ColorF strokeColor, float thick)
+	void Editor::DrawGrid(Grafix& gfx)
 	{
 		gfx.PushTransform(cam_.CurrTransform());
 		
+		auto const detail{CurrDetail()};
+		if (detail == Detail::ColorMap)
+		{
+			if (not pColorMap_)
+			{
+				BuildColorMap();
+			}
+			// blocks this small are better off sharp.
+			gfx.SetInterpolationMode(InterpolationMode::NearestNeighbor);
+			gfx.DrawSprite({}, *pColorMap_, 1.f, Transform{}.Scale(BlockWidth()));
+			gfx.SetInterpolationMode(InterpolationMode::Linear);
+			gfx.PopTransform();
+			return;
+		}
+
+		// one blit per visible chunk, however many blocks it has.
+		auto& chunks{chunks_[static_cast<std::size_t>(detail)]};
+		auto const texelWidth{1.f / DetailDensity(detail)};
 		auto const camExtents{cam_.CalcExtents()};
-		
-		// this assumes that the grid always covers the entire screen.
-		auto const topLeft{ScreenToGrid(camExtents.topLeft)};
-		auto const tempBotRight{ScreenToGrid(camExtents.botRight)};
-		decltype(tempBotRight) botRight{
-			std::min(tempBotRight.x + 1, grid_.Width()), 
-			std::min(tempBotRight.y + 1, grid_.Height() - 1)
+		auto const chunkWidth{BlockWidth() * sc_ChunkBlocks};
+		auto const toChunk = [&](float coord, std::size_t count) {
+			return static_cast<std::size_t>(std::clamp(coord / chunkWidth, 0.f, static_cast<float>(count)));
 		};
+		auto const left{toChunk(camExtents.topLeft.x, ChunkCols())};
+		auto const top{toChunk(camExtents.topLeft.y, ChunkRows())};
+		auto const right{std::min(toChunk(camExtents.botRight.x, ChunkCols()) + 1U, ChunkCols())};
+		auto const bottom{std::min(toChunk(camExtents.botRight.y, ChunkRows()) + 1U, ChunkRows())};
+
+		// panning would otherwise keep every chunk it ever saw.
+		EvictChunks(left, top, right, bottom);
 
-		// better the two dimensional loop
-		for (std::size_t i{grid_.CoordToIndex(topLeft)}, lim{grid_.CoordToIndex(botRight)};
-			i < lim; ++i)
+		// the missing ones are rasterized together on the jobs; only the bitmaps are made here.
+		missingChunks_.clear();
+		for (auto row{top}; row < bottom; ++row)
 		{
-			auto const coord{grid_.IndexToCoord(i)};
-			auto const vec{GridToScreen(coord.x, coord.y)};
-			auto const w{BlockWidth()};
-			auto const& el{grid_[i]};
-			auto const& actCol{IDToColor(el.id)};
-			gfx.FillRectangle(vec, w, w, actCol);
-
-			auto const hw = w * 0.5f;
-			auto const qw = w * 0.25f;
-			switch (el.dir)
+			for (auto col{left}; col < right; ++col)
 			{
-			case Dir::Right:
-				gfx.DrawArrow({vec.x + qw, vec.y + hw}, {vec.x + hw + qw, vec.y + hw}, sc_LineColor);
-				break;
-			case Dir::Down:
-				gfx.DrawArrow({vec.x + hw, vec.y + qw}, {vec.x + hw, vec.y + hw + qw}, sc_LineColor);
-				break;
-			case Dir::Left:
-				gfx.DrawArrow({vec.x + hw + qw, vec.y + hw}, {vec.x + qw, vec.y + hw}, sc_LineColor);
-				break;
-			case Dir::Up:
-				gfx.DrawArrow({vec.x + hw, vec.y + hw + qw}, {vec.x + hw, vec.y + qw}, sc_LineColor);
-				break;
-			default: throw;
+				if (not chunks[row * ChunkCols() + col])
+				{
+					missingChunks_.push_back(row * ChunkCols() + col);
+				}
 			}
+		}
+		chunkPixels_.resize(missingChunks_.size());
+		jobs_.ParallelFor(missingChunks_.size(), [&](std::size_t i) {
+			chunkPixels_[i] = RenderChunk(detail, missingChunks_[i] % ChunkCols(), missingChunks_[i] / ChunkCols());
+		});
+		for (std::size_t i{}; i < missingChunks_.size(); ++i)
+		{
+			// a new sprite rather than an update in place, so retained frames see the change.
+			auto pChunk{std::make_unique<Sprite>()};
+			pChunk->Initialize(chunkPixels_[i]);
+			chunks[missingChunks_[i]] = std::move(pChunk);
+			builtChunks_[static_cast<std::size_t>(detail)].push_back(missingChunks_[i]);
+		}
 
-			gfx.DrawRectangle(vec, w, w, strokeColor, thick);
+		for (auto row{top}; row < bottom; ++row)
+		{
+			for (auto col{left}; col < right; ++col)
+			{
+				auto const& pChunk{chunks[row * ChunkCols() + col]};
+				gfx.DrawSprite({}, *pChunk, 1.f, 
+					Transform{}.Scale(texelWidth).Translate(GridToScreen(col * sc_ChunkBlocks, row * sc_ChunkBlocks))
+				);
+			}
 		}
 		gfx.PopTransform();
 	}
 
+	PixelBuffer Editor::RenderChunk(Detail detail, std::size_t chunkCol, std::size_t chunkRow) const
+	{
+		auto const firstCol{chunkCol * sc_ChunkBlocks};
+		auto const firstRow{chunkRow * sc_ChunkBlocks};
+		// the last chunks may be cut short by the edges of the level.
+		auto const cols{std::min<std::size_t>(sc_ChunkBlocks, grid_.Width() - firstCol)};
+		auto const rows{std::min<std::size_t>(sc_ChunkBlocks, grid_.Height() - firstRow)};
+		auto const w{BlockWidth() * DetailDensity(detail)};
+		auto const hw = w * 0.5f;
+		auto const qw = w * 0.25f;
+
+		// drawn in chunk space, in bitmap pixels.
+		DrawCommandBuffer commands{};
+		for (std::size_t row{}; row < rows; ++row)
+		{
+			for (std::size_t col{}; col < cols; ++col)
+			{
+				auto const& el{grid_(firstCol + col, firstRow + row)};
+				Vec2 const vec{col * w, row * w};
+				RawRect const rect{vec.x, vec.y, vec.x + w, vec.y + w};
+				commands.SetColor(ToRaw(IDToColor(el.id)));
+				commands.AddRectangle(rect, 1.f, true);
+
+				if (detail == Detail::NoOutlines)
+				{
+					continue;
+				}
+
+				commands.SetColor(ToRaw(sc_LineColor));
+				if (detail == Detail::Full)
+				{
+					switch (el.dir)
+					{
+					case Dir::Right:
+						AddArrow(commands, {vec.x + qw, vec.y + hw}, {vec.x + hw + qw, vec.y + hw}, sc_LineThick);
+						break;
+					case Dir::Down:
+						AddArrow(commands, {vec.x + hw, vec.y + qw}, {vec.x + hw, vec.y + hw + qw}, sc_LineThick);
+						break;
+					case Dir::Left:
+						AddArrow(commands, {vec.x + hw + qw, vec.y + hw}, {vec.x + qw, vec.y + hw}, sc_LineThick);
+						break;
+					case Dir::Up:
+						AddArrow(commands, {vec.x + hw, vec.y + hw + qw}, {vec.x + hw, vec.y + qw}, sc_LineThick);
+						break;
+					default: throw;
+					}
+				}
+
+				commands.AddRectangle(rect, sc_LineThick, false);
+			}
+		}
+
+		PixelBuffer pixels{
+			static_cast<std::size_t>(cols * w), static_cast<std::size_t>(rows * w),
+			PixelBuffer::Pack(ToRaw(sc_BackgroundColor))
+		};
+		SoftwareRasterizer{}.Render(commands, pixels);
+		return pixels;
+	}
+
+	void Editor::BuildColorMap()
+	{
+		PixelBuffer pixels{grid_.Width(), grid_.Height()};
+		for (std::size_t i{}; i < grid_.Size(); ++i)
+		{
+			auto const coord{grid_.IndexToCoord(i)};
+			pixels.At(coord.x, coord.y) = PixelBuffer::Pack(ToRaw(IDToColor(grid_[i].id)));
+		}
+		auto pColorMap{std::make_unique<Sprite>()};
+		pColorMap->Initialize(pixels);
+		pColorMap_ = std::move(pColorMap);
+	}
+
+	void Editor::InvalidateChunkOf(std::size_t col, std::size_t row) noexcept
+	{
+		for (auto& chunks : chunks_)
+		{
+			chunks[row / sc_ChunkBlocks * ChunkCols() + col / sc_ChunkBlocks].reset();
+		}
+		pColorMap_.reset();
+	}
+
+	void Editor::InvalidateAllChunks() noexcept
+	{
+		for (auto& chunks : chunks_)
+		{
+			for (auto& pChunk : chunks)
+			{
+				pChunk.reset();
+			}
+		}
+		for (auto& built : builtChunks_)
+		{
+			built.clear();
+		}
+		pColorMap_.reset();
+	}
+
+	void Editor::EvictChunks(std::size_t left, std::size_t top, std::size_t right, std::size_t bottom) noexcept
+	{
+		left = left > sc_ChunkMargin ? left - sc_ChunkMargin : 0U;
+		top  = top > sc_ChunkMargin ? top - sc_ChunkMargin : 0U;
+		right  += sc_ChunkMargin;
+		bottom += sc_ChunkMargin;
+		for (std::size_t level{}; level < chunks_.size(); ++level)
+		{
+			auto& chunks{chunks_[level]};
+			// invalidated chunks are only dropped from the list here.
+			std::erase_if(builtChunks_[level], [&](std::size_t i) {
+				auto const col{i % ChunkCols()};
+				auto const row{i / ChunkCols()};
+				if (col < left or col >= right or row < top or row >= bottom)
+				{
+					chunks[i].reset();
+				}
+				return not chunks[i];
+			});
+		}
+	}
+
+	float Editor::DetailDensity(Detail detail) noexcept
+	{
+		// a quarter as many pixels per side at every level, down to one per block.
+		switch (detail)
+		{
+		case Detail::Full:		 return 1.f;
+		case Detail::NoArrows:	 return 1.f / 4.f;
+		case Detail::NoOutlines: return 1.f / 16.f;
+		case Detail::ColorMap:	 return 1.f / sc_BlockWidth;
+		default: throw;
+		}
+	}
+
+	std::size_t Editor::ChunkCols() const noexcept
+	{ return (grid_.Width() + sc_ChunkBlocks - 1U) / sc_ChunkBlocks; }
+
+	std::size_t Editor::ChunkRows() const noexcept
+	{ return (grid_.Height() + sc_ChunkBlocks - 1U) / sc_ChunkBlocks; }
+
 	void Editor::LoadLevelFromFile(std::string_view fileName)
 	{
 		std::ifstream file{std::string{fileName}};
@@ -151,6 +361,7 @@ namespace ArFac {
 				};
 			}
 		}
+		InvalidateAllChunks();
 	}
 
 	void Editor::SaveLevelToFile(std::string_view fileName)
@@ -183,24 +394,21 @@ namespace ArFac {
 	{ return grid_.Height() * BlockWidth(); }
 
 	float Editor::CalcMinZoom(float windowWidth) const
-	{
-		auto const gw{grid_.Width()};
-		auto const gh{grid_.Height()};
-		auto const bw{BlockWidth()};
-		
-		auto const absoluteMin = [&] {
-			if (gw < gh) return windowWidth / (bw * gw);
-			else		 return windowWidth / (bw * gh);
-		}();
-		return std::max(absoluteMin, CalcMaxZoom(windowWidth) * 0.5f);
-	}
+	{ return MinZoomFor(windowWidth, grid_.Width(), grid_.Height()); }
 
 	float Editor::CalcMaxZoom(float windowWidth) const
+	{ return MaxZoomFor(windowWidth); }
+
+	float Editor::MinZoomFor(float windowWidth, std::size_t levelCols, std::size_t levelRows) noexcept
 	{
-		auto const bw{BlockWidth()};
-		return windowWidth / (bw * sc_MinBlocksPerSide);
+		// no floor, or big levels could never zoom out far enough for the lower levels of detail.
+		auto const longest{std::max(levelCols, levelRows)};
+		return std::min(windowWidth / (BlockWidth() * longest), MaxZoomFor(windowWidth));
 	}
 
+	float Editor::MaxZoomFor(float windowWidth) noexcept
+	{ return windowWidth / (BlockWidth() * sc_MinBlocksPerSide); }
+
 	ColorF const& Editor::IDToColor(Block::ID id) noexcept
 	{
 		using MyLUT = std::unordered_map<Block::Type, ColorF> const;
@@ -239,6 +447,7 @@ namespace ArFac {
 		static std::uniform_int_distribution s_UniDest{0, 3};
 
 		grid_(col, row) = heldBlock_;
+		InvalidateChunkOf(col, row);
 		heldBlock_.dir = [&] {switch (s_UniDest(s_Engine)) {
 			case 0: return Dir::Right;
 			case 1: return Dir::Down;
@@ -251,6 +460,7 @@ namespace ArFac {
 	void Editor::DeleteBlock(std::size_t col, std::size_t row) noexcept
 	{
 		grid_(col, row) = {Block::TypeToID(Block::Type::Floor), Dir::Right};
+		InvalidateChunkOf(col, row);
 	}
 	
 	Vec2 Editor::GridToScreen(std::size_t col, std::size_t row) const noexcept
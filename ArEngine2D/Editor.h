@@ -4,14 +4,39 @@
 #include "Block.h"
 #include "Camera.h"
 #include "Engine.h"
+#include "Testing/ArTest20.h"
 
+#include <array>
 #include <fstream>
+#include <memory>
+#include <vector>
 
 namespace ArFac {
 	using namespace ArEngine2D;
 
 	class Editor
 	{
+	public:
+		// how much of the grid gets drawn; every level drops something more, and bakes fewer pixels per block.
+		enum class Detail : unsigned char
+		{
+			Full,
+			NoArrows,
+			NoOutlines,
+			// the whole level as one bitmap with a single pixel per block.
+			ColorMap,
+		};
+
+		// camera scales below which each level of detail kicks in (64 times the on screen block width).
+		// at 1280 px, a 32 by 32 level stays in full detail; 128 blocks per side zoom out past noArrows,
+		// 256 past noOutlines, and 512 past colorMap.
+		struct DetailThresholds
+		{
+			float noArrows{0.375f};
+			float noOutlines{0.125f};
+			float colorMap{0.05f};
+		};
+
 	private:
 		enum class Dir : unsigned char
 		{
@@ -36,6 +61,12 @@ namespace ArFac {
 		constexpr static auto sc_MinBlocksPerSide{8UI32};
 		constexpr static auto sc_BackgroundColor{Colors::LightGray};
 		constexpr static auto sc_LineColor{Colors::Gray};
+		// the grid is drawn in square chunks of this many blocks per side, one bitmap each.
+		constexpr static auto sc_ChunkBlocks{8UI32};
+		// built chunks further than this many chunks off screen are freed, at every level of detail.
+		constexpr static auto sc_ChunkMargin{1UI32};
+		// in bitmap pixels; the software rasterizer does not anti alias, so thinner lines may vanish.
+		constexpr static auto sc_LineThick{2.f};
 
 	public:
 		// borrows all the needed references for the editor to 
@@ -49,6 +80,9 @@ namespace ArFac {
 
 		// graphics
 		void Draw(Grafix& gfx);
+		void SetDetailThresholds(DetailThresholds const& thresholds) noexcept;
+		DetailThresholds const& GetDetailThresholds() const noexcept;
+		Detail CurrDetail() const noexcept;
 		
 		// saving and loading
 		void LoadLevelFromFile(std::string_view fileName);
@@ -56,8 +90,12 @@ namespace ArFac {
 
 		// these assume that the width of the window is larger.
 		// can clearly just pass in the height when that's not the case tho.
+		// zoomed all the way out, the whole level fits.
 		float CalcMinZoom(float windowWidth) const;
 		float CalcMaxZoom(float windowWidth) const;
+		static float MinZoomFor(float windowWidth, std::size_t levelCols, std::size_t levelRows) noexcept;
+		static float MaxZoomFor(float windowWidth) noexcept;
+		static Detail DetailAt(float scale, DetailThresholds const& thresholds) noexcept;
 
 		// getters
 		DraggableCamera& Cam() noexcept;
@@ -70,7 +108,20 @@ namespace ArFac {
 
 	private:
 		void DrawUI(Grafix& gfx);
-		void DrawGrid(Grafix& gfx, ColorF bgColor, ColorF strokeColor, float thick);
+		void DrawGrid(Grafix& gfx);
+
+		// chunks
+		// only reads the grid, so chunks can be rendered on several jobs at once.
+		PixelBuffer RenderChunk(Detail detail, std::size_t chunkCol, std::size_t chunkRow) const;
+		void BuildColorMap();
+		void InvalidateChunkOf(std::size_t col, std::size_t row) noexcept;
+		void InvalidateAllChunks() noexcept;
+		// frees the built chunks outside of [left, right) x [top, bottom), grown by sc_ChunkMargin.
+		void EvictChunks(std::size_t left, std::size_t top, std::size_t right, std::size_t bottom) noexcept;
+		std::size_t ChunkCols() const noexcept;
+		std::size_t ChunkRows() const noexcept;
+		// bitmap pixels per level unit.
+		static float DetailDensity(Detail detail) noexcept;
 
 		static ColorF const& IDToColor(Block::ID id) noexcept;
 		static char DirToChar(Dir dir) noexcept;
@@ -89,10 +140,64 @@ namespace ArFac {
 		// for the editor its self
 		BlockInfo heldBlock_{Block::MinBlockID(), Dir::Right};
 		DataGrid<BlockInfo> grid_{32, 32};
+		// one set per chunked level of detail, row major, null until built (or after a block inside of it changed).
+		std::array<std::vector<std::unique_ptr<Sprite>>, 3U> chunks_;
+		// the indices of the built ones, so eviction does not walk the whole level.
+		std::array<std::vector<std::size_t>, 3U> builtChunks_;
+		std::unique_ptr<Sprite> pColorMap_;
+		// the visible chunks that were missing this frame, and their pixels.
+		std::vector<std::size_t> missingChunks_;
+		std::vector<PixelBuffer> chunkPixels_;
+		DetailThresholds thresholds_{};
 		DraggableCamera cam_;
 
 		// borrowed directly from the eng
 		Mouse& mouse_;
 		Keyboard& keyboard_;
+		JobSystem& jobs_;
 	};
+
+	inline void TestEditor()
+	{
+		using namespace ArTest;
+		std::ofstream file{"EditorTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Every detail is reachable on big levels") = [&] {
+			constexpr float windowWidth{1280.f};
+			Editor::DetailThresholds const thresholds{};
+			for (std::size_t const side : {32U, 128U, 256U, 512U})
+			{
+				auto const minZoom{Editor::MinZoomFor(windowWidth, side, side)};
+				auto const maxZoom{Editor::MaxZoomFor(windowWidth)};
+				tester.PassIfLess(float{minZoom}, float{maxZoom});
+				// the whole level fits.
+				tester.PassIfLessEq(float{minZoom * Editor::BlockWidth() * static_cast<float>(side)}, float{windowWidth});
+
+				// zooming out all the way only ever drops detail.
+				auto last{Editor::Detail::Full};
+				bool bMonotonic{true};
+				for (auto scale{maxZoom}; scale >= minZoom; scale *= 0.9f)
+				{
+					auto const detail{Editor::DetailAt(scale, thresholds)};
+					bMonotonic = bMonotonic and detail >= last;
+					last = detail;
+				}
+				tester.PassIf(bMonotonic);
+				tester.PassIf(Editor::DetailAt(maxZoom, thresholds) == Editor::Detail::Full);
+				auto const expected = [&] {
+					switch (side)
+					{
+					case 32U:  return Editor::Detail::Full;
+					case 128U: return Editor::Detail::NoArrows;
+					case 256U: return Editor::Detail::NoOutlines;
+					default:   return Editor::Detail::ColorMap;
+					}
+				}();
+				tester.PassIf(Editor::DetailAt(minZoom, thresholds) == expected);
+			}
+		};
+
+		tester.OutputResults();
+	}
 }
@@ -1,46 +1,366 @@
 #include "Engine.h"
 
 #include <chrono>
+#include <format>
+#include <fstream>
+#include <iostream>
 
 namespace ArEngine2D {
 	Engine::Engine(std::string_view title, std::int32_t windowWidth, std::int32_t windowHeight) :
 		window_{title, windowWidth, windowHeight}
 	{
 	}
+	Engine::Engine(std::int32_t frameWidth, std::int32_t frameHeight) :
+		window_{frameWidth, frameHeight}
+	{
+	}
     void Engine::Run() noexcept
     {
 		try
 		{
 			Initialize();
 			OnUserCreate();
-			while (window_.ProcessMessages())
+			profiler.SetThreadName("Main");
+			while (ProcessMessages())
 			{
 				auto const dt{GetFrameDelta()};
+				auto const bPipelined{bPipelined_.load()};
+				// the update is not running, so the keyboard can be read.
+				CheckTraceHotkey();
 
-				// update keyboard and mouse input
-				window_.InputUpdate();
+				// update keyboard and mouse input, and the user's code
+				BeginUpdate(dt, bPipelined);
+				if (not bPipelined)
+				{
+					EndUpdate();
+				}
 
-				// update the user's code
-				OnUserUpdate(dt);
-
-				// Render to the screen
-				gfx_.BeginDraw();
-				OnUserDraw(gfx_);
-				gfx_.EndDraw();
+				// Render to the screen, pipelined while the next frame is being updated
+				if (bHasFrame_)
+				{
+					DrawFrame();
+				}
+				if (bPipelined)
+				{
+					EndUpdate();
+				}
+				// a retained frame without changes was not presented, so nothing waited for vsync.
+				if (bHasFrame_ and gfx_.LastFrameStats().presents == 0U)
+				{
+					AR2D_PROFILE_ZONE(profiler, "Idle");
+					window_.WaitForMessages(sc_IdleWaitMs);
+				}
+				profiler.EndFrame();
 
 				// show the fps and other stuff
-				UpdateTitle(dt);
+				if (not window_.IsHeadless())
+				{
+					UpdateTitle(dt);
+				}
 			}
 		}
 		catch (IEngineError const& err)
 		{
-			MessageBoxA(window_.Handle(), err.Message().data(), err.MessageBoxTitle().data(), MB_ICONERROR);
+			// the game must not be torn down while its update still runs.
+			StopUpdate();
+			ReportError(err);
 		}
     }
+	void Engine::RunFrames(std::uint32_t frameCount, std::filesystem::path const& outputDir, std::uint32_t captureEvery, float dt) noexcept
+	{
+		using Milliseconds = std::chrono::duration<double, std::milli>;
+		try
+		{
+			std::ofstream timings{};
+			if (not outputDir.empty())
+			{
+				std::error_code err{};
+				std::filesystem::create_directories(outputDir, err);
+				timings.open(outputDir / "timings.csv");
+				if (not timings)
+				{
+					throw EngineError{"Failed to create " + (outputDir / "timings.csv").string()};
+				}
+				timings << "frame,update_steps,update_ms,draw_ms,frame_ms,latency_ms,drawn_draws,culled_draws,rendered_pixels,image\n";
+			}
+
+			Initialize();
+			OnUserCreate();
+			auto const bPipelined{bPipelined_.load()};
+			auto lastEnd{Clock::now()};
+			profiler.SetThreadName("Main");
+			// only passes that draw count; until the first fixed step lands (pipelined, until the first
+			// update is handed off) there is nothing to draw.
+			std::uint32_t frame{};
+			while (frame < frameCount and ProcessMessages())
+			{
+				// pipelined, a frame is drawn while the next one is updated; the last one needs no next.
+				auto const bUpdate{not bPipelined or not bHasFrame_ or frame + 1U < frameCount};
+				if (bUpdate)
+				{
+					BeginUpdate(dt, bPipelined);
+				}
+				if (not bPipelined)
+				{
+					EndUpdate();
+				}
+				if (not bHasFrame_)
+				{
+					EndUpdate();
+					profiler.EndFrame();
+					continue;
+				}
+
+				auto const bCapture{not outputDir.empty() and captureEvery != 0U and frame % captureEvery == 0U};
+				auto const drawStart{Clock::now()};
+				if (bCapture)
+				{
+					gfx_.CaptureNextFrame();
+				}
+				DrawFrame();
+				auto const end{Clock::now()};
+				// what was drawn, before the handoff replaces it.
+				auto const drawn{drawn_};
+				if (bPipelined and bUpdate)
+				{
+					EndUpdate();
+				}
+
+				std::string image{};
+				if (bCapture)
+				{
+					image = std::format("frame_{:05}.png", frame);
+					gfx_.SaveCapturedFrame(outputDir / image);
+				}
+				if (timings.is_open())
+				{
+					auto const& stats{gfx_.LastFrameStats()};
+					timings << std::format("{},{},{:.3f},{:.3f},{:.3f},{:.3f},{},{},{},{}\n", frame, drawn.steps,
+						Milliseconds{drawn.updateTime}.count(), Milliseconds{end - drawStart}.count(),
+						Milliseconds{end - lastEnd}.count(), Milliseconds{end - drawn.updateStart}.count(),
+						stats.drawnDraws, stats.culledDraws, stats.renderedPixels, image
+					);
+				}
+				lastEnd = end;
+				profiler.EndFrame();
+				++frame;
+			}
+
+			if (not outputDir.empty())
+			{
+				CaptureTrace(outputDir / "trace.json");
+				WaitForTraces();
+			}
+		}
+		catch (IEngineError const& err)
+		{
+			// the game must not be torn down while its update still runs.
+			StopUpdate();
+			ReportError(err);
+		}
+	}
+	void Engine::SetFixedUpdateRate(float updatesPerSecond, std::uint32_t maxStepsPerFrame)
+	{
+		if (updatesPerSecond <= 0.f)
+		{
+			fixedStep_.reset();
+			return;
+		}
+		fixedStep_.emplace(1.f / updatesPerSecond, maxStepsPerFrame);
+	}
+	bool Engine::IsFixedUpdate() const noexcept
+	{
+		return fixedStep_.has_value();
+	}
+	float Engine::InterpolationAlpha() const noexcept
+	{
+		return drawAlpha_;
+	}
+	void Engine::SetPipelined(bool bPipelined) noexcept
+	{
+		bPipelined_ = bPipelined;
+	}
+	bool Engine::IsPipelined() const noexcept
+	{
+		return bPipelined_;
+	}
+	void Engine::SetRetained(bool bRetained) noexcept
+	{
+		gfx_.SetRetained(bRetained);
+	}
+	void Engine::CaptureTrace(std::filesystem::path file, std::size_t frameCount)
+	{
+		if (not traceWriter_)
+		{
+			traceWriter_.emplace();
+		}
+		try
+		{
+			traceWriter_->Write(std::move(file), TraceCapture::FromProfiler(profiler, frameCount));
+		}
+		catch (std::exception const& err)
+		{
+			throw EngineError{err.what()};
+		}
+	}
+	void Engine::SetTraceHotkey(std::optional<Keys> key, std::filesystem::path directory)
+	{
+		traceKey_ = key;
+		traceDirectory_ = std::move(directory);
+	}
+	void Engine::OnUserHandoff()
+	{
+	}
+	void Engine::BeginUpdate(float frameDelta, bool bPipelined)
+	{
+		pending_.updateStart = Clock::now();
+		if (not bPipelined)
+		{
+			pending_.steps = UpdateFrame(frameDelta);
+			pending_.updateTime = Clock::now() - pending_.updateStart;
+			return;
+		}
+
+		if (not updateThread_)
+		{
+			updateThread_.emplace([this, bNamed = false](float dt) mutable {
+				if (not bNamed)
+				{
+					profiler.SetThreadName("Update");
+					bNamed = true;
+				}
+				pending_.steps = UpdateFrame(dt);
+			});
+		}
+		updateThread_->Start(frameDelta);
+	}
+	void Engine::EndUpdate()
+	{
+		if (updateThread_ and updateThread_->IsRunning())
+		{
+			AR2D_PROFILE_ZONE(profiler, "WaitForUpdate");
+			updateThread_->Wait();
+			pending_.updateTime = updateThread_->LastDuration();
+		}
+
+		// nothing of the user's runs on the other thread until the next BeginUpdate.
+		drawn_ = pending_;
+		drawAlpha_ = fixedStep_ ? fixedStep_->Alpha() : 1.f;
+		// a fast frame may run no fixed step; the back state was not rewritten, so the last published
+		// one is drawn again (just further along).
+		if (pending_.steps == 0U)
+		{
+			return;
+		}
+
+		AR2D_PROFILE_ZONE(profiler, "OnUserHandoff");
+		OnUserHandoff();
+		bHasFrame_ = true;
+	}
+	void Engine::StopUpdate() noexcept
+	{
+		if (not updateThread_)
+		{
+			return;
+		}
+		try
+		{
+			updateThread_->Wait();
+		}
+		catch (...)
+		{
+			// already failing for another reason.
+		}
+	}
+	void Engine::CheckTraceHotkey()
+	{
+		auto const bDown{traceKey_ and keyboard(*traceKey_).IsDown()};
+		if (bDown and not bTraceKeyDown_ and profiler.LastFrame())
+		{
+			CaptureTrace(traceDirectory_ / std::format("trace_{:05}.json", profiler.LastFrame()->index));
+		}
+		bTraceKeyDown_ = bDown;
+	}
+	void Engine::WaitForTraces()
+	{
+		if (not traceWriter_)
+		{
+			return;
+		}
+		try
+		{
+			traceWriter_->Wait();
+		}
+		catch (std::exception const& err)
+		{
+			throw EngineError{err.what()};
+		}
+	}
+	std::uint32_t Engine::UpdateFrame(float frameDelta)
+	{
+		AR2D_PROFILE_ZONE(profiler, "Update");
+		if (not fixedStep_)
+		{
+			UpdateStep(frameDelta);
+			return 1U;
+		}
+
+		auto const steps{fixedStep_->Advance(frameDelta)};
+		for (std::uint32_t step{}; step < steps; ++step)
+		{
+			// presses and releases show up in the first update only, and wait for the next frame
+			// when this one has none.
+			UpdateStep(fixedStep_->Step());
+		}
+		return steps;
+	}
+	void Engine::UpdateStep(float dt)
+	{
+		{
+			AR2D_PROFILE_ZONE(profiler, "InputUpdate");
+			window_.InputUpdate();
+		}
+		AR2D_PROFILE_ZONE(profiler, "OnUserUpdate");
+		OnUserUpdate(dt);
+	}
+	bool Engine::ProcessMessages()
+	{
+		AR2D_PROFILE_ZONE(profiler, "ProcessMessages");
+		return window_.ProcessMessages();
+	}
+	void Engine::DrawFrame()
+	{
+		AR2D_PROFILE_ZONE(profiler, "Draw");
+		gfx_.BeginDraw();
+		{
+			AR2D_PROFILE_ZONE(profiler, "OnUserDraw");
+			OnUserDraw(gfx_);
+		}
+		AR2D_PROFILE_ZONE(profiler, "EndDraw");
+		gfx_.EndDraw();
+	}
 	void Engine::Initialize()
 	{
 		IEngineError::InitializeInfoQueue();
-		gfx_.Initialize(window_.Handle());
+		if (window_.IsHeadless())
+		{
+			gfx_.InitializeHeadless(static_cast<std::uint32_t>(window_.Width()), static_cast<std::uint32_t>(window_.Height()), jobs);
+		}
+		else
+		{
+			gfx_.Initialize(window_.Handle());
+		}
+	}
+	void Engine::ReportError(IEngineError const& err) const
+	{
+		if (window_.IsHeadless())
+		{
+			std::cerr << err.MessageBoxTitle() << ": " << err.Message() << '\n';
+		}
+		else
+		{
+			MessageBoxA(window_.Handle(), err.Message().data(), err.MessageBoxTitle().data(), MB_ICONERROR);
+		}
 	}
 	float Engine::GetFrameDelta()
 	{
@@ -2,6 +2,16 @@
 
 #include "Window.h"
 #include "Grafix.h"
+#include "SpriteCache.h"
+#include "FixedTimestep.h"
+#include "UpdateThread.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "TraceWriter.h"
+
+#include <atomic>
+#include <filesystem>
+#include <optional>
 
 namespace ArEngine2D {
 	class Engine : Details::ISingle
@@ -10,13 +20,87 @@ namespace ArEngine2D {
 
 		Engine(std::string_view title, std::int32_t windowWidth, std::int32_t windowHeight);
 
+		/**
+		 * @brief headless engine; draws with the software rasterizer instead of a window
+		 *		  (see Grafix::FrameBuffer). call window.Close() to stop Run.
+		 *		  needs no window, display or gpu, but it's still windows only: geometry, text
+		 *		  layouts and sprite loading go through COM, WIC and Direct2D's software path.
+		*/
+		Engine(std::int32_t frameWidth, std::int32_t frameHeight);
+
 	public:
 
 		/**
 		 * @brief starts and runs the game eng until the game window is closed.
+		 *		  errors show a message box, or go to stderr when headless.
 		 */
 		void Run() noexcept;
 
+		/**
+		 * @brief runs exactly frameCount frames with a fixed frame delta (usually headless), so
+		 *		  runs can be compared against each other. if outputDir is not empty, every
+		 *		  captureEvery-th frame is saved there as frame_<number>.png, the update and draw
+		 *		  times of every frame go to timings.csv next to them (0 means no captures), and the
+		 *		  frames the profiler kept at the end go to trace.json (see CaptureTrace).
+		 *		  only drawn frames count; with fixed updates slower than dt, the first few passes
+		 *		  have no step to draw yet, and are not numbered.
+		 */
+		void RunFrames(std::uint32_t frameCount, std::filesystem::path const& outputDir = {},
+			std::uint32_t captureEvery = 1U, float dt = 1.f / 60.f) noexcept;
+
+		/**
+		 * @brief switches to fixed updates: every frame calls OnUserUpdate as many times as the time
+		 *		  since the last frame allows, always with dt = 1 / updatesPerSecond, then draws once.
+		 *		  the simulation then behaves the same at any frame rate; InterpolationAlpha tells
+		 *		  OnUserDraw how far it is between the last two updates.
+		 *		  0 goes back to one update per frame with the measured frame delta (the default).
+		 * @param maxStepsPerFrame => the time a frame would need more updates than this for is dropped.
+		*/
+		void SetFixedUpdateRate(float updatesPerSecond, std::uint32_t maxStepsPerFrame = FixedTimestep::sc_DefaultMaxSteps);
+
+		/**
+		 * @return true if SetFixedUpdateRate was given a rate.
+		*/
+		bool IsFixedUpdate() const noexcept;
+
+		/**
+		 * @return in [0, 1), how far the frame being drawn is past the last fixed update, as a
+		 *		   fraction of one update; always 1 without fixed updates.
+		*/
+		float InterpolationAlpha() const noexcept;
+
+		/**
+		 * @brief pipelined, OnUserUpdate runs on its own thread and makes the next frame while
+		 *		  OnUserDraw draws the last one, so a slow update no longer delays drawing; frames
+		 *		  come as fast as the slower of the two, and show up one frame later.
+		 *		  the two sides only meet in OnUserHandoff, so the draw must read what it needs from
+		 *		  there (a FrameState for example), not from what the update changes; the update can not
+		 *		  use gfx or load sprites, and the draw can not read keyboard or mouse.
+		 *		  off by default; takes effect at the next frame.
+		*/
+		void SetPipelined(bool bPipelined) noexcept;
+		bool IsPipelined() const noexcept;
+
+		/**
+		 * @brief Grafix::SetRetained, for games that are retained from the start (call it from
+		 *		  OnUserCreate). a windowed frame that changed nothing presents nothing, so Run then
+		 *		  waits up to a frame for input instead of spinning.
+		*/
+		void SetRetained(bool bRetained) noexcept;
+
+		/**
+		 * @brief writes the last frameCount frames the profiler kept to file, as Chrome trace JSON
+		 *		  (open it in ui.perfetto.dev or chrome://tracing). the frames are only copied here,
+		 *		  the file is written on a thread of its own.
+		*/
+		void CaptureTrace(std::filesystem::path file, std::size_t frameCount = Profiler::sc_DefaultHistory);
+
+		/**
+		 * @brief pressing key while Run runs captures a trace into directory as trace_<frame>.json;
+		 *		  off by default (F12 is taken by the debugger), std::nullopt turns it off again.
+		*/
+		void SetTraceHotkey(std::optional<Keys> key, std::filesystem::path directory = {});
+
 		/**
 		 * @brief called once after the game window is created.
 		 */
@@ -33,12 +117,36 @@ namespace ArEngine2D {
 		*/
 		virtual void OnUserDraw(Grafix& gfx) = 0;
 
+		/**
+		 * @brief called after every update (and all its fixed steps), before the draws that show it,
+		 *		  while neither OnUserUpdate nor OnUserDraw run; publish what the draw needs here.
+		 *		  not called for frames that ran no fixed step, the last published state is still
+		 *		  the newest. does nothing by default.
+		*/
+		virtual void OnUserHandoff();
+
 	private:
 		// Initialization has it's own function for convience. (see the cpp file)
 		void Initialize();
 		// currently uses std::chrono.
 		float GetFrameDelta();
 		void UpdateTitle(float dt);
+		void ReportError(IEngineError const& err) const;
+		// the updates of one frame, in either mode; returns how many ran.
+		std::uint32_t UpdateFrame(float frameDelta);
+		void UpdateStep(float dt);
+		// the window's, timed.
+		bool ProcessMessages();
+		void DrawFrame();
+		// runs UpdateFrame, on the update thread if pipelined.
+		void BeginUpdate(float frameDelta, bool bPipelined);
+		// waits for BeginUpdate, then hands the frame over to drawing.
+		void EndUpdate();
+		// waits for a running update and ignores what it throws; for error paths.
+		void StopUpdate() noexcept;
+		void CheckTraceHotkey();
+		// waits for every trace to be written.
+		void WaitForTraces();
 
 	public:
 		/**
@@ -56,9 +164,61 @@ namespace ArEngine2D {
 		*/
 		Window& window{window_};
 
+		/**
+		 * @brief every sprite loaded through here is decoded once, and shared by whoever asks for it.
+		*/
+		SpriteCache sprites{};
+
+		/**
+		 * @brief times the engine's phases every frame (ProcessMessages, Update > InputUpdate and
+		 *		  OnUserUpdate, Draw > OnUserDraw and EndDraw, ...); games add their own zones with
+		 *		  AR2D_PROFILE_ZONE(profiler, "Name"), from any thread (it outlives jobs). see
+		 *		  Profiler::Report.
+		*/
+		Profiler profiler{};
+
+		/**
+		 * @brief worker threads for the game and the engine to split work over (ParallelFor, or jobs
+		 *		  tied together with JobCounters), one per core; whoever waits works along. headless
+		 *		  frames are rasterized on it too, and SpriteLoaders take it to decode on.
+		*/
+		JobSystem jobs{};
+
+	private:
+
+		using Clock = UpdateThread::Clock;
+
+		// how long an idle window waits for input before drawing again; a frame at 60 hz.
+		constexpr static DWORD sc_IdleWaitMs{16U};
+
+		struct FrameTiming
+		{
+			std::uint32_t steps;
+			Clock::time_point updateStart;
+			Clock::duration updateTime;
+		};
+
 	private:
 		Window window_;
 		Grafix gfx_;
+		// empty unless updates are fixed.
+		std::optional<FixedTimestep> fixedStep_{};
+		float drawAlpha_{1.f};
+
+		std::atomic<bool> bPipelined_{};
+		// started the first time a frame is pipelined.
+		std::optional<UpdateThread> updateThread_{};
+		// the update being run, and the one being drawn.
+		FrameTiming pending_{};
+		FrameTiming drawn_{};
+		// false until the first handoff, there is nothing to draw before it.
+		bool bHasFrame_{};
+
+		// started by the first capture.
+		std::optional<TraceWriter> traceWriter_{};
+		std::optional<Keys> traceKey_{};
+		std::filesystem::path traceDirectory_{};
+		bool bTraceKeyDown_{};
 	};
 }
 
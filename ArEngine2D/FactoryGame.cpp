@@ -12,6 +12,8 @@ namespace ArFac {
 		camMaxZoom_ = editor_.CalcMaxZoom(1.f * window.Width());
 		camMinZoom_ = editor_.CalcMinZoom(1.f * window.Width());
 		CenterCamera();
+		// the editor mostly sits still, so only what changed gets drawn again.
+		SetRetained(true);
 	}
 
 	void FactoryGame::OnUserUpdate(float dt)
@@ -24,10 +26,15 @@ namespace ArFac {
 	{
 		gfx.ClearScreen();
 		editor_.Draw(gfx);
-		gfx.DrawString({}, std::format("tran loc: {}", (*pActiveCam_)[mouse.loc]), Colors::Orange, 30.f);
-		gfx.DrawString({0.f, 30.f}, std::format("loc: {}", mouse.loc), Colors::Orange, 30.f);
-		gfx.DrawString({0.f, 60.f}, std::format("cam loc: {}", pActiveCam_->Loc()), Colors::Orange, 30.f);
-		gfx.DrawString({0.f, 90.f}, std::format("cam scale: {}", pActiveCam_->Scale()), Colors::Orange, 30.f);
+		debugLines_[0].SetText(std::format("tran loc: {}", (*pActiveCam_)[mouse.loc]));
+		debugLines_[1].SetText(std::format("loc: {}", mouse.loc));
+		debugLines_[2].SetText(std::format("cam loc: {}", pActiveCam_->Loc()));
+		debugLines_[3].SetText(std::format("cam scale: {}", pActiveCam_->Scale()));
+		for (std::size_t i{}; i < debugLines_.size(); ++i)
+		{
+			debugLines_[i].SetSize(30.f);
+			gfx.DrawTextLayout({0.f, 30.f * i}, debugLines_[i], Colors::Orange);
+		}
 	}
 
 	void FactoryGame::CenterCamera()
@@ -5,6 +5,8 @@
 #include "Block.h"
 #include "Editor.h"
 
+#include <array>
+
 ARFAC_BEGIN_NAMESPACE
 
 class FactoryGame : public ::ArEngine2D::Engine
@@ -32,6 +34,9 @@ private:
 		
 	Editor editor_{*this};
 
+	// debug text, only reshaped when the values change.
+	std::array<TextLayout, 4> debugLines_{};
+
 };
 
 ARFAC_END_NAMESPACE
\ No newline at end of file
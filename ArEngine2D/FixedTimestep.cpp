@@ -0,0 +1,50 @@
+#include "FixedTimestep.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace ArEngine2D {
+	FixedTimestep::FixedTimestep(float stepSeconds, std::uint32_t maxSteps)
+		: step_{stepSeconds}, maxSteps_{maxSteps}
+	{
+		assert(stepSeconds > 0.f && "FixedTimestep step must be positive");
+		assert(maxSteps > 0U && "FixedTimestep must be able to run at least one step per frame");
+	}
+	std::uint32_t FixedTimestep::Advance(float frameSeconds) noexcept
+	{
+		accumulator_ += std::max(frameSeconds, 0.f);
+		auto const whole{std::floor(accumulator_ / step_)};
+		if (whole > maxSteps_)
+		{
+			// keep the fraction, so the frames after a hitch still line up with the steps.
+			auto const kept{accumulator_ - whole * step_};
+			dropped_ += accumulator_ - kept - static_cast<double>(maxSteps_) * step_;
+			accumulator_ = kept;
+			return maxSteps_;
+		}
+		accumulator_ -= whole * step_;
+		return static_cast<std::uint32_t>(whole);
+	}
+	void FixedTimestep::Reset() noexcept
+	{
+		accumulator_ = 0.0;
+		dropped_ = 0.0;
+	}
+	float FixedTimestep::Step() const noexcept
+	{
+		return step_;
+	}
+	std::uint32_t FixedTimestep::MaxSteps() const noexcept
+	{
+		return maxSteps_;
+	}
+	float FixedTimestep::Alpha() const noexcept
+	{
+		return static_cast<float>(std::min(accumulator_ / step_, 1.0 - 1e-6));
+	}
+	double FixedTimestep::DroppedSeconds() const noexcept
+	{
+		return dropped_;
+	}
+}
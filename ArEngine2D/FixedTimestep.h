@@ -0,0 +1,113 @@
+#pragma once
+
+#include "Testing/ArTest20.h"
+
+#include <cstdint>
+
+namespace ArEngine2D {
+	/**
+	 * @brief turns variable frame deltas into a whole number of fixed steps. the time that does not
+	 *		  make a whole step carries over to the next frame, and Alpha says how far into the next
+	 *		  step the frame is, for drawing between the last two states.
+	 *		  a frame never runs more than maxSteps; the time past that is dropped, so one slow frame
+	 *		  can not snowball into slower and slower ones.
+	*/
+	class FixedTimestep
+	{
+	public:
+
+		constexpr static std::uint32_t sc_DefaultMaxSteps{5U};
+
+	public:
+
+		/**
+		 * @param stepSeconds => the dt every step simulates; must be positive.
+		 * @param maxSteps => the most steps one frame can run.
+		*/
+		explicit FixedTimestep(float stepSeconds, std::uint32_t maxSteps = sc_DefaultMaxSteps);
+
+	public:
+
+		/**
+		 * @brief adds the frame delta to the leftover time.
+		 * @return the number of steps to run this frame.
+		*/
+		std::uint32_t Advance(float frameSeconds) noexcept;
+
+		/**
+		 * @brief forgets the leftover time and the dropped time.
+		*/
+		void Reset() noexcept;
+
+	public:
+
+		float Step() const noexcept;
+		std::uint32_t MaxSteps() const noexcept;
+
+		/**
+		 * @return in [0, 1), how far the leftover time is into the next step.
+		*/
+		float Alpha() const noexcept;
+
+		/**
+		 * @return the seconds thrown away because frames needed more than maxSteps.
+		*/
+		double DroppedSeconds() const noexcept;
+
+	private:
+		float step_;
+		std::uint32_t maxSteps_;
+		// double, so thousands of frames of leftovers do not drift.
+		double accumulator_{};
+		double dropped_{};
+	};
+
+	inline void TestFixedTimestep()
+	{
+		using namespace ArTest;
+		std::ofstream file{"FixedTimestepTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Steps and leftovers") = [&] {
+			FixedTimestep timestep{0.01f};
+			tester.PassIfEqual(timestep.Advance(0.025f), std::uint32_t{2U});
+			tester.PassIfGreaterEq(timestep.Alpha(), 0.49f);
+			tester.PassIfLessEq(timestep.Alpha(), 0.51f);
+			// the leftover half step makes this one a whole step.
+			tester.PassIfEqual(timestep.Advance(0.005f), std::uint32_t{1U});
+			tester.PassIfEqual(timestep.Advance(0.004f), std::uint32_t{0U});
+		};
+
+		tester.NewTest("Same time, same steps") = [&] {
+			// 1000 frames of 1/144 s at 120 steps per second, however it's sliced.
+			FixedTimestep fine{1.f / 120.f};
+			FixedTimestep coarse{1.f / 120.f, 16U};
+			std::uint32_t fineSteps{};
+			std::uint32_t coarseSteps{};
+			for (int frame{}; frame < 1000; ++frame)
+			{
+				fineSteps += fine.Advance(1.f / 144.f);
+			}
+			for (int frame{}; frame < 100; ++frame)
+			{
+				coarseSteps += coarse.Advance(10.f / 144.f);
+			}
+			tester.PassIfEqual(fineSteps, coarseSteps);
+			tester.PassIfGreaterEq(std::uint32_t{fineSteps}, std::uint32_t{832U});
+			tester.PassIfLessEq(std::uint32_t{fineSteps}, std::uint32_t{834U});
+		};
+
+		tester.NewTest("Spiral of death") = [&] {
+			FixedTimestep timestep{0.01f, 4U};
+			tester.PassIfEqual(timestep.Advance(1.f), std::uint32_t{4U});
+			tester.PassIfGreaterEq(timestep.DroppedSeconds(), 0.95);
+			tester.PassIfLess(timestep.Alpha(), 1.f);
+			tester.PassIfEqual(timestep.Advance(0.f), std::uint32_t{0U});
+			timestep.Reset();
+			tester.PassIfEqual(timestep.DroppedSeconds(), 0.0);
+			tester.PassIfEqual(timestep.Alpha(), 0.f);
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace ArEngine2D {
+	/**
+	 * @brief two copies of whatever OnUserDraw needs: OnUserUpdate writes the back one, OnUserDraw
+	 *		  reads the front one, and Engine::OnUserHandoff publishes the back one by swapping them.
+	 *		  with Engine::SetPipelined the two run at the same time on different threads, so the
+	 *		  draw can only look at the front one (and never at what the update is changing).
+	 *
+	 *		  after a swap the back one holds an older frame; the update should overwrite all of it.
+	*/
+	template <class TState>
+	class FrameState
+	{
+	public:
+
+		FrameState() = default;
+
+		/**
+		 * @brief both copies start as initial, so the first frames have something sane to draw.
+		*/
+		explicit FrameState(TState const& initial) : buffers_{initial, initial}
+		{
+		}
+
+	public:
+
+		/**
+		 * @brief the copy the update fills in; only touch it from OnUserUpdate and OnUserHandoff.
+		*/
+		TState& Back() noexcept
+		{
+			return buffers_[1U - front_];
+		}
+
+		/**
+		 * @brief the copy that was published last; only touch it from OnUserDraw and OnUserHandoff.
+		*/
+		TState const& Front() const noexcept
+		{
+			return buffers_[front_];
+		}
+
+		/**
+		 * @brief makes the back copy the front one; call it from OnUserHandoff.
+		*/
+		void Publish() noexcept
+		{
+			front_ = 1U - front_;
+			++publishCount_;
+		}
+
+		/**
+		 * @return how many times Publish was called.
+		*/
+		std::size_t PublishCount() const noexcept
+		{
+			return publishCount_;
+		}
+
+	private:
+		std::array<TState, 2U> buffers_{};
+		std::size_t front_{};
+		std::size_t publishCount_{};
+	};
+}
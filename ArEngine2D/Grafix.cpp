@@ -1,8 +1,57 @@
 #include "Grafix.h"
 
 #include "Camera.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iterator>
+#include <limits>
 
 namespace ArEngine2D {
+	namespace {
+		static_assert(sizeof(RawPoint) == sizeof(D2D1_POINT_2F));
+		static_assert(sizeof(RawRect) == sizeof(D2D1_RECT_F));
+		static_assert(sizeof(RawColor) == sizeof(D2D1_COLOR_F));
+		static_assert(sizeof(RawMatrix) == sizeof(D2D1_MATRIX_3X2_F));
+
+		RawPoint ToRaw(Vec2 const& point) noexcept
+		{
+			return {point.x, point.y};
+		}
+		RawRect ToRaw(D2D1_RECT_F const& rect) noexcept
+		{
+			return std::bit_cast<RawRect>(rect);
+		}
+		RawColor ToRaw(ColorF const& color) noexcept
+		{
+			return std::bit_cast<RawColor>(color.ToD2DColor());
+		}
+		RawMatrix ToRaw(Transform const& transform) noexcept
+		{
+			return std::bit_cast<RawMatrix>(static_cast<D2D1_MATRIX_3X2_F const&>(transform.Matrix()));
+		}
+		// the box with corners a and b (in any order), grown by amount on every side.
+		RawRect BoundsOf(Vec2 const& a, Vec2 const& b, float amount = 0.f) noexcept
+		{
+			return RawRect{std::min(a.x, b.x), std::min(a.y, b.y), std::max(a.x, b.x), std::max(a.y, b.y)}.Inflated(amount);
+		}
+		// the i-th value of an instanced draw span, or its only value if it holds just one.
+		template <class T>
+		T const& Nth(std::span<T const> values, std::size_t i) noexcept
+		{
+			return values[values.size() == 1U ? 0U : i];
+		}
+		template <class T>
+		bool IsInstanceSpan(std::span<T const> values, std::size_t count) noexcept
+		{
+			return values.size() == 1U or values.size() == count;
+		}
+	}
+
 	void Grafix::Initialize(HWND windowHandle)
 	{
 		assert(not IsInitialized() && "double initialization of Grafix");
@@ -21,7 +70,10 @@ namespace ArEngine2D {
 
 		HANDLE_GRAPHICS_ERROR(pFactory_->CreateHwndRenderTarget(
 			D2D1::RenderTargetProperties(),
-			D2D1::HwndRenderTargetProperties(windowHandle, D2D1::SizeU(clientWidth, clientHeight)),
+			// retained mode only redraws parts of the frame, so the rest has to survive presenting.
+			D2D1::HwndRenderTargetProperties(windowHandle, D2D1::SizeU(clientWidth, clientHeight),
+				D2D1_PRESENT_OPTIONS_RETAIN_CONTENTS
+			),
 			pRenderTarget_.GetAddressOf()
 		));
 
@@ -29,90 +81,264 @@ namespace ArEngine2D {
 			{}, pSolidBrush_.GetAddressOf()
 		));
 
+		// sprite batches need windows 10 (creators update); without them, EndSpriteBatch falls
+		// back to drawing the bitmaps one by one.
+		if (SUCCEEDED(pRenderTarget_.As(&pContext3_)))
+		{
+			HANDLE_GRAPHICS_ERROR(pContext3_->CreateSpriteBatch(pD2DSpriteBatch_.GetAddressOf()));
+		}
+
+		InitializeCommon();
+		Sprite::InternalInitialization(pRenderTarget_);
+	}
+	void Grafix::InitializeHeadless(std::uint32_t width, std::uint32_t height, JobSystem& jobs)
+	{
+		assert(not IsInitialized() && "double initialization of Grafix");
+		bHeadless_ = true;
+		this->width_  = static_cast<float>(width);
+		this->height_ = static_cast<float>(height);
+		frameBuffer_.Resize(width, height, 0xFF'00'00'00U);
+		pRasterJobs_ = &jobs;
+
+		// still needed for geometries, text layouts and loading sprites.
+		HANDLE_GRAPHICS_ERROR(D2D1CreateFactory(
+			D2D1_FACTORY_TYPE_SINGLE_THREADED, pFactory_.GetAddressOf()
+		));
+
+		// sprites still create direct2d bitmaps, so they need some render target; a 1x1
+		// software one does not touch the gpu. they also keep their pixels for the rasterizer.
+		Details::Ptr<IWICImagingFactory> pImagingFactory{};
+		Details::Ptr<IWICBitmap> pTargetBitmap{};
+		Details::Ptr<ID2D1RenderTarget> pSpriteTarget{};
+		HANDLE_GRAPHICS_ERROR(CoInitialize(nullptr));
+		HANDLE_GRAPHICS_ERROR(CoCreateInstance(
+			CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, __uuidof(pImagingFactory.Get()), &pImagingFactory
+		));
+		HANDLE_GRAPHICS_ERROR(pImagingFactory->CreateBitmap(
+			1U, 1U, GUID_WICPixelFormat32bppPBGRA, WICBitmapCacheOnLoad, &pTargetBitmap
+		));
+		HANDLE_GRAPHICS_ERROR(pFactory_->CreateWicBitmapRenderTarget(pTargetBitmap.Get(),
+			D2D1::RenderTargetProperties(D2D1_RENDER_TARGET_TYPE_SOFTWARE), &pSpriteTarget
+		));
+
+		InitializeCommon();
+		Sprite::InternalInitialization(std::move(pSpriteTarget), true);
+	}
+	void Grafix::InitializeCommon()
+	{
 		HANDLE_GRAPHICS_ERROR(DWriteCreateFactory(
 			DWRITE_FACTORY_TYPE_SHARED, __uuidof(pDWriteFactory_), &pDWriteFactory_
 		));
+		textFormats_.Initialize(pDWriteFactory_);
+		fontFamily_ = textFormats_.RegisterFamily(L"Consolas");
+		TextLayout::InternalInitialization(pDWriteFactory_, &textFormats_);
 
 		// so the program does not have to check for empty stack for every call to PopTransform.
-		PushTransform({});
+		ResetTransform();
+		damage_.SetBounds({0.f, 0.f, width_, height_});
 		
-		Sprite::InternalInitialization(pRenderTarget_);
 		Camera::InternalInitialization(&width_, &height_);
 	}
 	void Grafix::BeginDraw()
 	{
-		pRenderTarget_->BeginDraw();
+		if (bRetained_ != bRetainedNext_)
+		{
+			bRetained_ = bRetainedNext_;
+			bRetainedValid_ = false;
+		}
+		textFormats_.ResetCounters();
+		TextLayout::ResetBuildCount();
+		geometries_.ResetCounters();
+		commands_.Reset();
+		frameBitmaps_.clear();
+		frameImages_.clear();
+		frameImageOwners_.clear();
+		frameImageKeys_.clear();
+		transformChanges_ = 0U;
+		batchedSprites_   = 0U;
+		spriteBatchDraws_ = 0U;
+		instancedDraws_   = 0U;
+		instancedShapes_  = 0U;
+		culledDraws_      = 0U;
+		drawnDraws_       = 0U;
+		// the render target keeps its transform between frames, but something outside
+		// of Grafix might have changed it, so the first draw of a frame always sets it.
+		bAppliedMatrixKnown_ = false;
+		// retained frames only open the render target if something changed.
+		if (not bHeadless_ and not bRetained_)
+		{
+			pRenderTarget_->BeginDraw();
+		}
 	}
 	void Grafix::EndDraw()
 	{
-		HANDLE_ENDDRAW_ERROR(pRenderTarget_.Get());
+		lastFrameStats_.deferredCommands = 0U;
+		lastFrameStats_.colorChanges     = 0U;
+		lastFrameStats_.rasterizedPixels = 0U;
+		lastFrameStats_.renderedPixels   = static_cast<std::uint64_t>(width_) * static_cast<std::uint64_t>(height_);
+		lastFrameStats_.damageRects      = 0U;
+		lastFrameStats_.presents         = 1U;
+		// recorded frames keep the order they were drawn in, unless deferred mode asks for sorting.
+		if (bDeferred_)
+		{
+			commands_.Sort();
+		}
+
+		if (bRetained_)
+		{
+			EndRetainedFrame();
+		}
+		else if (bHeadless_)
+		{
+			rasterizer_.ResetStats();
+			if (pRasterJobs_->ThreadCount() > 1U)
+			{
+				rasterizer_.RenderTiled(commands_, frameBuffer_, frameImages_, *pRasterJobs_);
+			}
+			else
+			{
+				rasterizer_.Render(commands_, frameBuffer_, frameImages_);
+			}
+			lastFrameStats_.deferredCommands = commands_.Size();
+			lastFrameStats_.rasterizedPixels = rasterizer_.GetStats().pixels;
+			if (bCaptureRequested_)
+			{
+				capturedFrame_ = frameBuffer_;
+			}
+		}
+		else
+		{
+			if (not commands_.IsEmpty())
+			{
+				SubmitDeferred();
+			}
+			if (bCaptureRequested_)
+			{
+				CaptureRenderTarget();
+			}
+			HANDLE_ENDDRAW_ERROR(pRenderTarget_.Get());
+		}
+		bCaptureRequested_ = false;
+
+		lastFrameStats_.textFormatHits   = textFormats_.Hits();
+		lastFrameStats_.textFormatMisses = textFormats_.Misses();
+		lastFrameStats_.textAllocations  = textFormats_.Allocations();
+		lastFrameStats_.textLayoutBuilds = TextLayout::BuildCount();
+		lastFrameStats_.geometryHits     = geometries_.Hits();
+		lastFrameStats_.geometryMisses   = geometries_.Misses();
+		lastFrameStats_.transformChanges = transformChanges_;
+		lastFrameStats_.batchedSprites   = batchedSprites_;
+		lastFrameStats_.spriteBatchDraws = spriteBatchDraws_;
+		lastFrameStats_.instancedDraws   = instancedDraws_;
+		lastFrameStats_.instancedShapes  = instancedShapes_;
+		lastFrameStats_.culledDraws      = culledDraws_;
+		lastFrameStats_.drawnDraws       = drawnDraws_;
 	}
-	void Grafix::ClearScreen(ColorF const& color) noexcept
+	void Grafix::ClearScreen(ColorF const& color)
 	{
+		if (IsRecording())
+		{
+			return commands_.AddClear(ToRaw(color));
+		}
 		pRenderTarget_->Clear(color.ToD2DColor());
 	}
-	void Grafix::DrawLine(Vec2 const& from, Vec2 const& to, ColorF const& color, float thick) noexcept
+	void Grafix::DrawLine(Vec2 const& from, Vec2 const& to, ColorF const& color, float thick)
 	{
+		if (Culled(BoundsOf(from, to, thick * 0.5f)))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			return Record(color).AddLine(ToRaw(from), ToRaw(to), thick);
+		}
 		pSolidBrush_->SetColor(color.ToD2DColor());
 		BeginTransform();
 		pRenderTarget_->DrawLine(from.ToD2DPoint(), to.ToD2DPoint(), pSolidBrush_.Get(), thick);
-		EndTransform();
 	}
-	void Grafix::DrawEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color, float thick) noexcept
+	void Grafix::DrawEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color, float thick)
 	{
+		if (Culled(BoundsOf(loc - Vec2{rx, ry}, loc + Vec2{rx, ry}, thick * 0.5f)))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			return Record(color).AddEllipse(ToRaw(loc), rx, ry, thick, false);
+		}
 		pSolidBrush_->SetColor(color.ToD2DColor());
 		auto const elli{D2D1::Ellipse(loc.ToD2DPoint(), rx, ry)};
 		BeginTransform();
 		pRenderTarget_->DrawEllipse(elli, pSolidBrush_.Get(), thick);
-		EndTransform();
 	}
-	void Grafix::FillEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color) noexcept
+	void Grafix::FillEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color)
 	{
+		if (Culled(BoundsOf(loc - Vec2{rx, ry}, loc + Vec2{rx, ry})))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			return Record(color).AddEllipse(ToRaw(loc), rx, ry, 1.f, true);
+		}
 		pSolidBrush_->SetColor(color.ToD2DColor());
 		auto const elli{D2D1::Ellipse(loc.ToD2DPoint(), rx, ry)};
 		BeginTransform();
 		pRenderTarget_->FillEllipse(elli, pSolidBrush_.Get());
-		EndTransform();
 	}
-	void Grafix::DrawCircle(Vec2 const& loc, float r, ColorF const& color, float thick) noexcept
+	void Grafix::DrawCircle(Vec2 const& loc, float r, ColorF const& color, float thick)
 	{
 		DrawEllipse(loc, r, r, color, thick);
 	}
-	void Grafix::FillCircle(Vec2 const& loc, float r, ColorF const& color) noexcept
+	void Grafix::FillCircle(Vec2 const& loc, float r, ColorF const& color)
 	{ 
 		FillEllipse(loc, r, r, color);
 	}
-	void Grafix::DrawRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color, float thick) noexcept
+	void Grafix::DrawRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color, float thick)
 	{
+		if (Culled(BoundsOf(topLeft, botRight, thick * 0.5f)))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			return Record(color).AddRectangle({topLeft.x, topLeft.y, botRight.x, botRight.y}, thick, false);
+		}
 		pSolidBrush_->SetColor(color.ToD2DColor());
 		auto const rect{D2D1::RectF(topLeft.x, topLeft.y, botRight.x, botRight.y)};
 		BeginTransform();
 		pRenderTarget_->DrawRectangle(rect, pSolidBrush_.Get(), thick);
-		EndTransform();
 	}
-	void Grafix::FillRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color) noexcept
+	void Grafix::FillRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color)
 	{
+		if (Culled(BoundsOf(topLeft, botRight)))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			return Record(color).AddRectangle({topLeft.x, topLeft.y, botRight.x, botRight.y}, 1.f, true);
+		}
 		pSolidBrush_->SetColor(color.ToD2DColor());
 		auto const rect{D2D1::RectF(topLeft.x, topLeft.y, botRight.x, botRight.y)};
 		BeginTransform();
 		pRenderTarget_->FillRectangle(rect, pSolidBrush_.Get());
-		EndTransform();
 	}
-	void Grafix::DrawRectangle(Vec2 const& loc, float w, float h, ColorF const& color, float thick) noexcept
+	void Grafix::DrawRectangle(Vec2 const& loc, float w, float h, ColorF const& color, float thick)
 	{
 		DrawRectangle(loc, {loc.x + w, loc.y + h}, color, thick);
 	}
-	void Grafix::FillRectangle(Vec2 const& loc, float w, float h, ColorF const& color) noexcept
+	void Grafix::FillRectangle(Vec2 const& loc, float w, float h, ColorF const& color)
 	{
 		FillRectangle(loc, {loc.x + w, loc.y + h}, color);
 	}
-	void Grafix::DrawRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color, float thick) noexcept
+	void Grafix::DrawRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color, float thick)
 	{
 		auto const hw{w * 0.5f};
 		auto const hh{h * 0.5f};
 		DrawRectangle({loc.x - hw, loc.y - hh}, {loc.x + hw, loc.y + hh}, color, thick);
 	}
-	void Grafix::FillRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color) noexcept
+	void Grafix::FillRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color)
 	{
 		auto const hw{w * 0.5f};
 		auto const hh{h * 0.5f};
@@ -120,35 +346,13 @@ namespace ArEngine2D {
 	}
 	void Grafix::DrawTriangle(Vec2 const& loc, Vec2 const& p0, Vec2 const& p1, Vec2 const& p2, ColorF const& color, float thick)
 	{
-		pSolidBrush_->SetColor(color.ToD2DColor());
-		auto const pGeometry{GenerateGeometry(
-			p0,
-			D2D1_FIGURE_BEGIN_HOLLOW, 
-			D2D1_FIGURE_END_CLOSED, 
-			[&](auto p) {
-				p->AddLine(p1);
-				p->AddLine(p2);
-			}
-		)};
-		BeginTransform(D2D1::Matrix3x2F::Translation(loc.x, loc.y));
-		pRenderTarget_->DrawGeometry(pGeometry.Get(), pSolidBrush_.Get(), thick);
-		EndTransform();
+		std::array const vertices{p0, p1, p2};
+		DrawGeometry(loc, FindOrBuildGeometry(vertices), color, thick);
 	}
 	void Grafix::FillTriangle(Vec2 const& loc, Vec2 const& p0, Vec2 const& p1, Vec2 const& p2, ColorF const& color)
 	{
-		pSolidBrush_->SetColor(color.ToD2DColor());
-		auto const pGeometry{GenerateGeometry(
-			p0,
-			D2D1_FIGURE_BEGIN_FILLED,
-			D2D1_FIGURE_END_CLOSED,
-			[&](auto p) {
-				p->AddLine(p1);
-				p->AddLine(p2);
-			}
-		)};
-		BeginTransform(D2D1::Matrix3x2F::Translation(loc.x, loc.y));
-		pRenderTarget_->FillGeometry(pGeometry.Get(), pSolidBrush_.Get());
-		EndTransform();
+		std::array const vertices{p0, p1, p2};
+		FillGeometry(loc, FindOrBuildGeometry(vertices), color);
 	}
 	void Grafix::DrawPolygon(Vec2 const& loc, std::vector<Vec2> const& vertices, ColorF const& color, float thick)
 	{
@@ -161,21 +365,7 @@ namespace ArEngine2D {
 			return DrawLine(loc + vertices[0], loc + vertices[1], color, thick);
 		}
 
-		pSolidBrush_->SetColor(color.ToD2DColor());
-		auto const pGeometry{GenerateGeometry(
-			vertices[0],
-			D2D1_FIGURE_BEGIN_HOLLOW,
-			D2D1_FIGURE_END_CLOSED,
-			[&](auto p) {
-				for (size_t i{1}, lim{vertices.size()}; i < lim; ++i)
-				{
-					p->AddLine(vertices[i]);
-				}
-			}
-		)};
-		BeginTransform(D2D1::Matrix3x2F::Translation(loc.x, loc.y));
-		pRenderTarget_->DrawGeometry(pGeometry.Get(), pSolidBrush_.Get(), thick);
-		EndTransform();
+		DrawGeometry(loc, FindOrBuildGeometry(vertices), color, thick);
 	}
 	void Grafix::FillPolygon(Vec2 const& loc, std::vector<Vec2> const& vertices, ColorF const& color)
 	{
@@ -188,23 +378,54 @@ namespace ArEngine2D {
 			return DrawLine(loc + vertices[0], loc + vertices[1], color, 1.f);
 		}
 
+		FillGeometry(loc, FindOrBuildGeometry(vertices), color);
+	}
+	void Grafix::DrawGeometry(Vec2 const& loc, CachedGeometry const& geometry, ColorF const& color, float thick)
+	{
+		assert(geometry.IsInitialized() && "Use of uninitialized CachedGeometry");
+		auto const bounds{ToRaw(geometry.Bounds())};
+		if (Culled(RawRect{bounds.left + loc.x, bounds.top + loc.y, bounds.right + loc.x, bounds.bottom + loc.y}.Inflated(thick * 0.5f)))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			scratchPoints_.clear();
+			std::ranges::transform(geometry.Vertices(), std::back_inserter(scratchPoints_), [](Vec2 const& vert) { return ToRaw(vert); });
+			auto& buffer{Record(color, D2D1::Matrix3x2F::Translation(loc.x, loc.y))};
+			return buffer.AddPolygon(scratchPoints_, thick, false);
+		}
+		pSolidBrush_->SetColor(color.ToD2DColor());
+		BeginTransform(D2D1::Matrix3x2F::Translation(loc.x, loc.y));
+		pRenderTarget_->DrawGeometry(geometry.D2DPtr().Get(), pSolidBrush_.Get(), thick);
+	}
+	void Grafix::FillGeometry(Vec2 const& loc, CachedGeometry const& geometry, ColorF const& color)
+	{
+		assert(geometry.IsInitialized() && "Use of uninitialized CachedGeometry");
+		auto const bounds{ToRaw(geometry.Bounds())};
+		if (Culled({bounds.left + loc.x, bounds.top + loc.y, bounds.right + loc.x, bounds.bottom + loc.y}))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			scratchPoints_.clear();
+			std::ranges::transform(geometry.Vertices(), std::back_inserter(scratchPoints_), [](Vec2 const& vert) { return ToRaw(vert); });
+			auto& buffer{Record(color, D2D1::Matrix3x2F::Translation(loc.x, loc.y))};
+			return buffer.AddPolygon(scratchPoints_, 1.f, true);
+		}
 		pSolidBrush_->SetColor(color.ToD2DColor());
-		auto const pGeometry{GenerateGeometry(
-			vertices[0],
-			D2D1_FIGURE_BEGIN_FILLED,
-			D2D1_FIGURE_END_CLOSED,
-			[&](auto p) {
-				for (size_t i{1}, lim{vertices.size()}; i < lim; ++i)
-				{
-					p->AddLine(vertices[i]);
-				}
-			}
-		)};
 		BeginTransform(D2D1::Matrix3x2F::Translation(loc.x, loc.y));
-		pRenderTarget_->FillGeometry(pGeometry.Get(), pSolidBrush_.Get());
-		EndTransform();
+		pRenderTarget_->FillGeometry(geometry.D2DPtr().Get(), pSolidBrush_.Get());
 	}
 	void Grafix::DrawArrow(Vec2 const& from, Vec2 const& to, ColorF const& color, float thick)
+	{
+		auto const [southEast, southWest]{ArrowHead(from, to)};
+		DrawLine(from, to, color, thick);
+		DrawLine(to, southEast, color, thick);
+		DrawLine(to, southWest, color, thick);
+	}
+	std::array<Vec2, 2U> Grafix::ArrowHead(Vec2 const& from, Vec2 const& to) noexcept
 	{
 		constexpr auto MyMin{10.f};
 		constexpr auto MyRatio{0.05f};
@@ -216,46 +437,190 @@ namespace ArEngine2D {
 		auto const vSouthEast{(vEast - vNorm).Normalized()};
 		auto const dist{Vec2::Dist(from, to)};
 		auto const legSize{std::max(MyRatio * dist, MyMin)};
-		
-		DrawLine(from, to, color, thick);
-		DrawLine(to, to + vSouthEast * legSize, color, thick);
-		DrawLine(to, to + vSouthWest * legSize, color, thick);
+
+		return {to + vSouthEast * legSize, to + vSouthWest * legSize};
 	}
-	void Grafix::DrawString(Vec2 const& loc, std::string str, ColorF const& color, float size)
+	void Grafix::FillCircles(std::span<Vec2 const> centers, std::span<float const> radii, std::span<ColorF const> colors)
 	{
-		DrawStringRect(str, color, size, D2D1::RectF(
-			loc.x, loc.y, 
-			std::numeric_limits<float>::max(), 
-			std::numeric_limits<float>::max()
-		));
+		assert(IsInstanceSpan(radii, centers.size()) && "FillCircles needs one radius, or one for every circle");
+		DrawInstances(centers.size(), colors,
+			[&](std::size_t i) {
+				auto const r{Nth(radii, i)};
+				return BoundsOf(centers[i] - Vec2{r, r}, centers[i] + Vec2{r, r});
+			},
+			[&](std::size_t i) {
+				auto const r{Nth(radii, i)};
+				commands_.AddEllipse(ToRaw(centers[i]), r, r, 1.f, true);
+			},
+			[&](std::size_t i) {
+				auto const r{Nth(radii, i)};
+				pRenderTarget_->FillEllipse(D2D1::Ellipse(centers[i].ToD2DPoint(), r, r), pSolidBrush_.Get());
+			}
+		);
 	}
-	void Grafix::DrawStringCenter(Vec2 const& loc, std::string str, ColorF const& color, float size)
+	void Grafix::DrawCircles(std::span<Vec2 const> centers, std::span<float const> radii, std::span<ColorF const> colors, float thick)
+	{
+		assert(IsInstanceSpan(radii, centers.size()) && "DrawCircles needs one radius, or one for every circle");
+		DrawInstances(centers.size(), colors,
+			[&](std::size_t i) {
+				auto const r{Nth(radii, i)};
+				return BoundsOf(centers[i] - Vec2{r, r}, centers[i] + Vec2{r, r}, thick * 0.5f);
+			},
+			[&](std::size_t i) {
+				auto const r{Nth(radii, i)};
+				commands_.AddEllipse(ToRaw(centers[i]), r, r, thick, false);
+			},
+			[&](std::size_t i) {
+				auto const r{Nth(radii, i)};
+				pRenderTarget_->DrawEllipse(D2D1::Ellipse(centers[i].ToD2DPoint(), r, r), pSolidBrush_.Get(), thick);
+			}
+		);
+	}
+	void Grafix::DrawLines(std::span<Vec2 const> froms, std::span<Vec2 const> tos, std::span<ColorF const> colors, float thick)
+	{
+		assert(froms.size() == tos.size() && "DrawLines needs as many ends as starts");
+		DrawInstances(froms.size(), colors,
+			[&](std::size_t i) { return BoundsOf(froms[i], tos[i], thick * 0.5f); },
+			[&](std::size_t i) { commands_.AddLine(ToRaw(froms[i]), ToRaw(tos[i]), thick); },
+			[&](std::size_t i) {
+				pRenderTarget_->DrawLine(froms[i].ToD2DPoint(), tos[i].ToD2DPoint(), pSolidBrush_.Get(), thick);
+			}
+		);
+	}
+	void Grafix::FillRects(std::span<Vec2 const> topLefts, std::span<Vec2 const> sizes, std::span<ColorF const> colors)
+	{
+		assert(IsInstanceSpan(sizes, topLefts.size()) && "FillRects needs one size, or one for every rectangle");
+		DrawInstances(topLefts.size(), colors,
+			[&](std::size_t i) { return BoundsOf(topLefts[i], topLefts[i] + Nth(sizes, i)); },
+			[&](std::size_t i) {
+				auto const botRight{topLefts[i] + Nth(sizes, i)};
+				commands_.AddRectangle({topLefts[i].x, topLefts[i].y, botRight.x, botRight.y}, 1.f, true);
+			},
+			[&](std::size_t i) {
+				auto const botRight{topLefts[i] + Nth(sizes, i)};
+				pRenderTarget_->FillRectangle(D2D1::RectF(topLefts[i].x, topLefts[i].y, botRight.x, botRight.y), pSolidBrush_.Get());
+			}
+		);
+	}
+	template <class TBounds, class TRecord, class TDraw>
+	void Grafix::DrawInstances(std::size_t count, std::span<ColorF const> colors, TBounds const& boundsOf,
+		TRecord const& record, TDraw const& draw)
+	{
+		assert(IsInstanceSpan(colors, count) && "Instanced draws need one color, or one for every shape");
+		if (count == 0U)
+		{
+			return;
+		}
+		++instancedDraws_;
+
+		// the transform is the same for every shape, so it's set once.
+		auto const bRecording{IsRecording()};
+		if (bRecording)
+		{
+			commands_.SetTransform(ToRaw(pushedTransform_));
+		}
+		else
+		{
+			BeginTransform();
+		}
+
+		auto bColorSet{false};
+		RawColor lastColor{};
+		for (std::size_t i{}; i < count; ++i)
+		{
+			if (Culled(boundsOf(i)))
+			{
+				continue;
+			}
+			++instancedShapes_;
+
+			auto const color{ToRaw(Nth(colors, i))};
+			if (not bColorSet or not (color == lastColor))
+			{
+				bColorSet = true;
+				lastColor = color;
+				if (bRecording)
+				{
+					commands_.SetColor(color);
+				}
+				else
+				{
+					pSolidBrush_->SetColor(std::bit_cast<D2D1_COLOR_F>(color));
+				}
+			}
+
+			if (bRecording)
+			{
+				record(i);
+			}
+			else
+			{
+				draw(i);
+			}
+		}
+	}
+	void Grafix::DrawString(Vec2 const& loc, std::string_view str, ColorF const& color, float size)
+	{
+		DrawTextLayout(loc, CachedLayout(str, size, fontFamily_, fontWeight_), color);
+	}
+	void Grafix::DrawStringCenter(Vec2 const& loc, std::string_view str, ColorF const& color, float size)
 	{ 
-		auto const sizeInPixels{size * 0.55f};
-		DrawString({loc.x - (0.5f * str.size()) * sizeInPixels, loc.y - 1.25f * sizeInPixels}, str, color, size);
+		DrawTextLayoutCenter(loc, CachedLayout(str, size, fontFamily_, fontWeight_), color);
 	}
-	void Grafix::DrawStringRect(std::string str, ColorF const& color, float size, D2D1_RECT_F rect)
+	void Grafix::DrawStringRect(std::string_view str, ColorF const& color, float size, D2D1_RECT_F rect)
 	{
+		// the text is clipped to rect.
+		if (Culled(ToRaw(rect)))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			return Record(color).AddText(str, ToRaw(rect), size, fontFamily_, static_cast<std::uint8_t>(fontWeight_));
+		}
+
 		pSolidBrush_->SetColor(color);
 
 		// make the size in pixels
 		size *= 1.f / 0.55f;
 
-		Details::Ptr<IDWriteTextFormat> pFormat{ };
-		HANDLE_GRAPHICS_ERROR(pDWriteFactory_->CreateTextFormat(
-			L"Consolas", nullptr, DWRITE_FONT_WEIGHT_NORMAL, DWRITE_FONT_STYLE_NORMAL,
-			DWRITE_FONT_STRETCH_NORMAL, size, L"", &pFormat
-		));
-
-		std::wstring const wstr{str.begin(), str.end()};
+		auto const pFormat{textFormats_.Get(fontFamily_, size, fontWeight_)};
+		auto const wstr{textFormats_.Widen(str)};
 
 		BeginTransform();
-		pRenderTarget_->DrawTextW(wstr.c_str(), static_cast<UINT32>(std::size(wstr)),
-			pFormat.Get(), rect, pSolidBrush_.Get(),
+		pRenderTarget_->DrawTextW(wstr.data(), static_cast<UINT32>(std::size(wstr)),
+			pFormat, rect, pSolidBrush_.Get(),
 			D2D1_DRAW_TEXT_OPTIONS_CLIP,
 			DWRITE_MEASURING_MODE_NATURAL
 		);
-		EndTransform();
+	}
+	void Grafix::DrawTextLayout(Vec2 const& loc, TextLayout const& layout, ColorF const& color)
+	{
+		// glyphs may overhang the layout box a little, so it's grown by the font size.
+		auto const [w, h] {layout.Bounds()};
+		if (Culled(BoundsOf(loc, {loc.x + w, loc.y + h}, layout.Size())))
+		{
+			return;
+		}
+		if (IsRecording())
+		{
+			// an infinite rect means "not clipped"; it's drawn through a cached layout when submitted.
+			constexpr auto Inf{std::numeric_limits<float>::infinity()};
+			return Record(color).AddText(layout.Text(), {loc.x, loc.y, Inf, Inf}, layout.Size(),
+				layout.Family(), static_cast<std::uint8_t>(layout.Weight()), {w, h}
+			);
+		}
+		pSolidBrush_->SetColor(color);
+		auto const& pLayout{layout.D2DPtr()};
+		BeginTransform();
+		pRenderTarget_->DrawTextLayout(loc.ToD2DPoint(), pLayout.Get(), pSolidBrush_.Get(),
+			D2D1_DRAW_TEXT_OPTIONS_NONE
+		);
+	}
+	void Grafix::DrawTextLayoutCenter(Vec2 const& loc, TextLayout const& layout, ColorF const& color)
+	{
+		auto const [w, h] {layout.Bounds()};
+		DrawTextLayout({loc.x - w * 0.5f, loc.y - h * 0.5f}, layout, color);
 	}
 	void Grafix::DrawSprite(Vec2 const& loc, Sprite const& sprite, float opacity, Transform const& tr)
 	{
@@ -275,9 +640,22 @@ namespace ArEngine2D {
 		D2D1_RECT_F const destRect{
 			loc.x, loc.y, loc.x + (rect.right - rect.left), loc.y + (rect.bottom - rect.top)
 		}; 
+		if (Culled(ToRaw(destRect), tr))
+		{
+			return;
+		}
+		// views (atlas images) sample their part of the bitmap, scaled down sprites a smaller level.
+		auto const level{MipLevelFor(sprite, tr)};
+		auto const source{sprite.MipSourceRect(rect, level)};
+		if (IsRecording())
+		{
+			auto const image{FrameImage(sprite, level)};
+			return Record(tr >> pushedTransform_).AddSprite(image, ToRaw(destRect), ToRaw(source), opacity,
+				static_cast<std::uint8_t>(interpolationMode_)
+			);
+		}
 		BeginTransform(tr);
-		pRenderTarget_->DrawBitmap(sprite.D2DPtr().Get(), destRect, opacity, interpolationMode_, rect);
-		EndTransform();
+		pRenderTarget_->DrawBitmap(sprite.D2DPtr(level).Get(), destRect, opacity, interpolationMode_, source);
 	}
 	void Grafix::DrawSpriteSheet(Vec2 const& loc, SpriteSheet const& sheet, std::uint32_t frameNumber, float opacity, Transform const& tr)
 	{
@@ -287,27 +665,78 @@ namespace ArEngine2D {
 	{
 		DrawSpriteRect(loc, sheet, sheet.FrameRectF(sheet.CurrFrame()), opacity, tr);
 	}
+	void Grafix::BeginSpriteBatch()
+	{
+		assert(not bInSpriteBatch_ && "BeginSpriteBatch called twice without EndSpriteBatch");
+		bInSpriteBatch_ = true;
+		spriteBatch_.Begin();
+		batchBitmaps_.clear();
+		batchBitmapLut_.clear();
+	}
+	void Grafix::BatchSprite(Sprite const& sprite, D2D1_RECT_F rect, Transform const& dest, float opacity)
+	{
+		assert(bInSpriteBatch_ && "BatchSprite called outside of BeginSpriteBatch and EndSpriteBatch");
+		if (IsRecording())
+		{
+			// the command buffer does its own sorting, so the sprite is just recorded.
+			++batchedSprites_;
+			return DrawSpriteRect({}, sprite, rect, opacity, dest);
+		}
+		if (Culled({0.f, 0.f, rect.right - rect.left, rect.bottom - rect.top}, dest))
+		{
+			return;
+		}
+		++batchedSprites_;
+
+		auto const level{MipLevelFor(sprite, dest)};
+		auto pBitmap{sprite.D2DPtr(level)};
+		auto const [it, bInserted] {batchBitmapLut_.try_emplace(pBitmap.Get(), batchBitmaps_.size())};
+		if (bInserted)
+		{
+			batchBitmaps_.push_back(std::move(pBitmap));
+		}
+		spriteBatch_.Push(it->second, ToRaw(sprite.MipSourceRect(rect, level)), ToRaw(dest >> pushedTransform_), opacity,
+			static_cast<std::uint8_t>(interpolationMode_)
+		);
+	}
+	void Grafix::BatchSprite(Sprite const& sprite, Transform const& dest, float opacity)
+	{
+		BatchSprite(sprite, sprite.RectF(), dest, opacity);
+	}
+	void Grafix::EndSpriteBatch()
+	{
+		assert(bInSpriteBatch_ && "EndSpriteBatch called without BeginSpriteBatch");
+		bInSpriteBatch_ = false;
+		if (spriteBatch_.IsEmpty())
+		{
+			return;
+		}
+
+		spriteBatch_.GroupEntries();
+		for (auto const& group : spriteBatch_.Groups())
+		{
+			DrawSpriteBatchGroup(group);
+		}
+	}
 	void Grafix::PushTransform(Transform const& newTransform)
 	{
-		tranDoubleStack_.push({});
-		tranDoubleStack_.top().push(pushedTransform_);
-		pushedTransform_.Append(newTransform);
+		transforms_.Push(ToRaw(newTransform));
+		OnTransformChanged();
 	}
 	void Grafix::PopTransform()
 	{
-		assert(not tranDoubleStack_.empty() && "Tried to pop an empty transform stack");
-		tranDoubleStack_.pop();
-		pushedTransform_ = tranDoubleStack_.top().top();
+		transforms_.Pop();
+		OnTransformChanged();
 	}
-	void Grafix::AppendTransform(Transform const& what) noexcept
+	void Grafix::AppendTransform(Transform const& what)
 	{
-		tranDoubleStack_.top().push(pushedTransform_);
-		pushedTransform_.Append(what);
+		transforms_.Append(ToRaw(what));
+		OnTransformChanged();
 	}
 	void Grafix::UndoTransform() noexcept
 	{
-		pushedTransform_ = tranDoubleStack_.top().top();
-		tranDoubleStack_.top().pop();
+		transforms_.Undo();
+		OnTransformChanged();
 	}
 	Transform const& Grafix::GetFullTransform() const noexcept
 	{
@@ -315,11 +744,8 @@ namespace ArEngine2D {
 	}
 	void Grafix::ResetTransform() noexcept
 	{
-		for (size_t i{}, lim{tranDoubleStack_.size()}; i < lim; ++i)
-		{
-			tranDoubleStack_.pop();
-		}
-		pushedTransform_.Reset();
+		transforms_.Reset();
+		OnTransformChanged();
 	}
 	void Grafix::SetInterpolationMode(InterpolationMode newMode)  
 	{
@@ -335,23 +761,506 @@ namespace ArEngine2D {
 			throw EngineError{"Invalid InterpolationMode passed to Grafix::SetInterpolationMode"};
 		}
 	}
+	void Grafix::SetFont(std::wstring_view family, FontWeight weight)
+	{
+		fontFamily_ = textFormats_.RegisterFamily(family);
+		fontWeight_ = weight;
+	}
+	void Grafix::SetDeferred(bool bDeferred) noexcept
+	{
+		bDeferred_ = bDeferred;
+	}
+	bool Grafix::IsDeferred() const noexcept
+	{
+		return bDeferred_;
+	}
+	bool Grafix::IsHeadless() const noexcept
+	{
+		return bHeadless_;
+	}
+	PixelBuffer const& Grafix::FrameBuffer() const noexcept
+	{
+		return frameBuffer_;
+	}
+	void Grafix::CaptureNextFrame() noexcept
+	{
+		bCaptureRequested_ = true;
+	}
+	PixelBuffer const& Grafix::CapturedFrame() const noexcept
+	{
+		return capturedFrame_;
+	}
+	void Grafix::SaveCapturedFrame(std::filesystem::path const& path) const
+	{
+		if (capturedFrame_.IsEmpty())
+		{
+			throw EngineError{"Grafix::SaveCapturedFrame called before any frame was captured"};
+		}
+		if (not ImageFile::Save(capturedFrame_, path))
+		{
+			throw EngineError{"Failed to save the captured frame to " + path.string()};
+		}
+	}
+	void Grafix::SetRetained(bool bRetained) noexcept
+	{
+		bRetainedNext_ = bRetained;
+	}
+	bool Grafix::IsRetained() const noexcept
+	{
+		return bRetained_;
+	}
+	void Grafix::AddDamage(D2D1_RECT_F const& screenRect)
+	{
+		damage_.Add(ToRaw(screenRect));
+	}
+	void Grafix::InvalidateScreen()
+	{
+		damage_.AddAll();
+	}
+	void Grafix::SetCulling(bool bCulling) noexcept
+	{
+		bCulling_ = bCulling;
+	}
+	bool Grafix::IsCulling() const noexcept
+	{
+		return bCulling_;
+	}
+	D2D1_RECT_F Grafix::VisibleRect() const noexcept
+	{
+		return std::bit_cast<D2D1_RECT_F>(visibleRect_);
+	}
+	void Grafix::SetLayer(std::int16_t layer) noexcept
+	{
+		commands_.SetLayer(layer);
+	}
+	void Grafix::DefineLayer(std::string_view name, std::int16_t order, Transform const& transform)
+	{
+		if (auto* const pLayer{FindLayer(name)})
+		{
+			pLayer->order = order;
+			pLayer->transform = transform;
+			return;
+		}
+		layers_.push_back({std::string{name}, order, transform});
+	}
+	void Grafix::SetLayerTransform(std::string_view name, Transform const& transform)
+	{
+		auto* const pLayer{FindLayer(name)};
+		if (not pLayer)
+		{
+			throw EngineError{"Tried to change the transform of undefined layer " + std::string{name}};
+		}
+		pLayer->transform = transform;
+	}
+	void Grafix::UseLayer(std::string_view name, std::int16_t z)
+	{
+		auto const* const pLayer{FindLayer(name)};
+		if (not pLayer)
+		{
+			throw EngineError{"Tried to use undefined layer " + std::string{name}};
+		}
+		commands_.SetLayer(pLayer->order);
+		commands_.SetDepth(z);
+		ResetTransform();
+		PushTransform(pLayer->transform);
+	}
+	Grafix::Layer* Grafix::FindLayer(std::string_view name) noexcept
+	{
+		auto const it{std::ranges::find(layers_, name, &Layer::name)};
+		return it == layers_.end() ? nullptr : &*it;
+	}
+	CachedGeometry Grafix::CacheGeometry(std::span<Vec2 const> vertices)
+	{
+		assert(vertices.size() >= 3U && "CachedGeometry needs at least three vertices");
+		return FindOrBuildGeometry(vertices);
+	}
+	Grafix::FrameStats const& Grafix::LastFrameStats() const noexcept
+	{
+		return lastFrameStats_;
+	}
+	std::size_t Grafix::LayoutKeyHash::operator()(LayoutKey const& key) const noexcept
+	{
+		auto hash{Details::Hash::Value(key.size, key.textHash)};
+		hash = Details::Hash::Value(key.family, hash);
+		return static_cast<std::size_t>(Details::Hash::Value(key.weight, hash));
+	}
+	TextLayout const& Grafix::CachedLayout(std::string_view str, float size, TextFormatCache::FamilyID family, FontWeight weight)
+	{
+		LayoutKey const key{Details::Hash::String(str), size, family, weight};
+		auto& layout{layouts_.FindOrCreate(key, [&] {
+			TextLayout newLayout{str, size};
+			newLayout.SetFont(textFormats_.FamilyName(family), weight);
+			return newLayout;
+		})};
+		// two different strings with the same hash; just reshape the old one.
+		layout.SetText(str);
+		return layout;
+	}
+	CachedGeometry const& Grafix::FindOrBuildGeometry(std::span<Vec2 const> vertices)
+	{
+		auto const hash{Details::Hash::Bytes(vertices.data(), vertices.size_bytes())};
+		if (auto const pCached{geometries_.Find(hash)};
+			pCached and pCached->Matches(vertices))
+		{
+			return *pCached;
+		}
+
+		// filled figures can still be stroked, so the same geometry serves both Draw and Fill.
+		Details::Ptr<ID2D1PathGeometry> pGeometry{};
+		Details::Ptr<ID2D1GeometrySink> pSink{};
+		HANDLE_GRAPHICS_ERROR(pFactory_->CreatePathGeometry(&pGeometry));
+		HANDLE_GRAPHICS_ERROR(pGeometry->Open(&pSink));
+		pSink->BeginFigure(vertices[0].ToD2DPoint(), D2D1_FIGURE_BEGIN_FILLED);
+		for (std::size_t i{1}, lim{vertices.size()}; i < lim; ++i)
+		{
+			pSink->AddLine(vertices[i].ToD2DPoint());
+		}
+		pSink->EndFigure(D2D1_FIGURE_END_CLOSED);
+		HANDLE_GRAPHICS_ERROR(pSink->Close());
+
+		return geometries_.Insert(hash, CachedGeometry{std::move(pGeometry), vertices});
+	}
+	bool Grafix::Culled(RawRect const& bounds) noexcept
+	{
+		if (bCulling_ and not bounds.Intersects(visibleRect_))
+		{
+			++culledDraws_;
+			return true;
+		}
+		++drawnDraws_;
+		return false;
+	}
+	bool Grafix::Culled(RawRect const& bounds, Transform const& whatToAppend) noexcept
+	{
+		return Culled(bCulling_ ? ToRaw(whatToAppend).ApplyToRect(bounds) : bounds);
+	}
+	void Grafix::OnTransformChanged() noexcept
+	{
+		auto const& matrix{transforms_.Top()};
+		pushedTransform_.Set(std::bit_cast<D2D1::Matrix3x2F>(matrix));
+		if (not matrix.IsInvertible())
+		{
+			// everything collapses into a line or a point; not worth culling.
+			constexpr auto Inf{std::numeric_limits<float>::infinity()};
+			visibleRect_ = {-Inf, -Inf, Inf, Inf};
+			return;
+		}
+		visibleRect_ = matrix.Inverted().ApplyToRect({0.f, 0.f, width_, height_});
+	}
+	bool Grafix::IsRecording() const noexcept
+	{
+		return bDeferred_ or bHeadless_ or bRetained_;
+	}
+	std::uint64_t Grafix::FrameImage(Sprite const& sprite, std::size_t level)
+	{
+		if (bHeadless_)
+		{
+			auto const pPixels{sprite.MipPixels(level)};
+			assert(pPixels && "Sprite has no cpu pixels; was it loaded before Grafix was initialized?");
+			frameImages_.push_back(pPixels.get());
+			frameImageOwners_.push_back(pPixels);
+			frameImageKeys_.push_back(std::bit_cast<std::uintptr_t>(pPixels.get()));
+			return frameImages_.size() - 1U;
+		}
+		frameBitmaps_.push_back(sprite.D2DPtr(level));
+		frameImageKeys_.push_back(std::bit_cast<std::uintptr_t>(frameBitmaps_.back().Get()));
+		return frameBitmaps_.size() - 1U;
+	}
+	std::size_t Grafix::MipLevelFor(Sprite const& sprite, Transform const& whatToAppend) const noexcept
+	{
+		if (sprite.MipLevelCount() == 0U)
+		{
+			return 0U;
+		}
+		auto const scale{(ToRaw(whatToAppend) * transforms_.Top()).AverageScale()};
+		return MipChain::SelectLevel(scale, sprite.MipLevelCount());
+	}
+	DrawCommandBuffer& Grafix::Record(Transform const& fullTransform)
+	{
+		commands_.SetTransform(ToRaw(fullTransform));
+		return commands_;
+	}
+	DrawCommandBuffer& Grafix::Record(ColorF const& color)
+	{
+		commands_.SetColor(ToRaw(color));
+		return Record(pushedTransform_);
+	}
+	DrawCommandBuffer& Grafix::Record(ColorF const& color, Transform const& whatToAppend)
+	{
+		commands_.SetColor(ToRaw(color));
+		return Record(whatToAppend >> pushedTransform_);
+	}
+	void Grafix::DrawSpriteBatchGroup(SpriteBatch::Group const& group)
+	{
+		auto const pBitmap{batchBitmaps_[group.image].Get()};
+		auto const interpolation{static_cast<D2D1_BITMAP_INTERPOLATION_MODE>(group.interpolation)};
+		auto const entries{spriteBatch_.Entries().subspan(group.first, group.count)};
+
+		if (not pD2DSpriteBatch_)
+		{
+			for (auto const& entry : entries)
+			{
+				ApplyTransform(std::bit_cast<D2D1_MATRIX_3X2_F>(entry.transform));
+				pRenderTarget_->DrawBitmap(pBitmap, {0.f, 0.f, entry.src.Width(), entry.src.Height()},
+					entry.opacity, interpolation, std::bit_cast<D2D1_RECT_F>(entry.src)
+				);
+				++spriteBatchDraws_;
+			}
+			return;
+		}
+
+		batchDestRects_.clear();
+		batchSrcRects_.clear();
+		batchColors_.clear();
+		batchTransforms_.clear();
+		for (auto const& entry : entries)
+		{
+			auto const& src{entry.src};
+			batchDestRects_.push_back({0.f, 0.f, src.Width(), src.Height()});
+			batchSrcRects_.push_back({
+				static_cast<UINT32>(src.left + 0.5f), static_cast<UINT32>(src.top + 0.5f),
+				static_cast<UINT32>(src.right + 0.5f), static_cast<UINT32>(src.bottom + 0.5f)
+			});
+			batchColors_.push_back({1.f, 1.f, 1.f, entry.opacity});
+			batchTransforms_.push_back(std::bit_cast<D2D1_MATRIX_3X2_F>(entry.transform));
+		}
+
+		pD2DSpriteBatch_->Clear();
+		HANDLE_GRAPHICS_ERROR(pD2DSpriteBatch_->AddSprites(group.count,
+			batchDestRects_.data(), batchSrcRects_.data(), batchColors_.data(), batchTransforms_.data()
+		));
+
+		// sprite transforms are relative to the render target one, and sprite batches
+		// only work with aliased rendering.
+		ApplyTransform(D2D1::IdentityMatrix());
+		auto const oldMode{pContext3_->GetAntialiasMode()};
+		pContext3_->SetAntialiasMode(D2D1_ANTIALIAS_MODE_ALIASED);
+		pContext3_->DrawSpriteBatch(pD2DSpriteBatch_.Get(), pBitmap, interpolation, D2D1_SPRITE_OPTIONS_NONE);
+		pContext3_->SetAntialiasMode(oldMode);
+		++spriteBatchDraws_;
+	}
+	void Grafix::EndRetainedFrame()
+	{
+		if (bRetainedValid_)
+		{
+			damage_.AddChanges(previousCommands_, previousImageKeys_, commands_, frameImageKeys_);
+		}
+		else
+		{
+			// nothing to compare against yet.
+			damage_.AddAll();
+			bRetainedValid_ = true;
+		}
+
+		auto& stats{lastFrameStats_};
+		stats.deferredCommands = commands_.Size();
+		stats.renderedPixels   = damage_.Area();
+		stats.damageRects      = damage_.Rects().size();
+		stats.presents         = damage_.IsEmpty() ? 0U : 1U;
+
+		if (bHeadless_)
+		{
+			// the frame buffer still holds the last frame, so only the damage is drawn over it.
+			rasterizer_.ResetStats();
+			for (auto const& rect : damage_.Rects())
+			{
+				rasterizer_.RenderClipped(commands_, frameBuffer_, frameImages_, rect);
+			}
+			stats.rasterizedPixels = rasterizer_.GetStats().pixels;
+			if (bCaptureRequested_)
+			{
+				capturedFrame_ = frameBuffer_;
+			}
+		}
+		else if (not damage_.IsEmpty() or bCaptureRequested_)
+		{
+			pRenderTarget_->BeginDraw();
+			for (auto const& rect : damage_.Rects())
+			{
+				// the clip goes through the current transform, so it's pushed with the identity.
+				ApplyTransform(D2D1::Matrix3x2F::Identity());
+				pRenderTarget_->PushAxisAlignedClip(std::bit_cast<D2D1_RECT_F>(rect), D2D1_ANTIALIAS_MODE_ALIASED);
+				SubmitDeferred();
+				pRenderTarget_->PopAxisAlignedClip();
+			}
+			if (bCaptureRequested_)
+			{
+				CaptureRenderTarget();
+			}
+			HANDLE_ENDDRAW_ERROR(pRenderTarget_.Get());
+			stats.presents = 1U;
+		}
+
+		// this frame is what the next one gets compared against.
+		damage_.Clear();
+		std::swap(previousCommands_, commands_);
+		std::swap(previousImageKeys_, frameImageKeys_);
+		std::swap(previousBitmaps_, frameBitmaps_);
+		std::swap(previousImageOwners_, frameImageOwners_);
+	}
+	void Grafix::CaptureRenderTarget()
+	{
+		if (not pContext3_)
+		{
+			throw GraphicsError{"Capturing a window frame needs ID2D1DeviceContext (windows 8 or later)"};
+		}
+
+		// the copy must have the same format as the render target, and only cpu readable
+		// bitmaps can be mapped.
+		auto const size{pRenderTarget_->GetPixelSize()};
+		auto const properties{D2D1::BitmapProperties1(
+			D2D1_BITMAP_OPTIONS_CPU_READ | D2D1_BITMAP_OPTIONS_CANNOT_DRAW, pRenderTarget_->GetPixelFormat()
+		)};
+		Details::Ptr<ID2D1Bitmap1> pCopy{};
+		HANDLE_GRAPHICS_ERROR(pContext3_->CreateBitmap(size, nullptr, 0U, properties, pCopy.GetAddressOf()));
+		D2D1_POINT_2U const origin{};
+		HANDLE_GRAPHICS_ERROR(pCopy->CopyFromRenderTarget(&origin, pRenderTarget_.Get(), nullptr));
+
+		D2D1_MAPPED_RECT mapped{};
+		HANDLE_GRAPHICS_ERROR(pCopy->Map(D2D1_MAP_OPTIONS_READ, &mapped));
+		capturedFrame_.Resize(size.width, size.height);
+		for (std::uint32_t y{}; y < size.height; ++y)
+		{
+			auto const row{capturedFrame_.Row(y)};
+			std::memcpy(row.data(), mapped.bits + static_cast<std::size_t>(y) * mapped.pitch, row.size_bytes());
+			// window targets ignore alpha, so it may hold anything.
+			for (auto& pixel : row)
+			{
+				pixel |= 0xFF'00'00'00U;
+			}
+		}
+		HANDLE_GRAPHICS_ERROR(pCopy->Unmap());
+	}
+	void Grafix::SubmitDeferred()
+	{
+		constexpr auto None{std::numeric_limits<std::uint32_t>::max()};
+		auto lastTransform{None};
+		auto lastColor{None};
+		auto& stats{lastFrameStats_};
+		stats.deferredCommands = commands_.Size();
+
+		for (auto const& cmd : commands_.Commands())
+		{
+			if (cmd.kind == DrawCommandKind::Clear)
+			{
+				pRenderTarget_->Clear(std::bit_cast<D2D1_COLOR_F>(commands_.ColorOf(cmd)));
+				continue;
+			}
+
+			if (cmd.transform != lastTransform)
+			{
+				ApplyTransform(std::bit_cast<D2D1_MATRIX_3X2_F>(commands_.TransformOf(cmd)));
+				lastTransform = cmd.transform;
+			}
+			// sprites do not use the brush.
+			if (cmd.kind != DrawCommandKind::Sprite and cmd.color != lastColor)
+			{
+				pSolidBrush_->SetColor(std::bit_cast<D2D1_COLOR_F>(commands_.ColorOf(cmd)));
+				lastColor = cmd.color;
+				++stats.colorChanges;
+			}
+
+			auto const thick{cmd.data[4]};
+			switch (cmd.kind)
+			{
+			case DrawCommandKind::Line:
+				pRenderTarget_->DrawLine(std::bit_cast<D2D1_POINT_2F>(cmd.Point(0)), 
+					std::bit_cast<D2D1_POINT_2F>(cmd.Point(1)), pSolidBrush_.Get(), thick
+				);
+				break;
+			case DrawCommandKind::DrawEllipse:
+				pRenderTarget_->DrawEllipse(D2D1::Ellipse(std::bit_cast<D2D1_POINT_2F>(cmd.Point(0)), cmd.data[2], cmd.data[3]),
+					pSolidBrush_.Get(), thick
+				);
+				break;
+			case DrawCommandKind::FillEllipse:
+				pRenderTarget_->FillEllipse(D2D1::Ellipse(std::bit_cast<D2D1_POINT_2F>(cmd.Point(0)), cmd.data[2], cmd.data[3]),
+					pSolidBrush_.Get()
+				);
+				break;
+			case DrawCommandKind::DrawRectangle:
+				pRenderTarget_->DrawRectangle(std::bit_cast<D2D1_RECT_F>(cmd.RectAt(0)), pSolidBrush_.Get(), thick);
+				break;
+			case DrawCommandKind::FillRectangle:
+				pRenderTarget_->FillRectangle(std::bit_cast<D2D1_RECT_F>(cmd.RectAt(0)), pSolidBrush_.Get());
+				break;
+			case DrawCommandKind::DrawPolygon:
+			case DrawCommandKind::FillPolygon:
+			{
+				auto const verts{commands_.VerticesOf(cmd)};
+				scratchVertices_.assign(verts.size(), {});
+				std::ranges::transform(verts, scratchVertices_.begin(), [](RawPoint const& vert) { return Vec2{vert.x, vert.y}; });
+				// the geometry was cached when the command was recorded, so this is a lookup.
+				auto const& pGeometry{FindOrBuildGeometry(scratchVertices_).D2DPtr()};
+				if (cmd.kind == DrawCommandKind::DrawPolygon)
+				{
+					pRenderTarget_->DrawGeometry(pGeometry.Get(), pSolidBrush_.Get(), thick);
+				}
+				else
+				{
+					pRenderTarget_->FillGeometry(pGeometry.Get(), pSolidBrush_.Get());
+				}
+				break;
+			}
+			case DrawCommandKind::Sprite:
+				pRenderTarget_->DrawBitmap(frameBitmaps_[cmd.resource].Get(), std::bit_cast<D2D1_RECT_F>(cmd.RectAt(0)), 
+					cmd.data[8], static_cast<D2D1_BITMAP_INTERPOLATION_MODE>(cmd.flags), 
+					std::bit_cast<D2D1_RECT_F>(cmd.RectAt(1))
+				);
+				break;
+			case DrawCommandKind::Text:
+			{
+				auto const text{commands_.TextOf(cmd)};
+				auto const rect{std::bit_cast<D2D1_RECT_F>(cmd.RectAt(0))};
+				auto const family{static_cast<TextFormatCache::FamilyID>(cmd.data[5])};
+				auto const weight{static_cast<FontWeight>(cmd.flags)};
+				if (std::isinf(rect.right))
+				{
+					auto const& layout{CachedLayout(text, cmd.data[4], family, weight)};
+					pRenderTarget_->DrawTextLayout({rect.left, rect.top}, layout.D2DPtr().Get(), pSolidBrush_.Get(),
+						D2D1_DRAW_TEXT_OPTIONS_NONE
+					);
+				}
+				else
+				{
+					auto const pFormat{textFormats_.Get(family, cmd.data[4] * (1.f / 0.55f), weight)};
+					auto const wstr{textFormats_.Widen(text)};
+					pRenderTarget_->DrawTextW(wstr.data(), static_cast<UINT32>(std::size(wstr)),
+						pFormat, rect, pSolidBrush_.Get(),
+						D2D1_DRAW_TEXT_OPTIONS_CLIP,
+						DWRITE_MEASURING_MODE_NATURAL
+					);
+				}
+				break;
+			}
+			default:
+				assert(false && "Unhandled DrawCommandKind");
+			}
+		}
+	}
 	void Grafix::BeginTransform() noexcept
 	{
-		pRenderTarget_->SetTransform(pushedTransform_.Matrix());
+		ApplyTransform(pushedTransform_.Matrix());
 	}
 	void Grafix::BeginTransform(Transform const& whatToAppend) noexcept
 	{
-		pRenderTarget_->SetTransform((whatToAppend >> pushedTransform_).Matrix());
+		ApplyTransform((whatToAppend >> pushedTransform_).Matrix());
 	}
-	void Grafix::EndTransform() noexcept
+	void Grafix::ApplyTransform(D2D1_MATRIX_3X2_F const& matrix) noexcept
 	{
-		// this assumes that some drawing rootines do not use BeginTransform,
-		// even tho that's not the case at the moment but, I don't want to lose
-		// my mind when I add something later, and forget this function even exists.
-		pRenderTarget_->SetTransform(D2D1::IdentityMatrix());
+		auto const rawMatrix{std::bit_cast<RawMatrix>(matrix)};
+		if (bAppliedMatrixKnown_ and rawMatrix == appliedMatrix_)
+		{
+			return;
+		}
+		pRenderTarget_->SetTransform(matrix);
+		appliedMatrix_        = rawMatrix;
+		bAppliedMatrixKnown_  = true;
+		++transformChanges_;
 	}
 	bool Grafix::IsInitialized() const noexcept
 	{
-		return pRenderTarget_;
+		// both the window and the headless backends create the factory.
+		return pFactory_;
 	}
 }
@@ -8,16 +8,82 @@
 #include "IEngineError.h"
 #include "Sprite.h"
 #include "Transform.h"
+#include "TextFormatCache.h"
+#include "TextLayout.h"
+#include "LruCache.h"
+#include "CachedGeometry.h"
+#include "DrawCommandBuffer.h"
+#include "SpriteBatch.h"
+#include "SoftwareRasterizer.h"
+#include "ImageFile.h"
+#include "DamageRegion.h"
+#include "TransformStack.h"
+#include "Testing/ArTest20.h"
 
+#include <d2d1_3.h>
 #include <dwrite.h>
 #include <wincodec.h>
 
+#include <array>
+#include <filesystem>
+#include <span>
+
 namespace ArEngine2D {
 	class Grafix : Details::ISingle
 	{ 
 	private:
 		using self = Grafix;
 
+	public:
+
+		// always defined, with order 0 and no transform.
+		constexpr static std::string_view sc_DefaultLayer{"default"};
+
+	public:
+
+		/**
+		 * @brief counters collected while drawing a single frame.
+		*/
+		struct FrameStats
+		{
+			// text
+			std::uint64_t textFormatHits;
+			std::uint64_t textFormatMisses;
+			std::uint64_t textAllocations;
+			std::uint64_t textLayoutBuilds;
+
+			// geometry
+			std::uint64_t geometryHits;
+			std::uint64_t geometryMisses;
+
+			// render target SetTransform calls that were not skipped.
+			std::uint64_t transformChanges;
+
+			// deferred mode (all zero when drawing immediately)
+			std::uint64_t deferredCommands;
+			std::uint64_t colorChanges;
+
+			// headless mode
+			std::uint64_t rasterizedPixels;
+
+			// pixels drawn again this frame (the whole screen unless retained), and whether it was presented.
+			std::uint64_t renderedPixels;
+			std::uint64_t damageRects;
+			std::uint64_t presents;
+
+			// culling; drawn counts the draw calls that passed it (or all of them when it's off).
+			std::uint64_t culledDraws;
+			std::uint64_t drawnDraws;
+
+			// sprite batches
+			std::uint64_t batchedSprites;
+			std::uint64_t spriteBatchDraws;
+
+			// instanced draws (FillCircles and friends); shapes counts what they submitted after culling.
+			std::uint64_t instancedDraws;
+			std::uint64_t instancedShapes;
+		};
+
 	public:
 
 		Grafix() = default;
@@ -26,24 +92,29 @@ namespace ArEngine2D {
 
 		// users may not call this.
 		void Initialize(HWND windowHandle);
+		// users may not call this either; draws into FrameBuffer instead of a window. still creates the
+		// Direct2D, DirectWrite and WIC factories (cpu only) for geometries, text layouts and sprites.
+		// frames are rasterized tile by tile on jobs (the engine's), which must outlive this.
+		void InitializeHeadless(std::uint32_t width, std::uint32_t height, JobSystem& jobs);
 		void BeginDraw();
 		void EndDraw();
 
-		void ClearScreen(ColorF const& color = {}) noexcept;
+		// not noexcept; deferred, headless and retained frames record the draws, which allocates.
+		void ClearScreen(ColorF const& color = {});
 
-		void DrawLine(Vec2 const& from, Vec2 const& to, ColorF const& color, float thick = 1.f) noexcept;
+		void DrawLine(Vec2 const& from, Vec2 const& to, ColorF const& color, float thick = 1.f);
 
-		void DrawEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color, float thick = 1.f) noexcept;
-		void FillEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color) noexcept;
-		void DrawCircle(Vec2 const& loc, float r, ColorF const& color, float thick = 1.f) noexcept;
-		void FillCircle(Vec2 const& loc, float r, ColorF const& color) noexcept;
+		void DrawEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color, float thick = 1.f);
+		void FillEllipse(Vec2 const& loc, float rx, float ry, ColorF const& color);
+		void DrawCircle(Vec2 const& loc, float r, ColorF const& color, float thick = 1.f);
+		void FillCircle(Vec2 const& loc, float r, ColorF const& color);
 
-		void DrawRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color, float thick = 1.f) noexcept;
-		void FillRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color) noexcept;
-		void DrawRectangle(Vec2 const& loc, float w, float h, ColorF const& color, float thick = 1.f) noexcept;
-		void FillRectangle(Vec2 const& loc, float w, float h, ColorF const& color) noexcept;
-		void DrawRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color, float thick = 1.f) noexcept;
-		void FillRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color) noexcept;
+		void DrawRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color, float thick = 1.f);
+		void FillRectangle(Vec2 const& topLeft, Vec2 const& botRight, ColorF const& color);
+		void DrawRectangle(Vec2 const& loc, float w, float h, ColorF const& color, float thick = 1.f);
+		void FillRectangle(Vec2 const& loc, float w, float h, ColorF const& color);
+		void DrawRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color, float thick = 1.f);
+		void FillRectangleCenter(Vec2 const& loc, float w, float h, ColorF const& color);
 
 		void DrawTriangle(Vec2 const& loc, Vec2 const& p0, Vec2 const& p1, Vec2 const& p2, ColorF const& color, float thick = 1.f);
 		void FillTriangle(Vec2 const& loc, Vec2 const& p0, Vec2 const& p1, Vec2 const& p2, ColorF const& color);
@@ -51,12 +122,31 @@ namespace ArEngine2D {
 		void DrawPolygon(Vec2 const& loc, std::vector<Vec2> const& vertices, ColorF const& color, float thick = 1.f);
 		void FillPolygon(Vec2 const& loc, std::vector<Vec2> const& vertices, ColorF const& color);
 
+		void DrawGeometry(Vec2 const& loc, CachedGeometry const& geometry, ColorF const& color, float thick = 1.f);
+		void FillGeometry(Vec2 const& loc, CachedGeometry const& geometry, ColorF const& color);
+
 		void DrawArrow(Vec2 const& from, Vec2 const& to, ColorF const& color, float thick = 1.f);
+		/**
+		 * @return the far ends of the two short lines DrawArrow draws from to (south east, then south west).
+		*/
+		static std::array<Vec2, 2U> ArrowHead(Vec2 const& from, Vec2 const& to) noexcept;
+
+		/**
+		 * @brief draws many shapes at once; the spans hold one value per shape (structure of arrays), or
+		 *		  a single value shared by all of them. the whole span is culled and submitted in one pass
+		 *		  under the current transform, and the brush only changes when the color does.
+		*/
+		void FillCircles(std::span<Vec2 const> centers, std::span<float const> radii, std::span<ColorF const> colors);
+		void DrawCircles(std::span<Vec2 const> centers, std::span<float const> radii, std::span<ColorF const> colors, float thick = 1.f);
+		void DrawLines(std::span<Vec2 const> froms, std::span<Vec2 const> tos, std::span<ColorF const> colors, float thick = 1.f);
+		void FillRects(std::span<Vec2 const> topLefts, std::span<Vec2 const> sizes, std::span<ColorF const> colors);
 
-		void DrawString(Vec2 const& loc, std::string str, ColorF const& color, float size);
-		void DrawStringCenter(Vec2 const& loc, std::string str, ColorF const& color, float size);
-		void DrawStringRect(std::string str, ColorF const& color, float size, D2D1_RECT_F rect);
-		void DrawStringRectCenter(std::string str, ColorF const& color, float size, D2D1_RECT_F rect);
+		void DrawString(Vec2 const& loc, std::string_view str, ColorF const& color, float size);
+		void DrawStringCenter(Vec2 const& loc, std::string_view str, ColorF const& color, float size);
+		void DrawStringRect(std::string_view str, ColorF const& color, float size, D2D1_RECT_F rect);
+		void DrawStringRectCenter(std::string_view str, ColorF const& color, float size, D2D1_RECT_F rect);
+		void DrawTextLayout(Vec2 const& loc, TextLayout const& layout, ColorF const& color);
+		void DrawTextLayoutCenter(Vec2 const& loc, TextLayout const& layout, ColorF const& color);
 
 		void DrawSprite(Vec2 const& loc, Sprite const& sprite, float opacity = 1.f, Transform const& tr = {});
 		void DrawSpriteCenter(Vec2 const& loc, Sprite const& sprite, float opacity = 1.f, Transform const& tr = {});
@@ -67,38 +157,224 @@ namespace ArEngine2D {
 		void DrawAnimationSpriteSheet(Vec2 const& loc, AnimationSpriteSheet const& sheet, float opacity = 1.f, Transform const& tr = {});
 		void DrawAnimationSpriteSheetCenter(Vec2 const& loc, AnimationSpriteSheet const& sheet, float opacity = 1.f, Transform const& tr = {});
 
+	public:
+
+		/**
+		 * @brief starts collecting sprites; nothing is drawn until EndSpriteBatch.
+		 *		  sprites of the same bitmap and interpolation mode are drawn with a single call
+		 *		  when the device supports sprite batches (windows 10 and later).
+		*/
+		void BeginSpriteBatch();
+
+		/**
+		 * @brief the rect of the sprite is drawn at {0, 0} (in the space of dest), so dest
+		 *		  works like the loc and the transform of DrawSpriteRect combined.
+		 *		  uses the current pushed transform and interpolation mode.
+		*/
+		void BatchSprite(Sprite const& sprite, D2D1_RECT_F rect, Transform const& dest, float opacity = 1.f);
+		void BatchSprite(Sprite const& sprite, Transform const& dest, float opacity = 1.f);
+
+		/**
+		 * @brief draws every sprite since BeginSpriteBatch, grouped by bitmap; overlapping
+		 *		  sprites of different bitmaps may not keep the order they were added in.
+		*/
+		void EndSpriteBatch();
+
 	public:
 
 		void PushTransform(Transform const& newTransform);
 		void PopTransform();
-		void AppendTransform(Transform const& what) noexcept;
+		void AppendTransform(Transform const& what);
 		void UndoTransform() noexcept;
 		Transform const& GetFullTransform() const noexcept;
 		void ResetTransform() noexcept;
 		void SetInterpolationMode(InterpolationMode newMode);
+		void SetFont(std::wstring_view family, FontWeight weight = FontWeight::Normal);
+
+		/**
+		 * @brief when deferred, draw calls are only recorded, then sorted and submitted by EndDraw
+		 *		  with redundant brush and transform changes removed.
+		 *		  draw order is only kept between layers and depths (see SetLayer and UseLayer), and
+		 *		  across ClearScreen calls.
+		 *		  should not be changed between BeginDraw and EndDraw.
+		*/
+		void SetDeferred(bool bDeferred) noexcept;
+		bool IsDeferred() const noexcept;
+
+		/**
+		 * @brief in deferred mode, everything drawn after this call goes into this layer, and
+		 *		  lower layers are drawn first; every frame starts at layer 0. ignored when drawing immediately.
+		*/
+		void SetLayer(std::int16_t layer) noexcept;
+
+		/**
+		 * @brief registers a named layer, or updates the one with the same name. in deferred mode,
+		 *		  layers are drawn by ascending order; in any mode, what is drawn into a layer goes
+		 *		  through its transform (the camera for the world, nothing for the ui, ...).
+		*/
+		void DefineLayer(std::string_view name, std::int16_t order, Transform const& transform = {});
+		void SetLayerTransform(std::string_view name, Transform const& transform);
+
+		/**
+		 * @brief everything drawn after this call goes into the layer at depth z (higher is drawn later,
+		 *		  in deferred mode), and the transform stack restarts from the transform of the layer.
+		 *		  throws EngineError if the layer was never defined.
+		*/
+		void UseLayer(std::string_view name, std::int16_t z = 0);
+
+		/**
+		 * @return true if drawing goes to the software rasterizer instead of a window.
+		 *		   headless frames are always recorded, then rasterized by EndDraw; text is not drawn.
+		*/
+		bool IsHeadless() const noexcept;
+
+		/**
+		 * @return the pixels of the last frame drawn headless (empty otherwise).
+		*/
+		PixelBuffer const& FrameBuffer() const noexcept;
+
+		/**
+		 * @brief the next EndDraw copies the finished frame into CapturedFrame, before presenting it.
+		 *		  windowed captures need a device context (windows 8 and later).
+		*/
+		void CaptureNextFrame() noexcept;
+
+		/**
+		 * @return the last captured frame, premultiplied; windowed captures are always opaque.
+		*/
+		PixelBuffer const& CapturedFrame() const noexcept;
+
+		/**
+		 * @brief writes CapturedFrame to a .png or a .ppm file (see ImageFile).
+		*/
+		void SaveCapturedFrame(std::filesystem::path const& path) const;
+
+		/**
+		 * @brief when on (the default), draw calls whose bounds are outside of VisibleRect
+		 *		  return before touching the brush or the transform.
+		*/
+		void SetCulling(bool bCulling) noexcept;
+
+		/**
+		 * @brief in retained mode, every frame is recorded and compared with the last one, and only
+		 *		  the parts that changed (plus AddDamage) are drawn again; a frame without any changes
+		 *		  is not drawn nor presented at all. takes effect at the next BeginDraw.
+		*/
+		void SetRetained(bool bRetained) noexcept;
+		bool IsRetained() const noexcept;
+
+		/**
+		 * @brief marks part of the screen (in pixels) to be drawn again by the next retained frame,
+		 *		  for changes the draw calls can not show (a sprite's pixels were edited, for example).
+		*/
+		void AddDamage(D2D1_RECT_F const& screenRect);
+		void InvalidateScreen();
+		bool IsCulling() const noexcept;
+
+		/**
+		 * @return the part of the world the screen shows under the pushed transform, as an
+		 *		   axis aligned rect (so it's a bit bigger than the screen when rotated).
+		*/
+		D2D1_RECT_F VisibleRect() const noexcept;
+
+		/**
+		 * @brief builds a closed polygon out of the vertices, or reuses the one built by an earlier
+		 *		  call with the same vertices. the returned handle stays valid even after eviction.
+		 * @param vertices => at least three vertices, relative to the loc passed when drawing.
+		*/
+		CachedGeometry CacheGeometry(std::span<Vec2 const> vertices);
+
+		/**
+		 * @return the counters of the last frame that was fully drawn.
+		*/
+		FrameStats const& LastFrameStats() const noexcept;
 
 	private:
 
-		template <std::invocable<ID2D1GeometrySink*> Callable>
-		auto GenerateGeometry(Vec2 const& beginPoint, D2D1_FIGURE_BEGIN beginFlag, D2D1_FIGURE_END endFlag, Callable&& callable)
+		struct LayoutKey
+		{
+			std::uint64_t textHash;
+			float size;
+			TextFormatCache::FamilyID family;
+			FontWeight weight;
+
+			bool operator==(LayoutKey const& rhs) const noexcept = default;
+		};
+
+		struct LayoutKeyHash
 		{
-			Details::Ptr<ID2D1PathGeometry> pGeometry{};
-			Details::Ptr<ID2D1GeometrySink> pSink{};
-			HANDLE_GRAPHICS_ERROR(pFactory_->CreatePathGeometry(&pGeometry));
-			HANDLE_GRAPHICS_ERROR(pGeometry->Open(&pSink));
-			pSink->BeginFigure(beginPoint.ToD2DPoint(), beginFlag);
-			callable(pSink.Get());
-			pSink->EndFigure(endFlag);
-			HANDLE_GRAPHICS_ERROR(pSink->Close());
-			return pGeometry;
-		}
-
-		// called before every render target draw call. 
+			std::size_t operator()(LayoutKey const& key) const noexcept;
+		};
+
+		struct Layer
+		{
+			std::string name;
+			std::int16_t order;
+			Transform transform;
+		};
+
+	private:
+
+		// the loop behind the instanced draws; record and draw are called for every shape that is not culled.
+		template <class TBounds, class TRecord, class TDraw>
+		void DrawInstances(std::size_t count, std::span<ColorF const> colors, TBounds const& boundsOf,
+			TRecord const& record, TDraw const& draw
+		);
+
+		// null if there is no layer with that name.
+		Layer* FindLayer(std::string_view name) noexcept;
+
+		// returns a layout shaped by an earlier call with the same string, size and font if possible.
+		TextLayout const& CachedLayout(std::string_view str, float size, TextFormatCache::FamilyID family, FontWeight weight);
+
+		// looks the vertices up in geometries_, and only builds a new geometry on a miss.
+		CachedGeometry const& FindOrBuildGeometry(std::span<Vec2 const> vertices);
+
+		// the shared part of Initialize and InitializeHeadless.
+		void InitializeCommon();
+
+		// true if draw calls go into commands_ instead of the render target.
+		bool IsRecording() const noexcept;
+
+		// keeps the sprite's image (at a mip level) alive until the end of the frame, and returns
+		// the handle a sprite command uses for it (a bitmap, or its cpu pixels when headless).
+		std::uint64_t FrameImage(Sprite const& sprite, std::size_t level = 0U);
+
+		// the mip level a sprite is drawn from when moved by whatToAppend, then the pushed transform.
+		std::size_t MipLevelFor(Sprite const& sprite, Transform const& whatToAppend) const noexcept;
+
+		// true (and counted as culled) if bounds, in the space of the pushed transform, are off screen.
+		bool Culled(RawRect const& bounds) noexcept;
+		// same, for bounds that are moved by whatToAppend before the pushed transform.
+		bool Culled(RawRect const& bounds, Transform const& whatToAppend) noexcept;
+		// called every time the pushed transform changes; refreshes pushedTransform_ and the visible rect.
+		void OnTransformChanged() noexcept;
+
+		// points the command buffer at the color and the transform of the next deferred command.
+		DrawCommandBuffer& Record(Transform const& fullTransform);
+		DrawCommandBuffer& Record(ColorF const& color);
+		DrawCommandBuffer& Record(ColorF const& color, Transform const& whatToAppend);
+
+		// draws one group of the sprite batch, either as one device sprite batch or bitmap by bitmap.
+		void DrawSpriteBatchGroup(SpriteBatch::Group const& group);
+
+		// diffs the frame against the last one, and draws the damaged parts only.
+		void EndRetainedFrame();
+
+		// copies the render target into capturedFrame_ through a cpu readable bitmap.
+		void CaptureRenderTarget();
+
+		// sorts the recorded commands, and sends them to the render target.
+		void SubmitDeferred();
+
+		// called before every render target draw call; puts the full transform together and hands it
+		// to ApplyTransform, so consecutive draws under the same transform only set it once.
 		// this should probably take a callable as a parameter, but I really hate templates.
 		void BeginTransform() noexcept;
 		void BeginTransform(Transform const& whatToAppend) noexcept;
-		// called after every render target draw call.
-		void EndTransform() noexcept;
+		// the only place that sets the render target transform; skips the call if the matrix is
+		// already applied (nothing resets it between draws, BeginDraw forgets it).
+		void ApplyTransform(D2D1_MATRIX_3X2_F const& matrix) noexcept;
 		// will be optimized away.
 		bool IsInitialized() const noexcept;
 
@@ -115,8 +391,16 @@ namespace ArEngine2D {
 		// simple shapes
 		Details::Ptr<ID2D1SolidColorBrush> pSolidBrush_;
 
-		// for drawing strings (very inefficient!)
+		// for drawing strings
 		Details::Ptr<IDWriteFactory> pDWriteFactory_{};
+		TextFormatCache textFormats_{};
+		TextFormatCache::FamilyID fontFamily_{};
+		FontWeight fontWeight_{FontWeight::Normal};
+		// used by DrawString and DrawStringCenter.
+		LruCache<LayoutKey, TextLayout, LayoutKeyHash> layouts_{128U};
+
+		// keyed by a hash of the vertices.
+		LruCache<std::uint64_t, CachedGeometry> geometries_{256U};
 
 		// for sprites
 		D2D1_BITMAP_INTERPOLATION_MODE interpolationMode_{D2D1_BITMAP_INTERPOLATION_MODE_LINEAR};
@@ -124,10 +408,127 @@ namespace ArEngine2D {
 		// extra transformations which can be used for drawing very specific
 		// things in the scene. saves me from added 10 billion more overloads 
 		// to the drawing routines.
+		TransformStack transforms_{};
+		// the top of transforms_, kept as a Transform for GetFullTransform and the draw calls.
 		Transform pushedTransform_;
 
-		std::stack<std::stack<Transform>> tranDoubleStack_;
-		std::stack<Transform> appendTranStack_;
-		std::stack<Transform> pushTranStack_;
+		// the matrix the render target currently uses.
+		RawMatrix appliedMatrix_{};
+		bool bAppliedMatrixKnown_{};
+		std::uint64_t transformChanges_{};
+
+		// layers; only a few, so they are looked up by name linearly.
+		std::vector<Layer> layers_{Layer{std::string{sc_DefaultLayer}, 0, {}}};
+
+		// deferred mode
+		bool bDeferred_{};
+		DrawCommandBuffer commands_{};
+		// keeps every recorded bitmap alive until it's submitted; sprite commands index into it.
+		std::vector<Details::Ptr<ID2D1Bitmap>> frameBitmaps_{};
+		std::vector<Vec2> scratchVertices_{};
+
+		// headless mode
+		bool bHeadless_{};
+		PixelBuffer frameBuffer_{};
+		SoftwareRasterizer rasterizer_{};
+		// not owned; a single threaded one draws on the calling thread only.
+		JobSystem* pRasterJobs_{};
+
+		// frame capture
+		bool bCaptureRequested_{};
+		PixelBuffer capturedFrame_{};
+
+		// retained mode; the last frame is kept alive so its images can not be reused for new ones.
+		bool bRetained_{};
+		bool bRetainedNext_{};
+		bool bRetainedValid_{};
+		DamageRegion damage_{};
+		DrawCommandBuffer previousCommands_{};
+		std::vector<std::uint64_t> frameImageKeys_{};
+		std::vector<std::uint64_t> previousImageKeys_{};
+		std::vector<Details::Ptr<ID2D1Bitmap>> previousBitmaps_{};
+		std::vector<std::shared_ptr<PixelBuffer const>> previousImageOwners_{};
+
+		// culling
+		bool bCulling_{true};
+		RawRect visibleRect_{};
+		std::uint64_t culledDraws_{};
+		std::uint64_t drawnDraws_{};
+		std::uint64_t instancedDraws_{};
+		std::uint64_t instancedShapes_{};
+		std::vector<PixelBuffer const*> frameImages_{};
+		std::vector<std::shared_ptr<PixelBuffer const>> frameImageOwners_{};
+		std::vector<RawPoint> scratchPoints_{};
+
+		// sprite batches
+		bool bInSpriteBatch_{};
+		SpriteBatch spriteBatch_{};
+		// image handles of spriteBatch_ index into this.
+		std::vector<Details::Ptr<ID2D1Bitmap>> batchBitmaps_{};
+		std::unordered_map<ID2D1Bitmap*, std::uint64_t> batchBitmapLut_{};
+		// null if the device does not support sprite batches.
+		Details::Ptr<ID2D1DeviceContext3> pContext3_{};
+		Details::Ptr<ID2D1SpriteBatch> pD2DSpriteBatch_{};
+		std::vector<D2D1_RECT_F> batchDestRects_{};
+		std::vector<D2D1_RECT_U> batchSrcRects_{};
+		std::vector<D2D1_COLOR_F> batchColors_{};
+		std::vector<D2D1_MATRIX_3X2_F> batchTransforms_{};
+		std::uint64_t batchedSprites_{};
+		std::uint64_t spriteBatchDraws_{};
+
+		FrameStats lastFrameStats_{};
 	};
+
+	// creates the (only) Grafix and JobSystem, headless, so call it before either exists.
+	inline void TestSpriteCopies()
+	{
+		using namespace ArTest;
+		std::ofstream file{"SpriteCopiesTestResults.txt"};
+		Tester tester{file};
+
+		JobSystem jobs{1U};
+		Grafix gfx{};
+		gfx.InitializeHeadless(4U, 4U, jobs);
+
+		constexpr std::uint32_t green{0xFF'00'FF'00U};
+		constexpr std::uint32_t red{0xFF'FF'00'00U};
+
+		Sprite original{};
+		original.Initialize(PixelBuffer{4U, 4U, 0xFF'00'00'FFU}, true);
+		auto const copy{original};
+		auto const view{original.View({2U, 2U, 4U, 4U})};
+
+		tester.NewTest("Copying memory into one copy shows in the others") = [&] {
+			PixelBuffer const data{4U, 4U, green};
+			original.CopyFromMemory(data.Pixels().data(), original.RectU(), data.Pitch());
+			tester.PassIfEqual(std::uint32_t{copy.Pixels()->At(0U, 0U)}, green);
+			tester.PassIfEqual(std::uint32_t{view.Pixels()->At(3U, 3U)}, green);
+			// the levels would show the old pixels, so every copy loses them.
+			tester.PassIfEqual(copy.MipLevelCount(), std::size_t{0U});
+			tester.PassIfEqual(view.MipLevelCount(), std::size_t{0U});
+
+			gfx.BeginDraw();
+			gfx.DrawSprite({}, copy);
+			gfx.EndDraw();
+			tester.PassIfEqual(std::uint32_t{gfx.FrameBuffer().At(1U, 1U)}, green);
+		};
+
+		tester.NewTest("Copying a sprite into a view shows in the others") = [&] {
+			Sprite source{};
+			source.Initialize(PixelBuffer{2U, 2U, red});
+			auto target{view};
+			target.CopyFromSpriteRect(source, source.RectU(), {});
+			tester.PassIfEqual(std::uint32_t{original.Pixels()->At(2U, 2U)}, red);
+			tester.PassIfEqual(std::uint32_t{copy.Pixels()->At(3U, 3U)}, red);
+			tester.PassIfEqual(std::uint32_t{copy.Pixels()->At(1U, 1U)}, green);
+
+			// a clone is not a copy.
+			auto clone{copy.Clone()};
+			PixelBuffer const data{4U, 4U, green};
+			clone.CopyFromMemory(data.Pixels().data(), clone.RectU(), data.Pitch());
+			tester.PassIfEqual(std::uint32_t{copy.Pixels()->At(3U, 3U)}, red);
+		};
+
+		tester.OutputResults();
+	}
 }
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace ArEngine2D::Details {
+	/**
+	 * @brief 64 bit FNV-1a, good enough for cache keys (not for anything security related).
+	*/
+	class Hash
+	{
+	public:
+		constexpr static std::uint64_t sc_Seed{0xCBF29CE484222325ULL};
+		constexpr static std::uint64_t sc_Prime{0x100000001B3ULL};
+
+	public:
+
+		Hash() = delete;
+
+	public:
+
+		/**
+		 * @param seed => pass the result of a previous call to hash multiple ranges as one.
+		 * @return the hash of the bytes in [pData, pData + byteCount).
+		*/
+		static std::uint64_t Bytes(void const* pData, std::size_t byteCount, std::uint64_t seed = sc_Seed) noexcept
+		{
+			auto const pBytes{static_cast<unsigned char const*>(pData)};
+			auto hash{seed};
+			for (std::size_t i{}; i < byteCount; ++i)
+			{
+				hash ^= pBytes[i];
+				hash *= sc_Prime;
+			}
+			return hash;
+		}
+
+		/**
+		 * @return the hash of the characters of the string.
+		*/
+		static std::uint64_t String(std::string_view str, std::uint64_t seed = sc_Seed) noexcept
+		{ return Bytes(str.data(), str.size(), seed); }
+
+		/**
+		 * @return the hash of the object representation of a trivially copyable value.
+		*/
+		template <class T>
+		static std::uint64_t Value(T const& value, std::uint64_t seed = sc_Seed) noexcept
+		{ return Bytes(&value, sizeof(T), seed); }
+	};
+}
@@ -0,0 +1,154 @@
+#include "ImageDecoder.h"
+
+#if defined(AR2D_DECODE_WITH_FREEIMAGE)
+#include "Lib/FreeImage/FreeImage.h"
+#elif defined(_WIN32)
+#include "ImplUtil.h"
+#include <wincodec.h>
+#endif
+
+#include <cstring>
+#include <memory>
+
+namespace ArEngine2D {
+	namespace {
+#if defined(AR2D_DECODE_WITH_FREEIMAGE)
+		static_assert(FI_RGBA_RED == 2 and FI_RGBA_ALPHA == 3, "FreeImage pixels must be laid out as BGRA");
+
+		struct FreeImageDeleter
+		{
+			void operator()(FIBITMAP* pBitmap) const noexcept
+			{
+				FreeImage_Unload(pBitmap);
+			}
+		};
+		using FreeImagePtr = std::unique_ptr<FIBITMAP, FreeImageDeleter>;
+
+		std::optional<PixelBuffer> DecodeWithBackend(std::filesystem::path const& path)
+		{
+#ifdef _WIN32
+			auto format{FreeImage_GetFileTypeU(path.c_str())};
+			auto const load = [&] { return FreeImage_LoadU(format, path.c_str()); };
+#else
+			auto const name{path.string()};
+			auto format{FreeImage_GetFileType(name.c_str())};
+			if (format == FIF_UNKNOWN)
+			{
+				format = FreeImage_GetFIFFromFilename(name.c_str());
+			}
+			auto const load = [&] { return FreeImage_Load(format, name.c_str()); };
+#endif
+			if (format == FIF_UNKNOWN or not FreeImage_FIFSupportsReading(format))
+			{
+				return std::nullopt;
+			}
+
+			FreeImagePtr const pLoaded{load()};
+			if (not pLoaded)
+			{
+				return std::nullopt;
+			}
+			FreeImagePtr const pConverted{FreeImage_ConvertTo32Bits(pLoaded.get())};
+			if (not pConverted or not FreeImage_PreMultiplyWithAlpha(pConverted.get()))
+			{
+				return std::nullopt;
+			}
+
+			auto const width{FreeImage_GetWidth(pConverted.get())};
+			auto const height{FreeImage_GetHeight(pConverted.get())};
+			PixelBuffer pixels{width, height};
+			for (unsigned y{}; y < height; ++y)
+			{
+				// FreeImage keeps the bottom row first.
+				auto const pSrc{FreeImage_GetScanLine(pConverted.get(), static_cast<int>(height - 1U - y))};
+				auto const row{pixels.Row(y)};
+				std::memcpy(row.data(), pSrc, row.size_bytes());
+			}
+			return pixels;
+		}
+#elif defined(_WIN32)
+		// WIC needs COM on every thread that uses it, and decoder threads come and go with their pools.
+		struct WicThreadState
+		{
+			WicThreadState()
+			{
+				bComInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+				if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER,
+					IID_PPV_ARGS(pFactory.GetAddressOf()))))
+				{
+					pFactory.Reset();
+				}
+			}
+			~WicThreadState()
+			{
+				pFactory.Reset();
+				if (bComInitialized)
+				{
+					CoUninitialize();
+				}
+			}
+
+			bool bComInitialized{};
+			Details::Ptr<IWICImagingFactory> pFactory{};
+		};
+
+		std::optional<PixelBuffer> DecodeWithBackend(std::filesystem::path const& path)
+		{
+			thread_local WicThreadState t_State{};
+			if (not t_State.pFactory)
+			{
+				return std::nullopt;
+			}
+
+			// the same steps as Sprite::Initialize, minus creating the bitmap.
+			Details::Ptr<IWICBitmapDecoder> pDecoder{};
+			Details::Ptr<IWICBitmapFrameDecode> pFrame{};
+			Details::Ptr<IWICFormatConverter> pConverter{};
+			UINT width{};
+			UINT height{};
+			if (FAILED(t_State.pFactory->CreateDecoderFromFilename(
+					path.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnLoad, &pDecoder))
+				or FAILED(pDecoder->GetFrame(0U, &pFrame))
+				or FAILED(t_State.pFactory->CreateFormatConverter(&pConverter))
+				or FAILED(pConverter->Initialize(pFrame.Get(), GUID_WICPixelFormat32bppPBGRA,
+					WICBitmapDitherTypeNone, nullptr, 0.f, WICBitmapPaletteTypeCustom))
+				or FAILED(pConverter->GetSize(&width, &height)))
+			{
+				return std::nullopt;
+			}
+
+			PixelBuffer pixels{width, height};
+			if (FAILED(pConverter->CopyPixels(nullptr, static_cast<UINT>(pixels.Pitch()),
+				static_cast<UINT>(pixels.Pitch() * height), reinterpret_cast<BYTE*>(pixels.Pixels().data()))))
+			{
+				return std::nullopt;
+			}
+			return pixels;
+		}
+#else
+		std::optional<PixelBuffer> DecodeWithBackend(std::filesystem::path const&)
+		{
+			return std::nullopt;
+		}
+#endif
+	}
+
+	std::optional<PixelBuffer> ImageDecoder::DecodeFile(std::filesystem::path const& path)
+	{
+		if (path.extension() == ".ppm")
+		{
+			return ImageFile::LoadPpm(path);
+		}
+		return DecodeWithBackend(path);
+	}
+	char const* ImageDecoder::BackendName() noexcept
+	{
+#if defined(AR2D_DECODE_WITH_FREEIMAGE)
+		return "FreeImage";
+#elif defined(_WIN32)
+		return "WIC";
+#else
+		return "none";
+#endif
+	}
+}
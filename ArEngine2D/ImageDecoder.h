@@ -0,0 +1,57 @@
+#pragma once
+
+#include "PixelBuffer.h"
+#include "ImageFile.h"
+#include "Testing/ArTest20.h"
+
+#include <filesystem>
+#include <optional>
+
+namespace ArEngine2D {
+	/**
+	 * @brief decodes image files into premultiplied PixelBuffers, on any thread.
+	 *		  binary ppm files are always decoded by ImageFile. everything else goes through WIC on windows, or
+	 *		  through FreeImage when AR2D_DECODE_WITH_FREEIMAGE is defined (which also builds on linux).
+	*/
+	class ImageDecoder
+	{
+	public:
+
+		ImageDecoder() = delete;
+
+	public:
+
+		/**
+		 * @return the pixels of the first frame of the file, or nothing if it could not be read or decoded.
+		*/
+		static std::optional<PixelBuffer> DecodeFile(std::filesystem::path const& path);
+
+		/**
+		 * @return the name of the decoder used for formats other than ppm ("none" if there is not any).
+		*/
+		static char const* BackendName() noexcept;
+	};
+
+	inline void TestImageDecoder()
+	{
+		using namespace ArTest;
+		std::ofstream file{"ImageDecoderTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Ppm files") = [&] {
+			PixelBuffer image{4U, 3U, 0xFF'20'40'60U};
+			image.At(3U, 2U) = 0xFF'FF'00'00U;
+			auto const path{std::filesystem::temp_directory_path() / "ar2d_decoder_test.ppm"};
+			tester.PassIf(ImageFile::Save(image, path));
+
+			auto const decoded{ImageDecoder::DecodeFile(path)};
+			tester.PassIf(decoded.has_value());
+			tester.PassIf(*decoded == image);
+			std::filesystem::remove(path);
+
+			tester.PassIf(not ImageDecoder::DecodeFile(path).has_value());
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -0,0 +1,246 @@
+#include "ImageFile.h"
+
+#include <array>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+
+namespace ArEngine2D {
+	namespace {
+		constexpr std::array<std::uint32_t, 256U> MakeCrcTable() noexcept
+		{
+			std::array<std::uint32_t, 256U> table{};
+			for (std::uint32_t i{}; i < 256U; ++i)
+			{
+				auto crc{i};
+				for (int bit{}; bit < 8; ++bit)
+				{
+					crc = (crc & 1U) ? (0xEDB88320U ^ (crc >> 1U)) : (crc >> 1U);
+				}
+				table[i] = crc;
+			}
+			return table;
+		}
+		constexpr auto sc_CrcTable{MakeCrcTable()};
+
+		std::uint32_t Crc32(std::span<std::uint8_t const> bytes) noexcept
+		{
+			auto crc{0xFFFFFFFFU};
+			for (auto const byte : bytes)
+			{
+				crc = sc_CrcTable[(crc ^ byte) & 0xFFU] ^ (crc >> 8U);
+			}
+			return crc ^ 0xFFFFFFFFU;
+		}
+
+		std::uint32_t Adler32(std::span<std::uint8_t const> bytes) noexcept
+		{
+			// 5552 bytes is the most that can be summed before the 32 bit sums may overflow.
+			constexpr std::size_t MaxRun{5552U};
+			std::uint32_t a{1U};
+			std::uint32_t b{};
+			while (not bytes.empty())
+			{
+				auto const run{bytes.first(std::min(bytes.size(), MaxRun))};
+				for (auto const byte : run)
+				{
+					a += byte;
+					b += a;
+				}
+				a %= 65521U;
+				b %= 65521U;
+				bytes = bytes.subspan(run.size());
+			}
+			return (b << 16U) | a;
+		}
+
+		void PushBigEndian(std::vector<std::uint8_t>& out, std::uint32_t value)
+		{
+			out.push_back(static_cast<std::uint8_t>(value >> 24U));
+			out.push_back(static_cast<std::uint8_t>(value >> 16U));
+			out.push_back(static_cast<std::uint8_t>(value >> 8U));
+			out.push_back(static_cast<std::uint8_t>(value));
+		}
+
+		void PushChunk(std::vector<std::uint8_t>& out, char const (&type)[5], std::span<std::uint8_t const> data)
+		{
+			PushBigEndian(out, static_cast<std::uint32_t>(data.size()));
+			auto const typeBegin{out.size()};
+			out.insert(out.end(), type, type + 4);
+			out.insert(out.end(), data.begin(), data.end());
+			PushBigEndian(out, Crc32(std::span{out}.subspan(typeBegin)));
+		}
+
+		// the channel without the alpha multiplied in, rounded to nearest.
+		std::uint8_t Unpremultiply(std::uint32_t channel, std::uint32_t alpha) noexcept
+		{
+			return static_cast<std::uint8_t>(std::min((channel * 255U + alpha / 2U) / alpha, 255U));
+		}
+	}
+
+	std::vector<std::uint8_t> ImageFile::EncodePpm(PixelBuffer const& image)
+	{
+		auto const header{"P6\n" + std::to_string(image.Width()) + ' ' + std::to_string(image.Height()) + "\n255\n"};
+		std::vector<std::uint8_t> out{header.begin(), header.end()};
+		out.reserve(out.size() + image.Pixels().size() * 3U);
+		for (auto const pixel : image.Pixels())
+		{
+			// premultiplied channels already are the color over black.
+			out.push_back(static_cast<std::uint8_t>(pixel >> 16U));
+			out.push_back(static_cast<std::uint8_t>(pixel >> 8U));
+			out.push_back(static_cast<std::uint8_t>(pixel));
+		}
+		return out;
+	}
+	std::vector<std::uint8_t> ImageFile::EncodePng(PixelBuffer const& image)
+	{
+		auto const width{static_cast<std::uint32_t>(image.Width())};
+		auto const height{static_cast<std::uint32_t>(image.Height())};
+
+		// every row starts with its filter type, 0 (none).
+		std::vector<std::uint8_t> raw{};
+		raw.reserve(static_cast<std::size_t>(height) * (1U + width * 4U));
+		for (std::size_t y{}; y < height; ++y)
+		{
+			raw.push_back(0U);
+			for (auto const pixel : image.Row(y))
+			{
+				auto const a{pixel >> 24U};
+				if (a == 0U)
+				{
+					raw.insert(raw.end(), 4U, 0U);
+					continue;
+				}
+				raw.push_back(Unpremultiply((pixel >> 16U) & 0xFFU, a));
+				raw.push_back(Unpremultiply((pixel >> 8U) & 0xFFU, a));
+				raw.push_back(Unpremultiply(pixel & 0xFFU, a));
+				raw.push_back(static_cast<std::uint8_t>(a));
+			}
+		}
+
+		// a zlib stream made of stored deflate blocks (at most 65535 bytes each).
+		constexpr std::size_t MaxBlock{65535U};
+		std::vector<std::uint8_t> zlib{0x78U, 0x01U};
+		zlib.reserve(raw.size() + raw.size() / MaxBlock * 5U + 11U);
+		std::span<std::uint8_t const> rest{raw};
+		do
+		{
+			auto const block{rest.first(std::min(rest.size(), MaxBlock))};
+			rest = rest.subspan(block.size());
+			auto const length{static_cast<std::uint16_t>(block.size())};
+			auto const inverted{static_cast<std::uint16_t>(~length)};
+			zlib.push_back(rest.empty() ? 1U : 0U);
+			zlib.push_back(static_cast<std::uint8_t>(length));
+			zlib.push_back(static_cast<std::uint8_t>(length >> 8U));
+			zlib.push_back(static_cast<std::uint8_t>(inverted));
+			zlib.push_back(static_cast<std::uint8_t>(inverted >> 8U));
+			zlib.insert(zlib.end(), block.begin(), block.end());
+		} while (not rest.empty());
+		PushBigEndian(zlib, Adler32(raw));
+
+		std::vector<std::uint8_t> header{};
+		PushBigEndian(header, width);
+		PushBigEndian(header, height);
+		// 8 bits, RGBA, deflate, adaptive filtering, not interlaced.
+		header.insert(header.end(), {8U, 6U, 0U, 0U, 0U});
+
+		std::vector<std::uint8_t> out{0x89U, 'P', 'N', 'G', '\r', '\n', 0x1AU, '\n'};
+		out.reserve(out.size() + 12U * 3U + header.size() + zlib.size());
+		PushChunk(out, "IHDR", header);
+		PushChunk(out, "IDAT", zlib);
+		PushChunk(out, "IEND", {});
+		return out;
+	}
+	bool ImageFile::Save(PixelBuffer const& image, std::filesystem::path const& path)
+	{
+		auto const extension{path.extension()};
+		std::vector<std::uint8_t> bytes{};
+		if (extension == ".png")
+		{
+			bytes = EncodePng(image);
+		}
+		else if (extension == ".ppm")
+		{
+			bytes = EncodePpm(image);
+		}
+		else
+		{
+			return false;
+		}
+
+		std::ofstream file{path, std::ios::binary};
+		file.write(reinterpret_cast<char const*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+		return static_cast<bool>(file);
+	}
+	std::optional<PixelBuffer> ImageFile::LoadPpm(std::filesystem::path const& path)
+	{
+		std::ifstream file{path, std::ios::binary};
+		if (not file)
+		{
+			return std::nullopt;
+		}
+		std::vector<std::uint8_t> const bytes{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}};
+		return DecodePpm(bytes);
+	}
+	std::optional<PixelBuffer> ImageFile::DecodePpm(std::span<std::uint8_t const> bytes)
+	{
+		auto const* pCurr{reinterpret_cast<char const*>(bytes.data())};
+		auto const* const pEnd{pCurr + bytes.size()};
+
+		// the header is "P6", width, height and maxval, separated by whitespace (and comments).
+		auto const skipSpace = [&] {
+			while (pCurr != pEnd)
+			{
+				if (*pCurr == '#')
+				{
+					pCurr = std::find(pCurr, pEnd, '\n');
+				}
+				else if (*pCurr == ' ' or *pCurr == '\t' or *pCurr == '\r' or *pCurr == '\n')
+				{
+					++pCurr;
+				}
+				else
+				{
+					return;
+				}
+			}
+		};
+		auto const readNumber = [&](std::size_t& out) {
+			skipSpace();
+			auto const [pNext, err] {std::from_chars(pCurr, pEnd, out)};
+			pCurr = pNext;
+			return err == std::errc{};
+		};
+
+		if (pEnd - pCurr < 2 or pCurr[0] != 'P' or pCurr[1] != '6')
+		{
+			return std::nullopt;
+		}
+		pCurr += 2;
+
+		std::size_t width{};
+		std::size_t height{};
+		std::size_t maxValue{};
+		if (not readNumber(width) or not readNumber(height) or not readNumber(maxValue) or maxValue != 255U or pCurr == pEnd)
+		{
+			return std::nullopt;
+		}
+		// exactly one whitespace character separates the header from the pixels.
+		++pCurr;
+		if (static_cast<std::size_t>(pEnd - pCurr) < width * height * 3U)
+		{
+			return std::nullopt;
+		}
+
+		PixelBuffer image{width, height};
+		for (auto& pixel : image.Pixels())
+		{
+			auto const r{static_cast<std::uint8_t>(pCurr[0])};
+			auto const g{static_cast<std::uint8_t>(pCurr[1])};
+			auto const b{static_cast<std::uint8_t>(pCurr[2])};
+			pixel = 0xFF'00'00'00U | (std::uint32_t{r} << 16U) | (std::uint32_t{g} << 8U) | b;
+			pCurr += 3;
+		}
+		return image;
+	}
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "PixelBuffer.h"
+#include "Testing/ArTest20.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief writes (and reads back) PixelBuffers as image files, without any windows dependency.
+	 *		  meant for frame captures and golden images, not for shipping assets.
+	*/
+	class ImageFile
+	{
+	public:
+
+		ImageFile() = delete;
+
+	public:
+
+		/**
+		 * @return a binary (P6) ppm; there is no alpha, so the pixels come out as if drawn over black.
+		*/
+		static std::vector<std::uint8_t> EncodePpm(PixelBuffer const& image);
+
+		/**
+		 * @return an 8 bit RGBA png with straight alpha. the data is stored without compression,
+		 *		   which keeps the encoder tiny and fast; the files are as big as the raw pixels.
+		*/
+		static std::vector<std::uint8_t> EncodePng(PixelBuffer const& image);
+
+		/**
+		 * @brief picks the format from the extension (.png or .ppm).
+		 * @return false if the extension is unknown, or the file could not be written.
+		*/
+		static bool Save(PixelBuffer const& image, std::filesystem::path const& path);
+
+		/**
+		 * @return the image in a binary ppm written by EncodePpm (or anything else with maxval 255),
+		 *		   or nothing if the file can not be read.
+		*/
+		static std::optional<PixelBuffer> LoadPpm(std::filesystem::path const& path);
+		static std::optional<PixelBuffer> DecodePpm(std::span<std::uint8_t const> bytes);
+	};
+
+	inline void TestImageFile()
+	{
+		using namespace ArTest;
+		std::ofstream file{"ImageFileTestResults.txt"};
+		Tester tester{file};
+
+		PixelBuffer image{3U, 2U, 0xFF'10'20'30U};
+		image.At(1U, 0U) = 0x80'40'00'00U;
+		image.At(2U, 1U) = 0U;
+
+		tester.NewTest("Ppm round trip") = [&] {
+			auto const bytes{ImageFile::EncodePpm(image)};
+			std::string const header{"P6\n3 2\n255\n"};
+			tester.PassIf(std::equal(header.begin(), header.end(), bytes.begin()));
+			tester.PassIfEqual(bytes.size(), header.size() + 3U * 2U * 3U);
+
+			auto const decoded{ImageFile::DecodePpm(bytes)};
+			tester.PassIf(decoded.has_value());
+			tester.PassIfEqual(decoded->At(0U, 0U), 0xFF'10'20'30U);
+			// drawn over black, and opaque after that.
+			tester.PassIfEqual(decoded->At(1U, 0U), 0xFF'40'00'00U);
+			tester.PassIfEqual(decoded->At(2U, 1U), 0xFF'00'00'00U);
+			tester.PassIf(not ImageFile::DecodePpm(std::span{bytes}.first(5U)).has_value());
+		};
+
+		tester.NewTest("Png layout") = [&] {
+			auto const bytes{ImageFile::EncodePng(image)};
+			std::uint8_t const signature[]{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+			tester.PassIf(std::equal(std::begin(signature), std::end(signature), bytes.begin()));
+			// the IHDR chunk: length 13, width 3, height 2, 8 bits, RGBA.
+			tester.PassIfEqual(bytes[11], std::uint8_t{13U});
+			tester.PassIfEqual(bytes[19], std::uint8_t{3U});
+			tester.PassIfEqual(bytes[23], std::uint8_t{2U});
+			tester.PassIfEqual(bytes[24], std::uint8_t{8U});
+			tester.PassIfEqual(bytes[25], std::uint8_t{6U});
+
+			// signature, IHDR, IDAT (zlib header, one stored block, rows with a filter byte, adler), IEND.
+			constexpr std::size_t raw{2U * (1U + 3U * 4U)};
+			tester.PassIfEqual(bytes.size(), 8U + 25U + (12U + 2U + 5U + raw + 4U) + 12U);
+
+			// the first pixel of the first row, straight alpha RGBA.
+			constexpr std::size_t firstPixel{8U + 25U + 8U + 2U + 5U + 1U};
+			tester.PassIfEqual(bytes[firstPixel], std::uint8_t{0x10U});
+			tester.PassIfEqual(bytes[firstPixel + 3U], std::uint8_t{0xFFU});
+			// the half transparent one is unpremultiplied.
+			tester.PassIfEqual(bytes[firstPixel + 4U], std::uint8_t{0x80U});
+			tester.PassIfEqual(bytes[firstPixel + 7U], std::uint8_t{0x80U});
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -0,0 +1,289 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <cassert>
+
+namespace ArEngine2D {
+	namespace {
+		thread_local std::size_t t_ThreadIndex{};
+	}
+
+	JobSystem::JobSystem(std::size_t threadCount)
+	{
+		threadCount = std::max<std::size_t>(threadCount, 1U);
+		queues_.reserve(threadCount);
+		for (std::size_t i{}; i < threadCount; ++i)
+		{
+			queues_.push_back(std::make_unique<Queue>());
+		}
+
+		workers_.reserve(threadCount - 1U);
+		for (std::size_t i{1U}; i < threadCount; ++i)
+		{
+			workers_.emplace_back([this, i] { WorkerLoop(i); });
+		}
+	}
+	JobSystem::~JobSystem()
+	{
+		try
+		{
+			Wait();
+		}
+		catch (...)
+		{
+			// nobody is left to hear about it.
+		}
+		{
+			std::scoped_lock lock{wakeMutex_};
+			bStopping_ = true;
+		}
+		wake_.notify_all();
+		workers_.clear();
+	}
+	void JobSystem::Submit(Job job)
+	{
+		assert(job && "Tried to submit an empty job");
+		pending_.fetch_add(1U);
+		Enqueue({std::move(job), nullptr});
+	}
+	void JobSystem::Submit(Job job, JobCounter& counter)
+	{
+		assert(job && "Tried to submit an empty job");
+		counter.count_.fetch_add(1U);
+		pending_.fetch_add(1U);
+		Enqueue({std::move(job), &counter});
+	}
+	void JobSystem::SubmitAfter(JobCounter& dependency, Job job)
+	{
+		assert(job && "Tried to submit an empty job");
+		pending_.fetch_add(1U);
+		{
+			std::scoped_lock lock{dependency.mutex_};
+			if (dependency.count_.load() != 0U)
+			{
+				dependency.waiting_.emplace_back(std::move(job), nullptr);
+				return;
+			}
+		}
+		Enqueue({std::move(job), nullptr});
+	}
+	void JobSystem::SubmitAfter(JobCounter& dependency, Job job, JobCounter& counter)
+	{
+		assert(job && "Tried to submit an empty job");
+		counter.count_.fetch_add(1U);
+		pending_.fetch_add(1U);
+		{
+			std::scoped_lock lock{dependency.mutex_};
+			if (dependency.count_.load() != 0U)
+			{
+				dependency.waiting_.emplace_back(std::move(job), &counter);
+				return;
+			}
+		}
+		Enqueue({std::move(job), &counter});
+	}
+	void JobSystem::Wait()
+	{
+		while (pending_.load() != 0U)
+		{
+			if (not TryRunOne(0U))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		std::exception_ptr pError{};
+		{
+			std::scoped_lock lock{errorMutex_};
+			pError = std::exchange(pError_, nullptr);
+		}
+		if (pError)
+		{
+			std::rethrow_exception(pError);
+		}
+	}
+	void JobSystem::Wait(JobCounter& counter)
+	{
+		while (not counter.IsDone())
+		{
+			if (not TryRunOne(t_ThreadIndex))
+			{
+				std::this_thread::yield();
+			}
+		}
+
+		std::exception_ptr pError{};
+		{
+			std::scoped_lock lock{counter.mutex_};
+			pError = std::exchange(counter.pError_, nullptr);
+		}
+		if (pError)
+		{
+			std::rethrow_exception(pError);
+		}
+	}
+	void JobSystem::ParallelFor(std::size_t count, std::function<void(std::size_t)> const& func, std::size_t grain)
+	{
+		ParallelForRanges(count, [&func](std::size_t first, std::size_t last) {
+			for (auto i{first}; i < last; ++i)
+			{
+				func(i);
+			}
+		}, grain);
+	}
+	void JobSystem::ParallelForRanges(std::size_t count, std::function<void(std::size_t, std::size_t)> const& func,
+		std::size_t grain)
+	{
+		grain = std::max<std::size_t>(grain, 1U);
+		JobCounter counter{};
+		for (std::size_t first{}; first < count; first += grain)
+		{
+			Submit([&func, first, last = std::min(first + grain, count)] { func(first, last); }, counter);
+		}
+		Wait(counter);
+	}
+	std::size_t JobSystem::ThreadCount() const noexcept
+	{
+		return queues_.size();
+	}
+	std::uint64_t JobSystem::StolenJobs() const noexcept
+	{
+		return stolenJobs_.load();
+	}
+	std::size_t JobSystem::ThreadIndex() noexcept
+	{
+		return t_ThreadIndex;
+	}
+	void JobSystem::WorkerLoop(std::size_t index)
+	{
+		t_ThreadIndex = index;
+		while (true)
+		{
+			if (TryRunOne(index))
+			{
+				continue;
+			}
+
+			std::unique_lock lock{wakeMutex_};
+			wake_.wait(lock, [this] { return bStopping_ or queued_.load() != 0U; });
+			if (bStopping_)
+			{
+				return;
+			}
+		}
+	}
+	bool JobSystem::TryRunOne(std::size_t index)
+	{
+		Entry entry{};
+		for (std::size_t i{}, lim{queues_.size()}; i < lim and not entry.first; ++i)
+		{
+			auto& queue{*queues_[(index + i) % lim]};
+			std::scoped_lock lock{queue.mutex};
+			if (queue.jobs.empty())
+			{
+				continue;
+			}
+
+			if (i == 0U)
+			{
+				entry = std::move(queue.jobs.back());
+				queue.jobs.pop_back();
+			}
+			else
+			{
+				entry = std::move(queue.jobs.front());
+				queue.jobs.pop_front();
+				stolenJobs_.fetch_add(1U);
+			}
+		}
+		if (not entry.first)
+		{
+			return false;
+		}
+
+		queued_.fetch_sub(1U);
+		Run(entry);
+		return true;
+	}
+	void JobSystem::Enqueue(Entry entry)
+	{
+		if (workers_.empty())
+		{
+			return Run(entry);
+		}
+
+		auto& queue{*queues_[nextQueue_.fetch_add(1U) % queues_.size()]};
+		{
+			std::scoped_lock lock{queue.mutex};
+			queue.jobs.push_back(std::move(entry));
+		}
+		{
+			// taking the lock makes sure a worker can not miss the wake up between checking and sleeping.
+			std::scoped_lock lock{wakeMutex_};
+			queued_.fetch_add(1U);
+		}
+		wake_.notify_one();
+	}
+	void JobSystem::Run(Entry& entry)
+	{
+		// a job that throws is still done, or its counter would never reach 0.
+		std::exception_ptr pError{};
+		try
+		{
+			entry.first();
+		}
+		catch (...)
+		{
+			pError = std::current_exception();
+		}
+
+		if (entry.second)
+		{
+			Finish(*entry.second, std::move(pError));
+		}
+		else if (pError)
+		{
+			std::scoped_lock lock{errorMutex_};
+			if (not pError_)
+			{
+				pError_ = std::move(pError);
+			}
+		}
+		// after Finish, so what it released is already counted when this reaches 0.
+		pending_.fetch_sub(1U);
+	}
+	void JobSystem::Finish(JobCounter& counter, std::exception_ptr pError)
+	{
+		std::vector<Entry> released{};
+		{
+			std::scoped_lock lock{counter.mutex_};
+			if (pError and not counter.pError_)
+			{
+				counter.pError_ = std::move(pError);
+			}
+			if (counter.count_.fetch_sub(1U) == 1U)
+			{
+				released.swap(counter.waiting_);
+			}
+		}
+		for (auto& entry : released)
+		{
+			Enqueue(std::move(entry));
+		}
+	}
+
+	JobCounter::~JobCounter()
+	{
+		// a job that finished last may still be inside Finish.
+		std::scoped_lock lock{mutex_};
+		assert(count_.load() == 0U && "A JobCounter was destroyed before its jobs were done");
+	}
+	bool JobCounter::IsDone() const noexcept
+	{
+		return count_.load() == 0U;
+	}
+	std::size_t JobCounter::Value() const noexcept
+	{
+		return count_.load();
+	}
+}
@@ -0,0 +1,330 @@
+#pragma once
+
+#include "ISingle.h"
+#include "Testing/ArTest20.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ArEngine2D {
+	class JobCounter;
+
+	/**
+	 * @brief a small work stealing thread pool. every thread owns a queue; it takes jobs from the
+	 *		  back of its own queue, and steals from the front of the others when it runs out.
+	 *		  the thread that calls Wait (or ParallelFor) works on jobs too, as thread 0.
+	 *
+	 *		  Wait() waits for every job, so it's meant for the one thread that submits them, and
+	 *		  can not be called from a job. JobCounters wait for only some of them, from anywhere
+	 *		  (jobs included), and make other jobs wait for them too (see SubmitAfter).
+	*/
+	class JobSystem : Details::ISingle
+	{
+	public:
+
+		using Job = std::function<void()>;
+
+	public:
+
+		/**
+		 * @param threadCount => including the calling thread; 1 runs everything on the caller.
+		*/
+		explicit JobSystem(std::size_t threadCount = std::thread::hardware_concurrency());
+		~JobSystem();
+
+	public:
+
+		void Submit(Job job);
+
+		/**
+		 * @brief counter goes up by one now, and down by one when the job is done.
+		*/
+		void Submit(Job job, JobCounter& counter);
+
+		/**
+		 * @brief the job is only queued once dependency reaches 0 (right away if it already has);
+		 *		  nothing waits for that meanwhile, it's held by the counter.
+		*/
+		void SubmitAfter(JobCounter& dependency, Job job);
+		void SubmitAfter(JobCounter& dependency, Job job, JobCounter& counter);
+
+		/**
+		 * @brief runs jobs on the calling thread until every submitted job is done, then throws what
+		 *		  a job without a counter threw, if any did.
+		*/
+		void Wait();
+
+		/**
+		 * @brief runs jobs on the calling thread until the counter reaches 0, then throws what one of
+		 *		  its jobs threw, if any did; works inside jobs.
+		*/
+		void Wait(JobCounter& counter);
+
+		/**
+		 * @brief calls func(i) for every i in [0, count), then waits for those calls only (and throws
+		 *		  what one of them threw). indices are handed out in chunks of grain, so tiny jobs do
+		 *		  not drown in overhead.
+		*/
+		void ParallelFor(std::size_t count, std::function<void(std::size_t)> const& func, std::size_t grain = 1U);
+
+		/**
+		 * @brief like ParallelFor, but every job gets its whole chunk as [first, last) at once.
+		*/
+		void ParallelForRanges(std::size_t count, std::function<void(std::size_t first, std::size_t last)> const& func,
+			std::size_t grain = 1U);
+
+		/**
+		 * @return the number of threads jobs run on, the calling thread included.
+		*/
+		std::size_t ThreadCount() const noexcept;
+
+		/**
+		 * @return the jobs that ran on a thread other than the one they were submitted to.
+		*/
+		std::uint64_t StolenJobs() const noexcept;
+
+		/**
+		 * @return the index (< ThreadCount) of the thread running the current job, 0 outside of jobs
+		 *		   (for every thread that is not one of the workers).
+		*/
+		static std::size_t ThreadIndex() noexcept;
+
+	private:
+
+		// the counter it counts towards, if any.
+		using Entry = std::pair<Job, JobCounter*>;
+
+		struct Queue
+		{
+			std::mutex mutex;
+			std::deque<Entry> jobs;
+		};
+
+	private:
+		void WorkerLoop(std::size_t index);
+		// runs one job if any thread has one; the own queue is tried first.
+		bool TryRunOne(std::size_t index);
+		// puts an entry that was already counted in pending_ on a queue.
+		void Enqueue(Entry entry);
+		void Run(Entry& entry);
+		// one job of the counter is done; queues what waited for it when it's the last one.
+		void Finish(JobCounter& counter, std::exception_ptr pError);
+
+	private:
+		std::vector<std::unique_ptr<Queue>> queues_{};
+		std::vector<std::jthread> workers_{};
+
+		// submitted but not yet finished.
+		std::atomic<std::size_t> pending_{};
+		// submitted but not yet taken out of a queue; the workers sleep while it's 0.
+		std::atomic<std::size_t> queued_{};
+		std::atomic<std::size_t> nextQueue_{};
+		std::atomic<std::uint64_t> stolenJobs_{};
+
+		std::mutex wakeMutex_{};
+		std::condition_variable wake_{};
+		bool bStopping_{};
+
+		// the first one a job without a counter threw.
+		std::mutex errorMutex_{};
+		std::exception_ptr pError_{};
+	};
+
+	/**
+	 * @brief the number of unfinished jobs that were submitted with it. JobSystem::Wait(counter) is a
+	 *		  fence for those jobs, and JobSystem::SubmitAfter chains other jobs behind them.
+	 *		  counters can be reused once they reach 0, and must outlive the jobs they count.
+	*/
+	class JobCounter : Details::ISingle
+	{
+	public:
+
+		JobCounter() = default;
+		~JobCounter();
+
+	public:
+
+		bool IsDone() const noexcept;
+		std::size_t Value() const noexcept;
+
+	private:
+		friend class JobSystem;
+
+	private:
+		std::atomic<std::size_t> count_{};
+		// guards waiting_, pError_, and the last decrement of count_ (so it's never destroyed halfway through one).
+		mutable std::mutex mutex_{};
+		std::vector<std::pair<JobSystem::Job, JobCounter*>> waiting_{};
+		// the first one its jobs threw; taken by JobSystem::Wait.
+		std::exception_ptr pError_{};
+	};
+
+	inline void TestJobSystem()
+	{
+		using namespace ArTest;
+		std::ofstream file{"JobSystemTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Parallel for covers every index once") = [&] {
+			JobSystem jobs{4U};
+			std::vector<std::atomic<int>> hits(1000U);
+			jobs.ParallelFor(hits.size(), [&](std::size_t i) { hits[i].fetch_add(1); }, 7U);
+			bool bOnce{true};
+			for (auto const& hit : hits)
+			{
+				bOnce = bOnce and hit.load() == 1;
+			}
+			tester.PassIf(bOnce);
+
+			std::atomic<std::size_t> sum{};
+			jobs.ParallelForRanges(1000U, [&](std::size_t first, std::size_t last) {
+				sum.fetch_add(last - first);
+			}, 64U);
+			tester.PassIfEqual(sum.load(), 1000U);
+		};
+
+		tester.NewTest("Counters are fences") = [&] {
+			JobSystem jobs{4U};
+			JobCounter counter{};
+			std::atomic<int> done{};
+			for (int i{}; i < 50; ++i)
+			{
+				jobs.Submit([&] {
+					std::this_thread::sleep_for(std::chrono::microseconds{100});
+					done.fetch_add(1);
+				}, counter);
+			}
+			jobs.Wait(counter);
+			tester.PassIf(counter.IsDone());
+			tester.PassIfEqual(done.load(), 50);
+		};
+
+		tester.NewTest("Dependencies run in order") = [&] {
+			for (std::size_t threads{1U}; threads <= 4U; threads += 3U)
+			{
+				JobSystem jobs{threads};
+				JobCounter first{};
+				JobCounter second{};
+				JobCounter third{};
+				std::atomic<int> firstDone{};
+				std::atomic<bool> bSecondSawAll{true};
+				std::atomic<bool> bThirdSawSecond{};
+				for (int i{}; i < 20; ++i)
+				{
+					jobs.Submit([&] {
+						std::this_thread::sleep_for(std::chrono::microseconds{50});
+						firstDone.fetch_add(1);
+					}, first);
+				}
+				for (int i{}; i < 10; ++i)
+				{
+					jobs.SubmitAfter(first, [&] {
+						if (firstDone.load() != 20)
+						{
+							bSecondSawAll = false;
+						}
+					}, second);
+				}
+				jobs.SubmitAfter(second, [&] { bThirdSawSecond = second.IsDone(); }, third);
+				jobs.Wait(third);
+				tester.PassIf(bSecondSawAll.load());
+				tester.PassIf(bThirdSawSecond.load());
+
+				// an already finished dependency does not hold anything back.
+				std::atomic<bool> bRan{};
+				jobs.SubmitAfter(first, [&] { bRan = true; });
+				jobs.Wait();
+				tester.PassIf(bRan.load());
+			}
+		};
+
+		tester.NewTest("Jobs can wait for counters") = [&] {
+			JobSystem jobs{3U};
+			std::atomic<std::size_t> inner{};
+			jobs.ParallelFor(8U, [&](std::size_t) {
+				// a nested parallel for waits on its own counter, helping out meanwhile.
+				jobs.ParallelFor(16U, [&](std::size_t) { inner.fetch_add(1U); });
+			});
+			tester.PassIfEqual(inner.load(), 128U);
+		};
+
+		tester.NewTest("Thrown errors reach Wait") = [&] {
+			for (std::size_t threads{1U}; threads <= 4U; threads += 3U)
+			{
+				JobSystem jobs{threads};
+				std::atomic<std::size_t> ran{};
+				bool bThrew{};
+				try
+				{
+					jobs.ParallelFor(64U, [&](std::size_t i) {
+						ran.fetch_add(1U);
+						if (i % 16U == 5U)
+						{
+							throw std::runtime_error{"job failed"};
+						}
+					});
+				}
+				catch (std::runtime_error const&)
+				{
+					bThrew = true;
+				}
+				tester.PassIf(bThrew);
+				// the others still ran, and nothing was left behind.
+				tester.PassIfEqual(ran.load(), std::size_t{64U});
+
+				JobCounter counter{};
+				jobs.Submit([] { throw std::runtime_error{"job failed"}; }, counter);
+				std::atomic<bool> bAfterRan{};
+				jobs.SubmitAfter(counter, [&] { bAfterRan = true; });
+				bThrew = false;
+				try
+				{
+					jobs.Wait();
+				}
+				catch (std::runtime_error const&)
+				{
+					bThrew = true;
+				}
+				// the counter keeps its own error.
+				tester.PassIf(not bThrew);
+				tester.PassIf(bAfterRan.load());
+				try
+				{
+					jobs.Wait(counter);
+				}
+				catch (std::runtime_error const&)
+				{
+					bThrew = true;
+				}
+				tester.PassIf(bThrew);
+
+				jobs.Submit([] { throw std::runtime_error{"job failed"}; });
+				bThrew = false;
+				try
+				{
+					jobs.Wait();
+				}
+				catch (std::runtime_error const&)
+				{
+					bThrew = true;
+				}
+				tester.PassIf(bThrew);
+				// thrown once only.
+				jobs.Wait();
+				jobs.Wait(counter);
+			}
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <concepts>
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace ArEngine2D {
+	/**
+	 * @brief a fixed capacity key-value cache that evicts the least recently used entry.
+	 *		  hits never allocate, only inserting a new entry does.
+	 * @tparam TKey => must be hashable using THash and comparable using operator==.
+	 * @tparam TValue => the cached type.
+	*/
+	template <class TKey, class TValue, class THash = std::hash<TKey>>
+	class LruCache
+	{
+	private:
+		using self = LruCache;
+		using Entry = std::pair<TKey, TValue>;
+		using EntryList = std::list<Entry>;
+		using EntryIt = typename EntryList::iterator;
+
+	public:
+
+		/**
+		 * @param capacity => the max number of entries before the cache starts evicting.
+		*/
+		explicit LruCache(std::size_t capacity) : capacity_{capacity}
+		{
+			assert(capacity > 0U && "LruCache must be able to hold at least one entry");
+			lut_.reserve(capacity);
+		}
+
+		LruCache(self const&)			 = delete;
+		LruCache(self&&)				 = default;
+		self& operator=(self const&)	 = delete;
+		self& operator=(self&&)			 = default;
+
+	public:
+
+		/**
+		 * @brief counts as either a hit or a miss, and marks the entry as the most recently used.
+		 * @return a pointer to the cached value, or nullptr if it's not in the cache.
+		*/
+		TValue* Find(TKey const& key)
+		{
+			auto const it{lut_.find(key)};
+			if (it == lut_.end())
+			{
+				++misses_;
+				return nullptr;
+			}
+
+			++hits_;
+			entries_.splice(entries_.begin(), entries_, it->second);
+			return &it->second->second;
+		}
+
+		/**
+		 * @brief inserts a new entry, evicting the least recently used one if the cache is full.
+		 *		  inserting a key that already exists replaces its value.
+		 * @return a reference to the inserted value.
+		*/
+		TValue& Insert(TKey const& key, TValue value)
+		{
+			if (auto const it{lut_.find(key)}; it != lut_.end())
+			{
+				it->second->second = std::move(value);
+				entries_.splice(entries_.begin(), entries_, it->second);
+				return it->second->second;
+			}
+
+			if (entries_.size() == capacity_)
+			{
+				EvictOne();
+			}
+
+			entries_.emplace_front(key, std::move(value));
+			lut_.emplace(key, entries_.begin());
+			return entries_.front().second;
+		}
+
+		/**
+		 * @brief looks the key up, and only calls the factory on a miss.
+		 * @param factory => called with no arguments, must return something convertible to TValue.
+		 * @return a reference to the cached (or newly created) value.
+		*/
+		template <std::invocable Callable>
+		TValue& FindOrCreate(TKey const& key, Callable&& factory)
+		{
+			if (auto const pValue{Find(key)})
+			{
+				return *pValue;
+			}
+			return Insert(key, std::forward<Callable>(factory)());
+		}
+
+		/**
+		 * @brief removes an entry if it exists (does not count as an eviction).
+		*/
+		void Erase(TKey const& key)
+		{
+			if (auto const it{lut_.find(key)}; it != lut_.end())
+			{
+				entries_.erase(it->second);
+				lut_.erase(it);
+			}
+		}
+
+		/**
+		 * @brief removes every entry, the counters are left untouched.
+		*/
+		void Clear() noexcept
+		{
+			lut_.clear();
+			entries_.clear();
+		}
+
+		/**
+		 * @brief sets hits, misses and evictions back to zero.
+		*/
+		void ResetCounters() noexcept
+		{
+			hits_ = misses_ = evictions_ = 0U;
+		}
+
+	public:
+
+		std::size_t Size() const noexcept
+		{ return entries_.size(); }
+
+		std::size_t Capacity() const noexcept
+		{ return capacity_; }
+
+		std::uint64_t Hits() const noexcept
+		{ return hits_; }
+
+		std::uint64_t Misses() const noexcept
+		{ return misses_; }
+
+		std::uint64_t Evictions() const noexcept
+		{ return evictions_; }
+
+	private:
+		void EvictOne()
+		{
+			assert(not entries_.empty());
+			lut_.erase(entries_.back().first);
+			entries_.pop_back();
+			++evictions_;
+		}
+
+	private:
+		std::size_t capacity_;
+		EntryList entries_{};
+		std::unordered_map<TKey, EntryIt, THash> lut_{};
+
+		std::uint64_t hits_{};
+		std::uint64_t misses_{};
+		std::uint64_t evictions_{};
+	};
+}
@@ -0,0 +1,131 @@
+#include "MipChain.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+#define AR2D_MIPCHAIN_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ArEngine2D {
+	namespace {
+		// the rounded average of four premultiplied pixels, two channels at a time.
+		std::uint32_t Average(std::uint32_t a, std::uint32_t b, std::uint32_t c, std::uint32_t d) noexcept
+		{
+			constexpr std::uint32_t Mask{0x00FF00FFU};
+			constexpr std::uint32_t Two{0x00020002U};
+			auto const rb{((a & Mask) + (b & Mask) + (c & Mask) + (d & Mask) + Two) >> 2U & Mask};
+			auto const ag{(((a >> 8U) & Mask) + ((b >> 8U) & Mask) + ((c >> 8U) & Mask) + ((d >> 8U) & Mask) + Two) >> 2U & Mask};
+			return rb | (ag << 8U);
+		}
+
+		// output pixels [first, end) of one row; the last column of odd widths is repeated.
+		void DownsampleRowScalar(std::span<std::uint32_t const> top, std::span<std::uint32_t const> bottom,
+			std::span<std::uint32_t> out, std::size_t first) noexcept
+		{
+			auto const last{top.size() - 1U};
+			for (auto x{first}; x < out.size(); ++x)
+			{
+				auto const left{2U * x};
+				auto const right{std::min(left + 1U, last)};
+				out[x] = Average(top[left], top[right], bottom[left], bottom[right]);
+			}
+		}
+
+#ifdef AR2D_MIPCHAIN_SSE2
+		// four output pixels from eight pixels of each row.
+		__m128i Average8x2(__m128i top0, __m128i top1, __m128i bottom0, __m128i bottom1) noexcept
+		{
+			auto const zero{_mm_setzero_si128()};
+			auto const two{_mm_set1_epi16(2)};
+			auto const half = [&](__m128i top, __m128i bottom) {
+				// 16 bits per channel: [p0, p1] and [p2, p3], both rows added.
+				auto const lo{_mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero))};
+				auto const hi{_mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero))};
+				// [p0 + p1, p2 + p3]
+				auto const sum{_mm_add_epi16(_mm_unpacklo_epi64(lo, hi), _mm_unpackhi_epi64(lo, hi))};
+				return _mm_srli_epi16(_mm_add_epi16(sum, two), 2);
+			};
+			return _mm_packus_epi16(half(top0, bottom0), half(top1, bottom1));
+		}
+#endif
+	}
+
+	PixelBuffer MipChain::Downsample(PixelBuffer const& image)
+	{
+#ifdef AR2D_MIPCHAIN_SSE2
+		assert(not image.IsEmpty() && "Tried to downsample an empty image");
+		auto const width{image.Width()};
+		auto const height{image.Height()};
+		PixelBuffer half{(width + 1U) / 2U, (height + 1U) / 2U};
+		// whole groups of four output pixels, which only read pixels that exist.
+		auto const simdEnd{width / 8U * 4U};
+		for (std::size_t y{}; y < half.Height(); ++y)
+		{
+			auto const top{image.Row(2U * y)};
+			auto const bottom{image.Row(std::min(2U * y + 1U, height - 1U))};
+			auto const out{half.Row(y)};
+			for (std::size_t x{}; x < simdEnd; x += 4U)
+			{
+				auto const load = [&](std::span<std::uint32_t const> row, std::size_t at) {
+					return _mm_loadu_si128(reinterpret_cast<__m128i const*>(row.data() + at));
+				};
+				auto const result{Average8x2(load(top, 2U * x), load(top, 2U * x + 4U), load(bottom, 2U * x), load(bottom, 2U * x + 4U))};
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(out.data() + x), result);
+			}
+			DownsampleRowScalar(top, bottom, out, simdEnd);
+		}
+		return half;
+#else
+		return DownsampleScalar(image);
+#endif
+	}
+	PixelBuffer MipChain::DownsampleScalar(PixelBuffer const& image)
+	{
+		assert(not image.IsEmpty() && "Tried to downsample an empty image");
+		auto const height{image.Height()};
+		PixelBuffer half{(image.Width() + 1U) / 2U, (height + 1U) / 2U};
+		for (std::size_t y{}; y < half.Height(); ++y)
+		{
+			DownsampleRowScalar(image.Row(2U * y), image.Row(std::min(2U * y + 1U, height - 1U)), half.Row(y), 0U);
+		}
+		return half;
+	}
+	std::vector<PixelBuffer> MipChain::Build(PixelBuffer const& image)
+	{
+		std::vector<PixelBuffer> levels{};
+		levels.reserve(LevelCount(image.Width(), image.Height()));
+		auto const* pPrev{&image};
+		while (pPrev->Width() > 1U or pPrev->Height() > 1U)
+		{
+			levels.push_back(Downsample(*pPrev));
+			pPrev = &levels.back();
+		}
+		return levels;
+	}
+	std::size_t MipChain::LevelCount(std::size_t width, std::size_t height) noexcept
+	{
+		std::size_t count{};
+		while (width > 1U or height > 1U)
+		{
+			width = (width + 1U) / 2U;
+			height = (height + 1U) / 2U;
+			++count;
+		}
+		return count;
+	}
+	std::size_t MipChain::SelectLevel(float scale, std::size_t levelCount) noexcept
+	{
+		if (scale >= 1.f or levelCount == 0U)
+		{
+			return 0U;
+		}
+		if (not (scale > 0.f))
+		{
+			return levelCount;
+		}
+		auto const level{std::floor(-std::log2(scale))};
+		return std::min(static_cast<std::size_t>(level), levelCount);
+	}
+}
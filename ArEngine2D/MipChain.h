@@ -0,0 +1,153 @@
+#pragma once
+
+#include "PixelBuffer.h"
+#include "Testing/ArTest20.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief box filtered mip levels of an image; every level is half the size of the one before it
+	 *		  (rounded up, the last row or column of odd sizes is repeated), down to 1x1.
+	 *		  premultiplied pixels average correctly as they are. uses SSE2 where it's available.
+	 *		  does not depend on direct2d; Sprite uploads the levels.
+	*/
+	class MipChain
+	{
+	public:
+
+		MipChain() = delete;
+
+	public:
+
+		/**
+		 * @return the image at half the size, every pixel the rounded average of the 2x2 it covers.
+		*/
+		static PixelBuffer Downsample(PixelBuffer const& image);
+
+		/**
+		 * @brief same as Downsample, without SSE2; what the tests compare against.
+		*/
+		static PixelBuffer DownsampleScalar(PixelBuffer const& image);
+
+		/**
+		 * @return every level after image, largest first (level 1 is at index 0).
+		*/
+		static std::vector<PixelBuffer> Build(PixelBuffer const& image);
+
+		/**
+		 * @return the number of levels Build makes for an image of that size.
+		*/
+		static std::size_t LevelCount(std::size_t width, std::size_t height) noexcept;
+
+		/**
+		 * @brief the level whose texels are closest to one pixel on screen without being smaller:
+		 *		  0 down to half the size, then 1 down to a quarter, and so on.
+		 * @param scale => how much the sprite is scaled on screen (RawMatrix::AverageScale).
+		 * @param levelCount => levels available besides the full size one.
+		*/
+		static std::size_t SelectLevel(float scale, std::size_t levelCount) noexcept;
+	};
+
+	inline void TestMipChain()
+	{
+		using namespace ArTest;
+		std::ofstream file{"MipChainTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Box filter") = [&] {
+			PixelBuffer image{2U, 2U};
+			image.At(0U, 0U) = 0xFF'FF'00'00U;
+			image.At(1U, 0U) = 0xFF'00'00'00U;
+			image.At(0U, 1U) = 0x00'00'00'00U;
+			image.At(1U, 1U) = 0x80'00'00'80U;
+			auto const half{MipChain::Downsample(image)};
+			tester.PassIfEqual(half.Width(), 1U);
+			// (255 + 255 + 0 + 128 + 2) / 4 = 160 alpha, (255 + 2) / 4 = 64 red, (128 + 2) / 4 = 32 blue.
+			tester.PassIfEqual(half.At(0U, 0U), 0xA0'40'00'20U);
+		};
+
+		tester.NewTest("Odd sizes and levels") = [&] {
+			PixelBuffer image{5U, 3U, 0xFF'20'40'60U};
+			auto const levels{MipChain::Build(image)};
+			tester.PassIfEqual(levels.size(), MipChain::LevelCount(5U, 3U));
+			tester.PassIfEqual(levels.size(), 3U);
+			tester.PassIfEqual(levels[0U].Width(), 3U);
+			tester.PassIfEqual(levels[0U].Height(), 2U);
+			tester.PassIfEqual(levels[2U].Width(), 1U);
+			tester.PassIfEqual(levels[2U].Height(), 1U);
+			// a flat image stays flat.
+			tester.PassIfEqual(levels[2U].At(0U, 0U), 0xFF'20'40'60U);
+			tester.PassIfEqual(MipChain::LevelCount(1U, 1U), 0U);
+		};
+
+		tester.NewTest("SSE2 matches scalar") = [&] {
+			bool bSame{true};
+			std::uint32_t state{12345U};
+			for (std::size_t width{1U}; width < 40U; width += 3U)
+			{
+				PixelBuffer image{width, width / 2U + 1U};
+				for (auto& pixel : image.Pixels())
+				{
+					state = state * 1664525U + 1013904223U;
+					pixel = state;
+				}
+				bSame = bSame and MipChain::Downsample(image) == MipChain::DownsampleScalar(image);
+			}
+			tester.PassIf(bSame);
+		};
+
+		tester.NewTest("Level selection") = [&] {
+			tester.PassIfEqual(MipChain::SelectLevel(2.f, 5U), 0U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.75f, 5U), 0U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.5f, 5U), 1U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.3f, 5U), 1U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.2f, 5U), 2U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.001f, 5U), 5U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.f, 5U), 5U);
+			tester.PassIfEqual(MipChain::SelectLevel(0.1f, 0U), 0U);
+		};
+
+		tester.OutputResults();
+	}
+
+	/**
+	 * @brief times Downsample against DownsampleScalar on a size x size image; writes MipChainBenchmark.txt.
+	*/
+	inline void BenchmarkMipChain(std::size_t size = 1024U, std::size_t rounds = 50U)
+	{
+		std::ofstream file{"MipChainBenchmark.txt"};
+		using Ms = std::chrono::duration<double, std::milli>;
+
+		PixelBuffer image{size, size};
+		std::uint32_t state{1U};
+		for (auto& pixel : image.Pixels())
+		{
+			state = state * 1664525U + 1013904223U;
+			pixel = state;
+		}
+
+		// keeps the work from being optimized away.
+		std::uint32_t sink{};
+		auto const scalarStart{std::chrono::steady_clock::now()};
+		for (std::size_t round{}; round < rounds; ++round)
+		{
+			sink += MipChain::DownsampleScalar(image).At(0U, 0U);
+		}
+		Ms const scalarTime{std::chrono::steady_clock::now() - scalarStart};
+
+		auto const simdStart{std::chrono::steady_clock::now()};
+		for (std::size_t round{}; round < rounds; ++round)
+		{
+			sink += MipChain::Downsample(image).At(0U, 0U);
+		}
+		Ms const simdTime{std::chrono::steady_clock::now() - simdStart};
+
+		file << rounds << " downsamples of " << size << 'x' << size << '\n'
+			 << "scalar: " << scalarTime.count() << " ms\n"
+			 << "Downsample: " << simdTime.count() << " ms, speedup " << scalarTime.count() / simdTime.count() << '\n'
+			 << "(checksum " << sink << ")\n";
+	}
+}
@@ -1,12 +1,14 @@
 #include "ParticleForceRegistery.h"
 
 #include <algorithm>
+#include <numeric>
 #include <ranges>
 
 namespace Phy {
 	void ParticleForceRegistery::Add(Particle* particle, ParticleForceGenerator* forceGen)
 	{ 
 		registery_.push_back({particle, forceGen});
+		bGroupsDirty_ = true;
 	}
 
 	void ParticleForceRegistery::Remove(Particle* particle, ParticleForceGenerator* forceGen)
@@ -16,12 +18,14 @@ namespace Phy {
 			it != registery_.end())
 		{
 			registery_.erase(it);
+			bGroupsDirty_ = true;
 		}
 	}
 
 	void ParticleForceRegistery::Clear() noexcept
 	{ 
 		registery_.clear();
+		bGroupsDirty_ = true;
 	}
 
 	void ParticleForceRegistery::UpdateForces(float dt)
@@ -31,4 +35,39 @@ namespace Phy {
 			gen->UpdateForce(par, dt);
 		}
 	}
+
+	void ParticleForceRegistery::UpdateForces(float dt, ArEngine2D::JobSystem& jobs, std::size_t particlesPerJob)
+	{
+		if (bGroupsDirty_)
+		{
+			BuildGroups();
+		}
+
+		// no two jobs add forces to the same particle.
+		jobs.ParallelFor(groupStarts_.size() - 1U, [&](std::size_t group) {
+			for (auto i{groupStarts_[group]}; i < groupStarts_[group + 1U]; ++i)
+			{
+				auto const& [par, gen]{registery_[order_[i]]};
+				gen->UpdateForce(par, dt);
+			}
+		}, particlesPerJob);
+	}
+
+	void ParticleForceRegistery::BuildGroups()
+	{
+		order_.resize(registery_.size());
+		std::iota(order_.begin(), order_.end(), std::size_t{});
+		std::ranges::stable_sort(order_, std::ranges::less{}, [this](std::size_t i) { return registery_[i].Part; });
+
+		groupStarts_.clear();
+		for (std::size_t i{}; i < order_.size(); ++i)
+		{
+			if (i == 0U or registery_[order_[i]].Part != registery_[order_[i - 1U]].Part)
+			{
+				groupStarts_.push_back(i);
+			}
+		}
+		groupStarts_.push_back(order_.size());
+		bGroupsDirty_ = false;
+	}
 }
@@ -2,6 +2,7 @@
 
 #include <vector>
 #include "ParticleForceGenerator.h"
+#include "JobSystem.h"
 
 namespace Phy {
 	class Particle;
@@ -31,7 +32,20 @@ namespace Phy {
 		void Clear() noexcept;
 		void UpdateForces(float dt);
 
+		// the same, split over jobs; each particle's generators run on one job, in the order they
+		// were added, so generators may only change the particle they are given.
+		void UpdateForces(float dt, ArEngine2D::JobSystem& jobs, std::size_t particlesPerJob = 64U);
+
+	private:
+		// sorts the registerations by particle, once after every change.
+		void BuildGroups();
+
 	private:
 		Registery registery_;
+		// indices into registery_, the ones of each particle next to each other.
+		std::vector<std::size_t> order_;
+		// where every particle starts in order_, and one past the end.
+		std::vector<std::size_t> groupStarts_;
+		bool bGroupsDirty_{true};
 	};
 }
\ No newline at end of file
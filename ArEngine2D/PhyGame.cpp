@@ -6,6 +6,11 @@
 namespace Phy {
 	void PhyGame::OnUserCreate()
 	{ 
+		// the springs only behave the same at every frame rate with a fixed dt.
+		SetFixedUpdateRate(sc_UpdatesPerSecond);
+		// the draw only reads frame_, so the next frame can be simulated meanwhile.
+		SetPipelined(true);
+
 		for (std::size_t i{}; i < sc_ParticleCount; ++i)
 		{
 			parts_.emplace_back(std::make_unique<Particle>(
@@ -35,39 +40,69 @@ namespace Phy {
 	{ 
 		cam_.UpdateDrag(mouse.right);
 		cam_.UpdateZoomUsingScrollWheel();
-		reg_.UpdateForces(dt);
-		for (auto& part : parts_)
 		{
-			forceAccs_.emplace_back(part->GetForceAcc());
-			part->Integrate(dt);
+			AR2D_PROFILE_ZONE(profiler, "Forces");
+			reg_.UpdateForces(dt, jobs, sc_ParticlesPerJob);
 		}
+		AR2D_PROFILE_ZONE(profiler, "Integrate");
+		forceAccs_.resize(parts_.size());
+		prevPositions_.resize(parts_.size());
+		// every particle integrates on its own.
+		jobs.ParallelFor(parts_.size(), [&](std::size_t i) {
+			auto& part{*parts_[i]};
+			prevPositions_[i] = part.GetPos();
+			forceAccs_[i] = part.GetForceAcc();
+			part.Integrate(dt);
+		}, sc_ParticlesPerJob);
 		parts_.back()->SetPos(cam_[mouse.loc]);
+		prevPositions_.back() = parts_.back()->GetPos();
+
+		// screen space, through this step's camera.
+		auto& state{frame_.Back()};
+		state.prevCenters.clear();
+		state.centers.clear();
+		state.radii.clear();
+		for (std::size_t i{}; i < parts_.size(); ++i)
+		{
+			state.prevCenters.push_back(cam_(prevPositions_[i]));
+			state.centers.push_back(cam_(parts_[i]->GetPos()));
+			state.radii.push_back(cam_.Scale() * parts_[i]->GetMass() * 10.f);
+		}
+	}
+
+	void PhyGame::OnUserHandoff()
+	{
+		frame_.Publish();
 	}
 
 	void PhyGame::OnUserDraw(Grafix& gfx)
 	{
 		gfx.ClearScreen(Colors::DarkBlue);
 
-		for (std::size_t i{}; i < parts_.size(); ++i)
+		auto const& state{frame_.Front()};
+		if (state.centers.empty())
+		{
+			return;
+		}
+
+		centers_.clear();
+		auto const alpha{InterpolationAlpha()};
+		for (std::size_t i{}; i < state.centers.size(); ++i)
 		{
-			auto const& p{*parts_[i]};
-			auto const loc{p.GetPos()};
-			auto const mass{p.GetMass()};
-
-			gfx.DrawArrow(cam_(parts_[i]->GetPos()), cam_(parts_[(i + 1) % parts_.size()]->GetPos()), Colors::Yellow, 3.f);
-			// gfx.DrawLine(cam_(loc), cam_(parts_.back()->GetPos()), Colors::Yellow);
-			// gfx.DrawArrow(cam_(loc), cam_(loc + [&] {
-			// 	auto const myVec{parts_.back()->GetPos() - loc};
-			// 	auto const mag{myVec.Mag()};
-			// 	return myVec * std::min(mag, sc_RestLength / mag);
-			// }()), Colors::Chocolate);
-			gfx.FillCircle(cam_(loc), cam_.Scale() * mass * 10.f, Colors::Red);
-			gfx.DrawCircle(cam_(loc), cam_.Scale() * mass * 10.f, Colors::Black, 3.f);
-			// gfx.DrawArrow(cam_(loc), cam_(loc + p.GetVel()), Colors::Green, 3.f);
-			// gfx.DrawArrow(cam_(loc), cam_(loc + sc_Gravity), Colors::Pink, 3.f);
-			// gfx.DrawArrow(cam_(loc), cam_(loc + forceAccs_[i]), Colors::Maroon, 3.f);
+			auto const prev{state.prevCenters[i]};
+			centers_.push_back(prev + (state.centers[i] - prev) * alpha);
 		}
-		forceAccs_.clear();
+		// every particle is tied to the next one by a spring.
+		springEnds_.assign(centers_.begin() + 1, centers_.end());
+		springEnds_.push_back(centers_.front());
+
+		// one pass per kind of shape, however many particles there are.
+		ColorF const springColor[]{Colors::Yellow};
+		ColorF const fillColor[]{Colors::Red};
+		ColorF const strokeColor[]{Colors::Black};
+		gfx.DrawLines(centers_, springEnds_, springColor, 3.f);
+		gfx.FillCircles(centers_, state.radii, fillColor);
+		gfx.DrawCircles(centers_, state.radii, strokeColor, 3.f);
 
 		/*constexpr std::size_t CellsPerRow{8U};
 
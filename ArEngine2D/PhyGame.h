@@ -10,6 +10,7 @@
 #include "ParticleBungee.h"
 #include "ParticleGravity.h"
 #include "ParticleForceRegistery.h"
+#include "FrameState.h"
 
 namespace Phy {
 	class PhyGame : public Engine
@@ -20,6 +21,17 @@ namespace Phy {
 		constexpr static auto sc_SpringConstant{50.f};
 		constexpr static auto sc_RestLength{100.f};
 		constexpr static Vec2 sc_Gravity{0.f, 500.f};
+		constexpr static auto sc_UpdatesPerSecond{120.f};
+		// fewer than this are not worth handing to another thread.
+		constexpr static std::size_t sc_ParticlesPerJob{256};
+
+		// everything OnUserDraw needs from a step.
+		struct DrawState
+		{
+			std::vector<Vec2> prevCenters;
+			std::vector<Vec2> centers;
+			std::vector<float> radii;
+		};
 
 	public:
 
@@ -30,6 +42,7 @@ namespace Phy {
 		void OnUserCreate() override;
 		void OnUserUpdate(float dt) override;
 		void OnUserDraw(Grafix& gfx) override;
+		void OnUserHandoff() override;
 
 	private:
 		void Ex_3_5(float dt) noexcept;
@@ -41,5 +54,12 @@ namespace Phy {
 		std::vector<std::unique_ptr<Particle>> parts_{};
 		ParticleForceRegistery reg_{};
 		std::vector<Vec2> forceAccs_{};
+		// where every particle was before the last update, drawing blends towards the current ones.
+		std::vector<Vec2> prevPositions_{};
+		FrameState<DrawState> frame_{};
+
+		// screen space, refilled every frame for the instanced draws.
+		std::vector<Vec2> centers_{};
+		std::vector<Vec2> springEnds_{};
 	};
 }
\ No newline at end of file
@@ -0,0 +1,86 @@
+#include "PixelBuffer.h"
+
+#include <algorithm>
+
+namespace ArEngine2D {
+	PixelBuffer::PixelBuffer(std::size_t width, std::size_t height, std::uint32_t fill)
+		: width_{width}, height_{height}, pixels_(width * height, fill)
+	{ }
+	void PixelBuffer::Resize(std::size_t width, std::size_t height, std::uint32_t fill)
+	{
+		width_  = width;
+		height_ = height;
+		pixels_.assign(width * height, fill);
+	}
+	void PixelBuffer::Fill(std::uint32_t pixel) noexcept
+	{
+		std::ranges::fill(pixels_, pixel);
+	}
+	std::uint32_t PixelBuffer::Pack(RawColor const& color) noexcept
+	{
+		auto const toByte = [](float channel) {
+			return static_cast<std::uint32_t>(std::clamp(channel, 0.f, 1.f) * 255.f + 0.5f);
+		};
+		auto const a{std::clamp(color.a, 0.f, 1.f)};
+		return (toByte(a) << 24U) | (toByte(color.r * a) << 16U) | (toByte(color.g * a) << 8U) | toByte(color.b * a);
+	}
+	RawColor PixelBuffer::Unpack(std::uint32_t pixel) noexcept
+	{
+		auto const a{static_cast<float>(pixel >> 24U)};
+		if (a == 0.f)
+		{
+			return {0.f, 0.f, 0.f, 0.f};
+		}
+		auto const channel = [&](std::uint32_t shift) {
+			return static_cast<float>((pixel >> shift) & 0xFFU) / a;
+		};
+		return {channel(16U), channel(8U), channel(0U), a / 255.f};
+	}
+	std::uint32_t PixelBuffer::BlendOver(std::uint32_t dst, std::uint32_t src, std::uint32_t coverage) noexcept
+	{
+		// two channels at a time (0x00RR00BB and 0x00AA00GG), rounding to nearest.
+		// SoftwareRasterizer::FillSpan does the exact same math with SSE2, keep them in sync.
+		constexpr std::uint32_t Half{0x00800080U};
+		auto const srcRB{((src & 0x00FF00FFU) * coverage + Half) >> 8U & 0x00FF00FFU};
+		auto const srcAG{(((src >> 8U) & 0x00FF00FFU) * coverage + Half) >> 8U & 0x00FF00FFU};
+		auto const srcA{srcAG >> 16U};
+		auto const inv{256U - srcA - (srcA >> 7U)};
+		auto const dstRB{((dst & 0x00FF00FFU) * inv + Half) >> 8U & 0x00FF00FFU};
+		auto const dstAG{(((dst >> 8U) & 0x00FF00FFU) * inv + Half) >> 8U & 0x00FF00FFU};
+		return (srcRB + dstRB) | ((srcAG + dstAG) << 8U);
+	}
+	std::size_t PixelBuffer::Width() const noexcept
+	{
+		return width_;
+	}
+	std::size_t PixelBuffer::Height() const noexcept
+	{
+		return height_;
+	}
+	bool PixelBuffer::IsEmpty() const noexcept
+	{
+		return pixels_.empty();
+	}
+	std::span<std::uint32_t> PixelBuffer::Row(std::size_t y) noexcept
+	{
+		assert(y < height_ && "PixelBuffer row out of range");
+		return std::span{pixels_}.subspan(y * width_, width_);
+	}
+	std::span<std::uint32_t const> PixelBuffer::Row(std::size_t y) const noexcept
+	{
+		assert(y < height_ && "PixelBuffer row out of range");
+		return std::span{pixels_}.subspan(y * width_, width_);
+	}
+	std::span<std::uint32_t> PixelBuffer::Pixels() noexcept
+	{
+		return pixels_;
+	}
+	std::span<std::uint32_t const> PixelBuffer::Pixels() const noexcept
+	{
+		return pixels_;
+	}
+	std::size_t PixelBuffer::Pitch() const noexcept
+	{
+		return width_ * sizeof(std::uint32_t);
+	}
+}
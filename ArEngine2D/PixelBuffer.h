@@ -0,0 +1,91 @@
+#pragma once
+
+#include "RawTypes.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief a 2D image in memory, used by the software rendering paths.
+	 *		  every pixel is 0xAARRGGBB with premultiplied alpha, which is the same memory layout
+	 *		  as DXGI_FORMAT_B8G8R8A8_UNORM with D2D1_ALPHA_MODE_PREMULTIPLIED.
+	*/
+	class PixelBuffer
+	{
+	private:
+		using self = PixelBuffer;
+
+	public:
+
+		PixelBuffer() = default;
+		PixelBuffer(std::size_t width, std::size_t height, std::uint32_t fill = 0U);
+
+		PixelBuffer(self const&)			= default;
+		PixelBuffer(self&&) noexcept		= default;
+		self& operator=(self const&)		= default;
+		self& operator=(self&&) noexcept	= default;
+
+	public:
+
+		/**
+		 * @brief the old content is lost.
+		*/
+		void Resize(std::size_t width, std::size_t height, std::uint32_t fill = 0U);
+		void Fill(std::uint32_t pixel) noexcept;
+
+		/**
+		 * @return the premultiplied pixel of the color, each channel is clamped to [0, 1].
+		*/
+		static std::uint32_t Pack(RawColor const& color) noexcept;
+
+		/**
+		 * @return the straight alpha color of the premultiplied pixel.
+		*/
+		static RawColor Unpack(std::uint32_t pixel) noexcept;
+
+		/**
+		 * @brief source over, both pixels are premultiplied.
+		 * @param coverage => multiplies the source, 0 means dst is returned, 256 means full coverage.
+		*/
+		static std::uint32_t BlendOver(std::uint32_t dst, std::uint32_t src, std::uint32_t coverage = 256U) noexcept;
+
+	public:
+
+		std::size_t Width() const noexcept;
+		std::size_t Height() const noexcept;
+		bool IsEmpty() const noexcept;
+
+		std::uint32_t& At(std::size_t x, std::size_t y) noexcept
+		{
+			assert(x < width_ and y < height_ && "PixelBuffer index out of range");
+			return pixels_[y * width_ + x];
+		}
+
+		std::uint32_t At(std::size_t x, std::size_t y) const noexcept
+		{
+			assert(x < width_ and y < height_ && "PixelBuffer index out of range");
+			return pixels_[y * width_ + x];
+		}
+
+		std::span<std::uint32_t> Row(std::size_t y) noexcept;
+		std::span<std::uint32_t const> Row(std::size_t y) const noexcept;
+		std::span<std::uint32_t> Pixels() noexcept;
+		std::span<std::uint32_t const> Pixels() const noexcept;
+
+		/**
+		 * @return the distance in bytes between two rows.
+		*/
+		std::size_t Pitch() const noexcept;
+
+		bool operator==(self const& rhs) const noexcept = default;
+
+	private:
+		std::size_t width_{};
+		std::size_t height_{};
+		std::vector<std::uint32_t> pixels_{};
+	};
+}
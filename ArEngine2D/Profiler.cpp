@@ -0,0 +1,285 @@
+#include "Profiler.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iomanip>
+#include <sstream>
+
+namespace ArEngine2D {
+	namespace {
+		std::atomic<std::uint64_t> s_NextProfilerId{1U};
+	}
+
+	double ProfiledZone::Milliseconds() const noexcept
+	{
+		return std::chrono::duration<double, std::milli>{end - begin}.count();
+	}
+
+	Profiler::ThreadBuffer::ThreadBuffer(std::uint32_t index, std::thread::id owner, std::size_t ringSize)
+		: index{index}, owner{owner}, ring(ringSize)
+	{
+	}
+
+	Profiler::Profiler(std::size_t historyFrames, std::size_t ringSize)
+		: id_{s_NextProfilerId.fetch_add(1U)}, historyFrames_{std::max<std::size_t>(historyFrames, 1U)},
+		ringSize_{std::max<std::size_t>(ringSize, 1U)}
+	{
+	}
+	void Profiler::BeginZone(char const* name) noexcept
+	{
+		assert(name && "Profiler zones need a name");
+		auto& buffer{LocalBuffer()};
+		if (buffer.openCount == sc_MaxDepth)
+		{
+			++buffer.overflow;
+			return;
+		}
+
+		auto const bRecorded{bEnabled_.load(std::memory_order_relaxed)};
+		buffer.open[buffer.openCount++] = {bRecorded ? name : nullptr, Clock::now()};
+		buffer.depth += bRecorded ? 1U : 0U;
+	}
+	void Profiler::EndZone() noexcept
+	{
+		auto const end{Clock::now()};
+		auto& buffer{LocalBuffer()};
+		if (buffer.overflow)
+		{
+			--buffer.overflow;
+			return;
+		}
+
+		assert(buffer.openCount && "Profiler::EndZone without a BeginZone");
+		auto const& zone{buffer.open[--buffer.openCount]};
+		if (not zone.name)
+		{
+			return;
+		}
+
+		--buffer.depth;
+		auto const index{buffer.written.load(std::memory_order_relaxed)};
+		auto& slot{buffer.ring[index % buffer.ring.size()]};
+		// makes a reader that sees any of the stores below also see written == index, so it knows
+		// the slot is being overwritten.
+		std::atomic_thread_fence(std::memory_order_release);
+		slot.name.store(zone.name, std::memory_order_relaxed);
+		slot.begin.store(zone.begin.time_since_epoch().count(), std::memory_order_relaxed);
+		slot.end.store(end.time_since_epoch().count(), std::memory_order_relaxed);
+		slot.depth.store(buffer.depth, std::memory_order_relaxed);
+		buffer.written.store(index + 1U, std::memory_order_release);
+	}
+	void Profiler::SetThreadName(std::string_view name)
+	{
+		auto const& buffer{LocalBuffer()};
+		std::scoped_lock lock{buffersMutex_};
+		threadNames_[buffer.index] = name;
+	}
+	void Profiler::SetEnabled(bool bEnabled) noexcept
+	{
+		bEnabled_ = bEnabled;
+	}
+	bool Profiler::IsEnabled() const noexcept
+	{
+		return bEnabled_;
+	}
+	void Profiler::EndFrame()
+	{
+		ProfiledFrame frame{frameIndex_++, Clock::now(), {}};
+		{
+			std::scoped_lock lock{buffersMutex_};
+			for (auto const& pBuffer : buffers_)
+			{
+				Drain(*pBuffer, frame.zones);
+			}
+		}
+
+		std::unordered_map<std::string_view, double> frameMs{};
+		for (auto const& zone : frame.zones)
+		{
+			frameMs[zone.name] += zone.Milliseconds();
+		}
+		for (auto const& [name, ms] : frameMs)
+		{
+			auto& samples{stats_[name]};
+			if (samples.frameMs.size() < historyFrames_)
+			{
+				samples.frameMs.emplace_back(frame.index, ms);
+			}
+			else
+			{
+				samples.frameMs[samples.next] = {frame.index, ms};
+				samples.next = (samples.next + 1U) % historyFrames_;
+			}
+		}
+
+		frames_.push_back(std::move(frame));
+		while (frames_.size() > historyFrames_)
+		{
+			frames_.pop_front();
+		}
+	}
+	std::deque<ProfiledFrame> const& Profiler::Frames() const noexcept
+	{
+		return frames_;
+	}
+	ProfiledFrame const* Profiler::LastFrame() const noexcept
+	{
+		return frames_.empty() ? nullptr : &frames_.back();
+	}
+	std::optional<ZoneStats> Profiler::Stats(std::string_view name) const
+	{
+		auto const it{stats_.find(name)};
+		if (it == stats_.end() or frames_.empty())
+		{
+			return std::nullopt;
+		}
+
+		auto const oldest{frames_.front().index};
+		std::vector<double> ms{};
+		ms.reserve(it->second.frameMs.size());
+		for (auto const& [frame, frameMs] : it->second.frameMs)
+		{
+			if (frame >= oldest)
+			{
+				ms.push_back(frameMs);
+			}
+		}
+		if (ms.empty())
+		{
+			return std::nullopt;
+		}
+
+		std::ranges::sort(ms);
+		double sum{};
+		for (auto const value : ms)
+		{
+			sum += value;
+		}
+		auto const p99Index{static_cast<std::size_t>(std::ceil(0.99 * static_cast<double>(ms.size()))) - 1U};
+		return ZoneStats{ms.size(), ms.front(), sum / static_cast<double>(ms.size()), ms.back(), ms[p99Index]};
+	}
+	std::string Profiler::Report() const
+	{
+		auto const* pFrame{LastFrame()};
+		if (not pFrame)
+		{
+			return {};
+		}
+
+		auto const names{ThreadNames()};
+		std::ostringstream report{};
+		report << "frame " << pFrame->index << ": zone, ms, then min/avg/max/p99 over " << frames_.size()
+			   << " frames\n" << std::fixed << std::setprecision(3);
+		for (auto const& zone : pFrame->zones)
+		{
+			auto const stats{*Stats(zone.name)};
+			report << std::setw(10) << names[zone.thread] << ' ' << std::string(2U * zone.depth, ' ') << zone.name
+				   << ' ' << zone.Milliseconds() << " (" << stats.minMs << '/' << stats.avgMs << '/' << stats.maxMs
+				   << '/' << stats.p99Ms << ")\n";
+		}
+		return std::move(report).str();
+	}
+	std::vector<std::string> Profiler::ThreadNames() const
+	{
+		std::scoped_lock lock{buffersMutex_};
+		return threadNames_;
+	}
+	std::uint64_t Profiler::DroppedZones() const noexcept
+	{
+		return droppedZones_.load();
+	}
+	Profiler::ThreadBuffer& Profiler::LocalBuffer()
+	{
+		// the buffer of the profiler this thread used last.
+		thread_local std::uint64_t t_ProfilerId{};
+		thread_local ThreadBuffer* t_pBuffer{};
+		if (t_ProfilerId == id_)
+		{
+			return *t_pBuffer;
+		}
+
+		std::scoped_lock lock{buffersMutex_};
+		auto const owner{std::this_thread::get_id()};
+		auto const it{std::ranges::find(buffers_, owner, [](auto const& pBuffer) { return pBuffer->owner; })};
+		if (it != buffers_.end())
+		{
+			t_pBuffer = it->get();
+		}
+		else
+		{
+			auto const index{static_cast<std::uint32_t>(buffers_.size())};
+			t_pBuffer = buffers_.emplace_back(std::make_unique<ThreadBuffer>(index, owner, ringSize_)).get();
+			threadNames_.push_back("Thread " + std::to_string(index));
+		}
+		t_ProfilerId = id_;
+		return *t_pBuffer;
+	}
+	void Profiler::Drain(ThreadBuffer& buffer, std::vector<ProfiledZone>& zones)
+	{
+		auto const written{buffer.written.load(std::memory_order_acquire)};
+		auto const size{buffer.ring.size()};
+		auto first{buffer.read};
+		if (written - first > size)
+		{
+			droppedZones_.fetch_add(written - size - first);
+			first = written - size;
+		}
+
+		auto const start{zones.size()};
+		for (auto i{first}; i < written; ++i)
+		{
+			auto const& slot{buffer.ring[i % size]};
+			zones.push_back({
+				slot.name.load(std::memory_order_relaxed), buffer.index, slot.depth.load(std::memory_order_relaxed), -1,
+				Clock::time_point{Clock::duration{slot.begin.load(std::memory_order_relaxed)}},
+				Clock::time_point{Clock::duration{slot.end.load(std::memory_order_relaxed)}}
+			});
+		}
+		buffer.read = written;
+
+		// the thread may have lapped the ring while it was being read; what it could have
+		// overwritten is thrown away.
+		std::atomic_thread_fence(std::memory_order_acquire);
+		auto const now{buffer.written.load(std::memory_order_relaxed)};
+		if (now >= size and now - size + 1U > first)
+		{
+			auto const torn{std::min<std::uint64_t>(now - size + 1U - first, written - first)};
+			zones.erase(zones.begin() + static_cast<std::ptrdiff_t>(start),
+				zones.begin() + static_cast<std::ptrdiff_t>(start + torn));
+			droppedZones_.fetch_add(torn);
+		}
+
+		std::span<ProfiledZone> const threadZones{zones.begin() + static_cast<std::ptrdiff_t>(start), zones.end()};
+		LinkParents(threadZones, static_cast<std::int32_t>(start));
+	}
+	void Profiler::LinkParents(std::span<ProfiledZone> zones, std::int32_t offset)
+	{
+		// zones end before the ones around them, so they were recorded inside out.
+		std::ranges::sort(zones, [](ProfiledZone const& lhs, ProfiledZone const& rhs) {
+			return lhs.begin != rhs.begin ? lhs.begin < rhs.begin : lhs.depth < rhs.depth;
+		});
+
+		// the last zone seen at every depth.
+		std::vector<std::int32_t> open{};
+		for (std::size_t i{}; i < zones.size(); ++i)
+		{
+			auto& zone{zones[i]};
+			if (open.size() < zone.depth + 1U)
+			{
+				open.resize(zone.depth + 1U, -1);
+			}
+			if (zone.depth > 0U)
+			{
+				// a parent that was still open at the end of the frame is not in it.
+				auto const parent{open[zone.depth - 1U]};
+				if (parent >= 0 and zones[static_cast<std::size_t>(parent)].end >= zone.end)
+				{
+					zone.parent = parent + offset;
+				}
+			}
+			open[zone.depth] = static_cast<std::int32_t>(i);
+			open.resize(zone.depth + 1U);
+		}
+	}
+}
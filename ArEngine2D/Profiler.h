@@ -0,0 +1,351 @@
+#pragma once
+
+#include "ISingle.h"
+#include "Testing/ArTest20.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief one zone of a frame, as Profiler::EndFrame put it together.
+	*/
+	struct ProfiledZone
+	{
+		using Clock = std::chrono::steady_clock;
+
+		char const* name;
+		// index into Profiler::ThreadNames.
+		std::uint32_t thread;
+		// 0 for zones that were not inside another one.
+		std::uint32_t depth;
+		// index of the enclosing zone in the same frame, -1 if there is none (or it was still open).
+		std::int32_t parent;
+		Clock::time_point begin;
+		Clock::time_point end;
+
+		double Milliseconds() const noexcept;
+	};
+
+	/**
+	 * @brief every zone that ended between two calls to Profiler::EndFrame, in order of thread, then start.
+	*/
+	struct ProfiledFrame
+	{
+		std::uint64_t index;
+		ProfiledZone::Clock::time_point end;
+		std::vector<ProfiledZone> zones;
+	};
+
+	/**
+	 * @brief the time a zone took per frame (every instance of it added up), over the kept frames it ran in.
+	*/
+	struct ZoneStats
+	{
+		std::size_t frames;
+		double minMs;
+		double avgMs;
+		double maxMs;
+		double p99Ms;
+	};
+
+	/**
+	 * @brief records named zones from any thread, and puts them together once per frame.
+	 *		  a zone only writes into a ring buffer owned by its thread (no locks, no allocations), so
+	 *		  it costs about two clock reads. EndFrame, on the other hand, takes what every thread
+	 *		  recorded since the last call, nests it into parent and child zones, and keeps rolling
+	 *		  statistics per zone name; it and everything that reads frames or statistics belong to
+	 *		  one thread (the engine's main one).
+	 *
+	 *		  zone names are not copied, they must be string literals (or live as long as the profiler).
+	 *		  a thread that records more zones than its ring holds between two frames loses the oldest.
+	 *		  uses the same clock as Timer.
+	*/
+	class Profiler : Details::ISingle
+	{
+	public:
+
+		using Clock = ProfiledZone::Clock;
+
+		constexpr static std::size_t sc_DefaultHistory{120U};
+		constexpr static std::size_t sc_DefaultRingSize{1U << 14U};
+		// zones nested deeper than this are not recorded.
+		constexpr static std::size_t sc_MaxDepth{64U};
+
+	public:
+
+		/**
+		 * @param historyFrames => the frames kept, and the frames the statistics go over.
+		 * @param ringSize => the zones every thread can record between two frames.
+		*/
+		explicit Profiler(std::size_t historyFrames = sc_DefaultHistory, std::size_t ringSize = sc_DefaultRingSize);
+
+	public:
+
+		/**
+		 * @brief starts a zone on the calling thread; every BeginZone needs an EndZone (see ProfileZone).
+		*/
+		void BeginZone(char const* name) noexcept;
+		void EndZone() noexcept;
+
+		/**
+		 * @brief names the calling thread, for reports and traces.
+		*/
+		void SetThreadName(std::string_view name);
+
+		/**
+		 * @brief zones that begin while disabled are not recorded; enabled by default.
+		*/
+		void SetEnabled(bool bEnabled) noexcept;
+		bool IsEnabled() const noexcept;
+
+		/**
+		 * @brief collects every zone that ended since the last call into a new frame.
+		*/
+		void EndFrame();
+
+	public:
+
+		/**
+		 * @return the kept frames, oldest first.
+		*/
+		std::deque<ProfiledFrame> const& Frames() const noexcept;
+
+		/**
+		 * @return nullptr before the first EndFrame.
+		*/
+		ProfiledFrame const* LastFrame() const noexcept;
+
+		/**
+		 * @return nothing if no zone with that name ran in the kept frames.
+		*/
+		std::optional<ZoneStats> Stats(std::string_view name) const;
+
+		/**
+		 * @return one line per zone of the last frame, indented by depth, with its statistics.
+		*/
+		std::string Report() const;
+
+		/**
+		 * @return indexed by ProfiledZone::thread.
+		*/
+		std::vector<std::string> ThreadNames() const;
+
+		/**
+		 * @return zones that were lost because a ring was full.
+		*/
+		std::uint64_t DroppedZones() const noexcept;
+
+	private:
+
+		struct Slot
+		{
+			std::atomic<char const*> name{};
+			std::atomic<Clock::rep> begin{};
+			std::atomic<Clock::rep> end{};
+			std::atomic<std::uint32_t> depth{};
+		};
+
+		struct OpenZone
+		{
+			// nullptr if it's not recorded.
+			char const* name;
+			Clock::time_point begin;
+		};
+
+		// written by its thread only; read by EndFrame.
+		struct ThreadBuffer
+		{
+			ThreadBuffer(std::uint32_t index, std::thread::id owner, std::size_t ringSize);
+
+			std::uint32_t const index;
+			std::thread::id const owner;
+			std::vector<Slot> ring;
+			std::atomic<std::uint64_t> written{};
+			// EndFrame's side.
+			std::uint64_t read{};
+			// the thread's side.
+			std::array<OpenZone, sc_MaxDepth> open{};
+			std::uint32_t openCount{};
+			// the recorded zones in open.
+			std::uint32_t depth{};
+			// zones that began past sc_MaxDepth and have not ended yet.
+			std::uint32_t overflow{};
+		};
+
+		// the time of a zone in the frames it ran in, a ring of historyFrames_.
+		struct Samples
+		{
+			std::vector<std::pair<std::uint64_t, double>> frameMs{};
+			std::size_t next{};
+		};
+
+	private:
+		ThreadBuffer& LocalBuffer();
+		void Drain(ThreadBuffer& buffer, std::vector<ProfiledZone>& zones);
+		// sorts the zones of one thread, and points them at their parents (offset is where they start in the frame).
+		static void LinkParents(std::span<ProfiledZone> zones, std::int32_t offset);
+
+	private:
+		// tells the thread local caches of different profilers apart.
+		std::uint64_t const id_;
+		std::size_t const historyFrames_;
+		std::size_t const ringSize_;
+		std::atomic<bool> bEnabled_{true};
+		std::atomic<std::uint64_t> droppedZones_{};
+
+		mutable std::mutex buffersMutex_{};
+		std::vector<std::unique_ptr<ThreadBuffer>> buffers_{};
+		std::vector<std::string> threadNames_{};
+
+		std::uint64_t frameIndex_{};
+		std::deque<ProfiledFrame> frames_{};
+		std::unordered_map<std::string_view, Samples> stats_{};
+	};
+
+	/**
+	 * @brief a zone from construction to destruction.
+	*/
+	class ProfileZone : Details::ISingle
+	{
+	public:
+
+		ProfileZone(Profiler& profiler, char const* name) noexcept : profiler_{profiler}
+		{
+			profiler_.BeginZone(name);
+		}
+		~ProfileZone()
+		{
+			profiler_.EndZone();
+		}
+
+	private:
+		Profiler& profiler_;
+	};
+
+#define AR2D_PROFILE_CONCAT_IMPL(_a, _b) _a##_b
+#define AR2D_PROFILE_CONCAT(_a, _b) AR2D_PROFILE_CONCAT_IMPL(_a, _b)
+#ifdef AR2D_NO_PROFILING
+#define AR2D_PROFILE_ZONE(_profiler, _name)
+#else
+	// times the rest of the enclosing scope as a zone.
+#define AR2D_PROFILE_ZONE(_profiler, _name) \
+	::ArEngine2D::ProfileZone const AR2D_PROFILE_CONCAT(profileZone_, __LINE__){_profiler, _name}
+#endif
+
+	inline void TestProfiler()
+	{
+		using namespace ArTest;
+		std::ofstream file{"ProfilerTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Zones nest") = [&] {
+			Profiler profiler{};
+			{
+				ProfileZone outer{profiler, "Outer"};
+				{
+					ProfileZone inner{profiler, "Inner"};
+				}
+				{
+					ProfileZone inner{profiler, "Inner"};
+					ProfileZone innermost{profiler, "Innermost"};
+				}
+			}
+			profiler.EndFrame();
+
+			auto const& zones{profiler.LastFrame()->zones};
+			tester.PassIfEqual(zones.size(), std::size_t{4U});
+			tester.PassIfEqual(std::string_view{zones[0U].name}, std::string_view{"Outer"});
+			tester.PassIfEqual(zones[0U].parent, std::int32_t{-1});
+			tester.PassIfEqual(zones[1U].parent, std::int32_t{0});
+			tester.PassIfEqual(zones[2U].parent, std::int32_t{0});
+			tester.PassIfEqual(zones[3U].parent, std::int32_t{2});
+			tester.PassIfEqual(zones[3U].depth, std::uint32_t{2U});
+			tester.PassIf(zones[0U].begin <= zones[1U].begin and zones[3U].end <= zones[0U].end);
+			tester.PassIfEqual(std::size_t{profiler.Stats("Inner")->frames}, std::size_t{1U});
+		};
+
+		tester.NewTest("Statistics roll") = [&] {
+			Profiler rolling{4U};
+			for (int frame{}; frame < 10; ++frame)
+			{
+				{
+					ProfileZone zone{rolling, "Sleep"};
+					std::this_thread::sleep_for(std::chrono::milliseconds{frame < 6 ? 1 : 3});
+				}
+				rolling.EndFrame();
+			}
+			auto const stats{rolling.Stats("Sleep")};
+			tester.PassIf(stats.has_value());
+			tester.PassIfEqual(stats->frames, std::size_t{4U});
+			// only the last four frames, which all slept 3 ms.
+			tester.PassIfGreaterEq(stats->minMs, double{2.9});
+			tester.PassIf(stats->minMs <= stats->avgMs and stats->avgMs <= stats->p99Ms and stats->p99Ms <= stats->maxMs);
+			tester.PassIfEqual(rolling.Frames().size(), std::size_t{4U});
+			tester.PassIf(not rolling.Stats("Missing").has_value());
+			tester.PassIf(not rolling.Report().empty());
+		};
+
+		tester.NewTest("Threads and full rings") = [&] {
+			Profiler profiler{8U, 64U};
+			profiler.SetThreadName("Main");
+			std::thread worker{[&] {
+				profiler.SetThreadName("Worker");
+				for (int i{}; i < 100; ++i)
+				{
+					AR2D_PROFILE_ZONE(profiler, "Work");
+				}
+			}};
+			worker.join();
+			{
+				AR2D_PROFILE_ZONE(profiler, "Main zone");
+			}
+			profiler.EndFrame();
+
+			auto const names{profiler.ThreadNames()};
+			tester.PassIfEqual(names.size(), std::size_t{2U});
+			std::size_t workZones{};
+			bool bRightThread{true};
+			for (auto const& zone : profiler.LastFrame()->zones)
+			{
+				if (std::string_view{zone.name} == "Work")
+				{
+					++workZones;
+					bRightThread = bRightThread and names[zone.thread] == "Worker";
+				}
+			}
+			// the ring holds 64, and the oldest of those is where the thread would write next, which
+			// can not be trusted; the rest are counted as dropped.
+			tester.PassIfEqual(std::size_t{workZones}, std::size_t{63U});
+			tester.PassIf(bRightThread);
+			tester.PassIfEqual(profiler.DroppedZones(), std::uint64_t{37U});
+		};
+
+		tester.NewTest("Disabled zones") = [&] {
+			Profiler profiler{};
+			profiler.SetEnabled(false);
+			{
+				ProfileZone zone{profiler, "Off"};
+				profiler.SetEnabled(true);
+				ProfileZone inner{profiler, "On"};
+			}
+			profiler.EndFrame();
+			tester.PassIfEqual(profiler.LastFrame()->zones.size(), std::size_t{1U});
+			tester.PassIfEqual(profiler.LastFrame()->zones[0U].depth, std::uint32_t{0U});
+		};
+
+		tester.OutputResults();
+	}
+}
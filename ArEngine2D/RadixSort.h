@@ -0,0 +1,109 @@
+#pragma once
+
+#include "Testing/ArTest20.h"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ArEngine2D::Details {
+	/**
+	 * @brief stable LSD radix sort of 64 bit keys, a byte per pass. bytes that are the same in every
+	 *		  key skip their pass, so narrow keys (few layers, few states) only cost a pass or two.
+	*/
+	class RadixSort
+	{
+	public:
+
+		RadixSort() = delete;
+
+	public:
+
+		/**
+		 * @brief sorts the keys ascending, moving every value along with its key.
+		 * @param keysScratch, valuesScratch => resized as needed; keep them around to avoid allocating every call.
+		*/
+		static void Sort(std::vector<std::uint64_t>& keys, std::vector<std::uint32_t>& values,
+			std::vector<std::uint64_t>& keysScratch, std::vector<std::uint32_t>& valuesScratch)
+		{
+			assert(keys.size() == values.size() && "Every key needs a value");
+			auto const count{keys.size()};
+			if (count < 2U)
+			{
+				return;
+			}
+
+			// all eight histograms in a single read of the keys.
+			std::array<std::array<std::size_t, 256U>, 8U> counts{};
+			for (auto const key : keys)
+			{
+				for (std::size_t pass{}; pass < 8U; ++pass)
+				{
+					++counts[pass][(key >> (pass * 8U)) & 0xFFU];
+				}
+			}
+
+			keysScratch.resize(count);
+			valuesScratch.resize(count);
+			for (std::size_t pass{}; pass < 8U; ++pass)
+			{
+				auto const shift{pass * 8U};
+				auto& passCounts{counts[pass]};
+				if (passCounts[(keys.front() >> shift) & 0xFFU] == count)
+				{
+					continue;
+				}
+
+				std::size_t offset{};
+				for (auto& bucket : passCounts)
+				{
+					offset += std::exchange(bucket, offset);
+				}
+				for (std::size_t i{}; i < count; ++i)
+				{
+					auto const dst{passCounts[(keys[i] >> shift) & 0xFFU]++};
+					keysScratch[dst]   = keys[i];
+					valuesScratch[dst] = values[i];
+				}
+				keys.swap(keysScratch);
+				values.swap(valuesScratch);
+			}
+		}
+	};
+
+	inline void TestRadixSort()
+	{
+		using namespace ArTest;
+		std::ofstream file{"RadixSortTestResults.txt"};
+		Tester tester{file};
+
+		std::vector<std::uint64_t> keysScratch{};
+		std::vector<std::uint32_t> valuesScratch{};
+
+		tester.NewTest("Sorted and stable") = [&] {
+			std::vector<std::uint64_t> keys{5U, 0xFF00'0000'0000'0001U, 5U, 0U, 0x100U, 5U};
+			std::vector<std::uint32_t> values{0U, 1U, 2U, 3U, 4U, 5U};
+			RadixSort::Sort(keys, values, keysScratch, valuesScratch);
+
+			tester.PassIf(std::is_sorted(keys.begin(), keys.end()));
+			tester.PassIf(values == std::vector<std::uint32_t>{3U, 0U, 2U, 5U, 4U, 1U});
+		};
+
+		tester.NewTest("Equal keys stay put") = [&] {
+			std::vector<std::uint64_t> keys(100U, 0xABCDU);
+			std::vector<std::uint32_t> values(100U);
+			for (std::uint32_t i{}; i < values.size(); ++i)
+			{
+				values[i] = i;
+			}
+			RadixSort::Sort(keys, values, keysScratch, valuesScratch);
+			tester.PassIf(std::is_sorted(values.begin(), values.end()));
+		};
+
+		tester.OutputResults();
+	}
+}
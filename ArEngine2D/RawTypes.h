@@ -0,0 +1,174 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+
+// plain data versions of the direct2d types, used by the parts of the renderer that
+// have to build (and be tested) without any windows headers.
+// the memory layouts match D2D1_POINT_2F, D2D1_RECT_F, D2D1_COLOR_F and D2D1_MATRIX_3X2_F.
+
+namespace ArEngine2D {
+	struct RawPoint
+	{
+		float x;
+		float y;
+
+		constexpr bool operator==(RawPoint const& rhs) const noexcept = default;
+	};
+
+	struct RawRect
+	{
+		float left;
+		float top;
+		float right;
+		float bottom;
+
+		constexpr bool operator==(RawRect const& rhs) const noexcept = default;
+
+		constexpr float Width() const noexcept
+		{ return right - left; }
+
+		constexpr float Height() const noexcept
+		{ return bottom - top; }
+
+		constexpr bool IsEmpty() const noexcept
+		{ return right <= left or bottom <= top; }
+
+		/**
+		 * @return true if the two rectangles share any area.
+		*/
+		constexpr bool Intersects(RawRect const& rhs) const noexcept
+		{ return left < rhs.right and rhs.left < right and top < rhs.bottom and rhs.top < bottom; }
+
+		/**
+		 * @return the overlapping part of the two rectangles (may be empty).
+		*/
+		constexpr RawRect Intersection(RawRect const& rhs) const noexcept
+		{
+			return {
+				std::max(left, rhs.left), std::max(top, rhs.top),
+				std::min(right, rhs.right), std::min(bottom, rhs.bottom)
+			};
+		}
+
+		/**
+		 * @return the smallest rectangle containing both rectangles.
+		*/
+		constexpr RawRect Union(RawRect const& rhs) const noexcept
+		{
+			if (IsEmpty()) return rhs;
+			if (rhs.IsEmpty()) return *this;
+			return {
+				std::min(left, rhs.left), std::min(top, rhs.top),
+				std::max(right, rhs.right), std::max(bottom, rhs.bottom)
+			};
+		}
+
+		/**
+		 * @return the same rectangle grown by amount in every direction.
+		*/
+		constexpr RawRect Inflated(float amount) const noexcept
+		{ return {left - amount, top - amount, right + amount, bottom + amount}; }
+	};
+
+	struct RawColor
+	{
+		float r;
+		float g;
+		float b;
+		float a;
+
+		constexpr bool operator==(RawColor const& rhs) const noexcept = default;
+	};
+
+	/**
+	 * @brief same convention as D2D1::Matrix3x2F; points are row vectors,
+	 *		  so (lhs * rhs) applies lhs first then rhs.
+	*/
+	struct RawMatrix
+	{
+		float m11;
+		float m12;
+		float m21;
+		float m22;
+		float dx;
+		float dy;
+
+		constexpr bool operator==(RawMatrix const& rhs) const noexcept = default;
+
+		constexpr static RawMatrix Identity() noexcept
+		{ return {1.f, 0.f, 0.f, 1.f, 0.f, 0.f}; }
+
+		constexpr static RawMatrix Translation(float x, float y) noexcept
+		{ return {1.f, 0.f, 0.f, 1.f, x, y}; }
+
+		constexpr RawMatrix operator*(RawMatrix const& rhs) const noexcept
+		{
+			return {
+				m11 * rhs.m11 + m12 * rhs.m21,
+				m11 * rhs.m12 + m12 * rhs.m22,
+				m21 * rhs.m11 + m22 * rhs.m21,
+				m21 * rhs.m12 + m22 * rhs.m22,
+				dx * rhs.m11 + dy * rhs.m21 + rhs.dx,
+				dx * rhs.m12 + dy * rhs.m22 + rhs.dy,
+			};
+		}
+
+		constexpr RawPoint Apply(RawPoint const& point) const noexcept
+		{ return {point.x * m11 + point.y * m21 + dx, point.x * m12 + point.y * m22 + dy}; }
+
+		constexpr float Determinant() const noexcept
+		{ return m11 * m22 - m12 * m21; }
+
+		constexpr bool IsInvertible() const noexcept
+		{ return Determinant() != 0.f; }
+
+		/**
+		 * @brief calling this on an uninvertible matrix is undefined.
+		*/
+		constexpr RawMatrix Inverted() const noexcept
+		{
+			auto const invDet{1.f / Determinant()};
+			RawMatrix const inv{
+				m22 * invDet, -m12 * invDet,
+				-m21 * invDet, m11 * invDet,
+				0.f, 0.f
+			};
+			auto const t{inv.Apply({dx, dy})};
+			return {inv.m11, inv.m12, inv.m21, inv.m22, -t.x, -t.y};
+		}
+
+		/**
+		 * @return true if the matrix only scales and translates (rectangles stay axis aligned).
+		*/
+		constexpr bool IsAxisAligned() const noexcept
+		{ return m12 == 0.f and m21 == 0.f; }
+
+		/**
+		 * @return the axis aligned bounding box of the transformed rectangle.
+		*/
+		constexpr RawRect ApplyToRect(RawRect const& rect) const noexcept
+		{
+			RawPoint const corners[]{
+				Apply({rect.left, rect.top}), Apply({rect.right, rect.top}),
+				Apply({rect.right, rect.bottom}), Apply({rect.left, rect.bottom}),
+			};
+			RawRect res{corners[0].x, corners[0].y, corners[0].x, corners[0].y};
+			for (auto const& corner : corners)
+			{
+				res.left   = std::min(res.left, corner.x);
+				res.top    = std::min(res.top, corner.y);
+				res.right  = std::max(res.right, corner.x);
+				res.bottom = std::max(res.bottom, corner.y);
+			}
+			return res;
+		}
+
+		/**
+		 * @return how much the matrix scales lengths on average (sqrt of the area scale).
+		*/
+		float AverageScale() const noexcept
+		{ return std::sqrt(std::abs(Determinant())); }
+	};
+}
@@ -50,7 +50,7 @@ public:
 	void SetDeathCallBack(CallBack callback)
 	{
 		AR2D_ASSERT(callback, "Tried to set ScopedTimer death call back to empty function");
-		callbackFunc_ = std::move(callbackFunc_);
+		callbackFunc_ = std::move(callback);
 	}
 
 private:
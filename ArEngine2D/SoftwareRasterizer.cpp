@@ -0,0 +1,607 @@
+#include "SoftwareRasterizer.h"
+
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <iterator>
+#include <limits>
+#include <mutex>
+#include <numbers>
+
+#if defined(__SSE2__) or defined(_M_X64) or (defined(_M_IX86_FP) and _M_IX86_FP >= 2)
+#define AR2D_RASTERIZER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace ArEngine2D {
+	namespace {
+		struct PixelRange
+		{
+			int first;
+			int last;
+
+			constexpr bool IsEmpty() const noexcept
+			{ return last <= first; }
+		};
+
+		// the pixels whose centers are inside [from, to), limited to [lo, hi).
+		PixelRange CentersIn(float from, float to, int lo, int hi) noexcept
+		{
+			return {
+				std::max(static_cast<int>(std::ceil(from - 0.5f)), lo),
+				std::min(static_cast<int>(std::ceil(to - 0.5f)), hi)
+			};
+		}
+
+		struct PixelRect
+		{
+			int left;
+			int top;
+			int right;
+			int bottom;
+		};
+
+		PixelRect ClipOf(RawRect const& clip, PixelBuffer const& target) noexcept
+		{
+			auto const cols{CentersIn(clip.left, clip.right, 0, static_cast<int>(target.Width()))};
+			auto const rows{CentersIn(clip.top, clip.bottom, 0, static_cast<int>(target.Height()))};
+			return {cols.first, rows.first, cols.last, rows.last};
+		}
+	}
+
+	void SoftwareRasterizer::Render(DrawCommandBuffer const& buffer, PixelBuffer& target, std::span<PixelBuffer const* const> images)
+	{
+		RenderClipped(buffer, target, images, {
+			0.f, 0.f, static_cast<float>(target.Width()), static_cast<float>(target.Height())
+		});
+	}
+	void SoftwareRasterizer::RenderClipped(DrawCommandBuffer const& buffer, PixelBuffer& target, std::span<PixelBuffer const* const> images, RawRect const& clip)
+	{
+		for (auto const& cmd : buffer.Commands())
+		{
+			++stats_.commands;
+			RasterizeCommand(buffer, cmd, target, images, clip);
+		}
+	}
+	void SoftwareRasterizer::RenderTiled(DrawCommandBuffer const& buffer, PixelBuffer& target, std::span<PixelBuffer const* const> images,
+		JobSystem& jobs, std::uint32_t tileSize)
+	{
+		assert(tileSize > 0U && "Tile size must not be zero");
+		auto const commands{buffer.Commands()};
+		auto const tilesX{(target.Width() + tileSize - 1U) / tileSize};
+		auto const tilesY{(target.Height() + tileSize - 1U) / tileSize};
+		auto const tileCount{tilesX * tilesY};
+		stats_.commands += commands.size();
+		stats_.tiles += tileCount;
+		if (tileCount == 0U)
+		{
+			return;
+		}
+
+		// the tiles a rectangle touches; the last ones are exclusive.
+		RawRect const full{0.f, 0.f, static_cast<float>(target.Width()), static_cast<float>(target.Height())};
+		auto const tileRange = [&](RawRect const& bounds) {
+			auto const pixels{ClipOf(bounds, target)};
+			return PixelRect{
+				pixels.left / static_cast<int>(tileSize), pixels.top / static_cast<int>(tileSize),
+				(pixels.right + static_cast<int>(tileSize) - 1) / static_cast<int>(tileSize),
+				(pixels.bottom + static_cast<int>(tileSize) - 1) / static_cast<int>(tileSize),
+			};
+		};
+
+		// binning is two passes (count, then fill), so every tile's list is one contiguous range.
+		commandBounds_.clear();
+		tileOffsets_.assign(tileCount + 1U, 0U);
+		for (auto const& cmd : commands)
+		{
+			// text is not drawn here, so it's counted once instead of once per tile.
+			auto const bText{cmd.kind == DrawCommandKind::Text};
+			stats_.skippedCommands += bText;
+			auto const& bounds{commandBounds_.emplace_back(bText ? RawRect{} : DeviceBounds(buffer, cmd).Intersection(full))};
+			if (bounds.IsEmpty())
+			{
+				continue;
+			}
+			auto const range{tileRange(bounds)};
+			for (auto ty{range.top}; ty < range.bottom; ++ty)
+			{
+				for (auto tx{range.left}; tx < range.right; ++tx)
+				{
+					++tileOffsets_[static_cast<std::size_t>(ty) * tilesX + static_cast<std::size_t>(tx) + 1U];
+				}
+			}
+		}
+		for (std::size_t i{1U}; i <= tileCount; ++i)
+		{
+			tileOffsets_[i] += tileOffsets_[i - 1U];
+		}
+
+		tileCommands_.resize(tileOffsets_.back());
+		stats_.binnedCommands += tileCommands_.size();
+		// the offsets are moved forward while filling, then moved back by one tile.
+		for (std::uint32_t c{}, lim{static_cast<std::uint32_t>(commands.size())}; c < lim; ++c)
+		{
+			if (commandBounds_[c].IsEmpty())
+			{
+				continue;
+			}
+			auto const range{tileRange(commandBounds_[c])};
+			for (auto ty{range.top}; ty < range.bottom; ++ty)
+			{
+				for (auto tx{range.left}; tx < range.right; ++tx)
+				{
+					tileCommands_[tileOffsets_[static_cast<std::size_t>(ty) * tilesX + static_cast<std::size_t>(tx)]++] = c;
+				}
+			}
+		}
+		std::shift_right(tileOffsets_.begin(), tileOffsets_.end(), 1);
+		tileOffsets_.front() = 0U;
+
+		// ThreadIndex can not pick them, every thread that is not a worker is 0 (the engine's update
+		// thread helping with its own jobs meanwhile, say); a tile takes whichever one is free instead.
+		while (tileRasterizers_.size() < jobs.ThreadCount())
+		{
+			tileRasterizers_.push_back(std::make_unique<SoftwareRasterizer>());
+		}
+		freeTileRasterizers_.clear();
+		for (auto const& pRasterizer : tileRasterizers_)
+		{
+			pRasterizer->ResetStats();
+			freeTileRasterizers_.push_back(pRasterizer.get());
+		}
+		std::mutex freeMutex{};
+
+		jobs.ParallelFor(tileCount, [&](std::size_t tile) {
+			auto const indices{std::span{tileCommands_}.subspan(tileOffsets_[tile], tileOffsets_[tile + 1U] - tileOffsets_[tile])};
+			if (indices.empty())
+			{
+				return;
+			}
+
+			auto const tx{static_cast<float>(tile % tilesX * tileSize)};
+			auto const ty{static_cast<float>(tile / tilesX * tileSize)};
+			RawRect const clip{tx, ty, tx + static_cast<float>(tileSize), ty + static_cast<float>(tileSize)};
+			SoftwareRasterizer* pRasterizer{};
+			{
+				std::scoped_lock lock{freeMutex};
+				if (freeTileRasterizers_.empty())
+				{
+					// more threads than the job system has are helping; only happens once.
+					pRasterizer = tileRasterizers_.emplace_back(std::make_unique<SoftwareRasterizer>()).get();
+				}
+				else
+				{
+					pRasterizer = freeTileRasterizers_.back();
+					freeTileRasterizers_.pop_back();
+				}
+			}
+			for (auto const c : indices)
+			{
+				pRasterizer->RasterizeCommand(buffer, commands[c], target, images, clip);
+			}
+			std::scoped_lock lock{freeMutex};
+			freeTileRasterizers_.push_back(pRasterizer);
+		});
+
+		for (auto const& pRasterizer : tileRasterizers_)
+		{
+			stats_.spans  += pRasterizer->stats_.spans;
+			stats_.pixels += pRasterizer->stats_.pixels;
+		}
+	}
+	RawRect SoftwareRasterizer::DeviceBounds(DrawCommandBuffer const& buffer, DrawCommand const& cmd) noexcept
+	{
+		constexpr auto inf{std::numeric_limits<float>::infinity()};
+		auto const& transform{buffer.TransformOf(cmd)};
+		auto const halfThick{cmd.data[4] * 0.5f};
+		RawRect local{};
+		switch (cmd.kind)
+		{
+		case DrawCommandKind::Clear:
+			return {-inf, -inf, inf, inf};
+		case DrawCommandKind::Line:
+		{
+			auto const from{cmd.Point(0)};
+			auto const to{cmd.Point(1)};
+			local = RawRect{
+				std::min(from.x, to.x), std::min(from.y, to.y), std::max(from.x, to.x), std::max(from.y, to.y)
+			}.Inflated(halfThick);
+			break;
+		}
+		case DrawCommandKind::FillEllipse:
+		case DrawCommandKind::DrawEllipse:
+		{
+			auto const center{cmd.Point(0)};
+			auto const grow{cmd.kind == DrawCommandKind::DrawEllipse ? halfThick : 0.f};
+			local = {
+				center.x - cmd.data[2] - grow, center.y - cmd.data[3] - grow,
+				center.x + cmd.data[2] + grow, center.y + cmd.data[3] + grow
+			};
+			break;
+		}
+		case DrawCommandKind::FillRectangle:
+			local = cmd.RectAt(0);
+			break;
+		case DrawCommandKind::DrawRectangle:
+			local = cmd.RectAt(0).Inflated(halfThick);
+			break;
+		case DrawCommandKind::FillPolygon:
+		case DrawCommandKind::DrawPolygon:
+		{
+			auto const verts{buffer.VerticesOf(cmd)};
+			if (verts.empty())
+			{
+				return {};
+			}
+			local = {verts.front().x, verts.front().y, verts.front().x, verts.front().y};
+			for (auto const& vert : verts)
+			{
+				local = {
+					std::min(local.left, vert.x), std::min(local.top, vert.y),
+					std::max(local.right, vert.x), std::max(local.bottom, vert.y)
+				};
+			}
+			if (cmd.kind == DrawCommandKind::DrawPolygon)
+			{
+				local = local.Inflated(halfThick);
+			}
+			break;
+		}
+		case DrawCommandKind::Sprite:
+			local = cmd.RectAt(0);
+			break;
+		case DrawCommandKind::Text:
+		{
+			// glyphs may overhang the layout a bit, so the bounds are grown by the font size.
+			auto const rect{cmd.RectAt(0)};
+			auto const extent{cmd.Point(3)};
+			if (extent.x > 0.f and extent.y > 0.f)
+			{
+				local = RawRect{rect.left, rect.top, rect.left + extent.x, rect.top + extent.y}.Inflated(cmd.data[4]);
+			}
+			else if (std::isfinite(rect.right) and std::isfinite(rect.bottom))
+			{
+				local = rect;
+			}
+			else
+			{
+				// unknown size, so it may cover anything.
+				return {-inf, -inf, inf, inf};
+			}
+			break;
+		}
+		default:
+			assert(false && "Unhandled DrawCommandKind");
+			return {};
+		}
+
+		// one extra pixel swallows any rounding between here and the actual rasterization.
+		return transform.ApplyToRect(local).Inflated(1.f);
+	}
+	SoftwareRasterizer::Stats const& SoftwareRasterizer::GetStats() const noexcept
+	{
+		return stats_;
+	}
+	void SoftwareRasterizer::ResetStats() noexcept
+	{
+		stats_ = {};
+	}
+	void SoftwareRasterizer::FillSpan(std::uint32_t* pDst, std::size_t count, std::uint32_t pixel) noexcept
+	{
+		auto const alpha{pixel >> 24U};
+		if (alpha == 0U)
+		{
+			return;
+		}
+
+		std::size_t i{};
+		if (alpha == 0xFFU)
+		{
+#ifdef AR2D_RASTERIZER_SSE2
+			auto const wide{_mm_set1_epi32(static_cast<int>(pixel))};
+			for (; i + 4U <= count; i += 4U)
+			{
+				_mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + i), wide);
+			}
+#endif
+			std::fill(pDst + i, pDst + count, pixel);
+			return;
+		}
+
+#ifdef AR2D_RASTERIZER_SSE2
+		// same math as PixelBuffer::BlendOver with full coverage, four pixels at a time.
+		auto const zero{_mm_setzero_si128()};
+		auto const inv{_mm_set1_epi16(static_cast<short>(256U - alpha - (alpha >> 7U)))};
+		auto const half{_mm_set1_epi16(0x80)};
+		auto const src{_mm_unpacklo_epi8(_mm_set1_epi32(static_cast<int>(pixel)), zero)};
+		auto const blend = [&](__m128i dst16) {
+			auto const scaled{_mm_srli_epi16(_mm_add_epi16(_mm_mullo_epi16(dst16, inv), half), 8)};
+			return _mm_add_epi16(scaled, src);
+		};
+		for (; i + 4U <= count; i += 4U)
+		{
+			auto const pWide{reinterpret_cast<__m128i*>(pDst + i)};
+			auto const dst{_mm_loadu_si128(pWide)};
+			auto const lo{blend(_mm_unpacklo_epi8(dst, zero))};
+			auto const hi{blend(_mm_unpackhi_epi8(dst, zero))};
+			_mm_storeu_si128(pWide, _mm_packus_epi16(lo, hi));
+		}
+#endif
+		for (; i < count; ++i)
+		{
+			pDst[i] = PixelBuffer::BlendOver(pDst[i], pixel);
+		}
+	}
+	void SoftwareRasterizer::RasterizeCommand(DrawCommandBuffer const& buffer, DrawCommand const& cmd, PixelBuffer& target,
+		std::span<PixelBuffer const* const> images, RawRect const& clip)
+	{
+		auto const& transform{buffer.TransformOf(cmd)};
+		auto const pixel{PixelBuffer::Pack(buffer.ColorOf(cmd))};
+		auto const thick{cmd.data[4]};
+		auto const halfThick{thick * 0.5f};
+		edges_.clear();
+
+		switch (cmd.kind)
+		{
+		case DrawCommandKind::Clear:
+		{
+			auto const pixels{ClipOf(clip, target)};
+			for (auto y{pixels.top}; y < pixels.bottom; ++y)
+			{
+				auto const row{target.Row(static_cast<std::size_t>(y))};
+				std::fill(row.begin() + pixels.left, row.begin() + std::max(pixels.left, pixels.right), pixel);
+			}
+			return;
+		}
+		case DrawCommandKind::Line:
+			AddQuad(transform, cmd.Point(0), cmd.Point(1), thick);
+			break;
+		case DrawCommandKind::FillEllipse:
+			AddEllipse(transform, cmd.Point(0), cmd.data[2], cmd.data[3], Orientation::Keep);
+			break;
+		case DrawCommandKind::DrawEllipse:
+			AddEllipse(transform, cmd.Point(0), cmd.data[2] + halfThick, cmd.data[3] + halfThick, Orientation::Positive);
+			if (cmd.data[2] > halfThick and cmd.data[3] > halfThick)
+			{
+				AddEllipse(transform, cmd.Point(0), cmd.data[2] - halfThick, cmd.data[3] - halfThick, Orientation::Negative);
+			}
+			break;
+		case DrawCommandKind::FillRectangle:
+		case DrawCommandKind::DrawRectangle:
+		{
+			auto const rect{cmd.RectAt(0)};
+			auto const bFill{cmd.kind == DrawCommandKind::FillRectangle};
+			auto const outer{bFill ? rect : rect.Inflated(halfThick)};
+			auto const inner{bFill ? RawRect{} : rect.Inflated(-halfThick)};
+			if (transform.IsAxisAligned())
+			{
+				// the common case (grids, tiles, ui) never builds any edges.
+				auto const o{transform.ApplyToRect(outer)};
+				if (inner.IsEmpty())
+				{
+					return FillAxisAlignedRect(target, o, pixel, clip);
+				}
+				auto const i{transform.ApplyToRect(inner)};
+				FillAxisAlignedRect(target, {o.left, o.top, o.right, i.top}, pixel, clip);
+				FillAxisAlignedRect(target, {o.left, i.bottom, o.right, o.bottom}, pixel, clip);
+				FillAxisAlignedRect(target, {o.left, i.top, i.left, i.bottom}, pixel, clip);
+				FillAxisAlignedRect(target, {i.right, i.top, o.right, i.bottom}, pixel, clip);
+				return;
+			}
+
+			auto const addRect = [&](RawRect const& r, Orientation orientation) {
+				RawPoint const corners[]{
+					transform.Apply({r.left, r.top}), transform.Apply({r.right, r.top}),
+					transform.Apply({r.right, r.bottom}), transform.Apply({r.left, r.bottom}),
+				};
+				AddContour(corners, orientation);
+			};
+			addRect(outer, Orientation::Positive);
+			if (not inner.IsEmpty())
+			{
+				addRect(inner, Orientation::Negative);
+			}
+			break;
+		}
+		case DrawCommandKind::FillPolygon:
+		{
+			auto const verts{buffer.VerticesOf(cmd)};
+			scratchPoints_.clear();
+			std::ranges::transform(verts, std::back_inserter(scratchPoints_), [&](RawPoint const& vert) {
+				return transform.Apply(vert);
+			});
+			AddContour(scratchPoints_, Orientation::Keep);
+			break;
+		}
+		case DrawCommandKind::DrawPolygon:
+		{
+			auto const verts{buffer.VerticesOf(cmd)};
+			for (std::size_t i{}, lim{verts.size()}; i < lim; ++i)
+			{
+				AddQuad(transform, verts[i], verts[(i + 1U) % lim], thick);
+			}
+			break;
+		}
+		case DrawCommandKind::Sprite:
+		{
+			assert(cmd.resource < images.size() && images[cmd.resource] && "Sprite image missing");
+			auto const dest{cmd.RectAt(0)};
+			auto const src{cmd.RectAt(1)};
+			if (src.IsEmpty())
+			{
+				return;
+			}
+			// the batch draws src into {0, 0, src width, src height}, so scale and move that into dest first.
+			RawMatrix const toDest{
+				dest.Width() / src.Width(), 0.f, 0.f, dest.Height() / src.Height(), dest.left, dest.top
+			};
+			SpriteBatch::CompositeEntry(target, *images[cmd.resource],
+				{cmd.resource, src, toDest * transform, cmd.data[8], cmd.flags}, clip
+			);
+			return;
+		}
+		case DrawCommandKind::Text:
+			++stats_.skippedCommands;
+			return;
+		default:
+			assert(false && "Unhandled DrawCommandKind");
+			return;
+		}
+
+		FillEdges(target, pixel, clip);
+	}
+	void SoftwareRasterizer::AddContour(std::span<RawPoint const> points, Orientation orientation)
+	{
+		if (points.size() < 3U)
+		{
+			return;
+		}
+
+		auto bReverse{false};
+		if (orientation != Orientation::Keep)
+		{
+			auto twiceArea{0.f};
+			for (std::size_t i{}, lim{points.size()}; i < lim; ++i)
+			{
+				auto const& a{points[i]};
+				auto const& b{points[(i + 1U) % lim]};
+				twiceArea += a.x * b.y - b.x * a.y;
+			}
+			bReverse = (twiceArea < 0.f) == (orientation == Orientation::Positive);
+		}
+
+		for (std::size_t i{}, lim{points.size()}; i < lim; ++i)
+		{
+			auto a{points[i]};
+			auto b{points[(i + 1U) % lim]};
+			if (bReverse)
+			{
+				std::swap(a, b);
+			}
+			if (a.y == b.y)
+			{
+				// horizontal edges never cross a scanline.
+				continue;
+			}
+
+			auto const winding{a.y < b.y ? 1 : -1};
+			if (winding < 0)
+			{
+				std::swap(a, b);
+			}
+			edges_.push_back({a.x, a.y, b.y, (b.x - a.x) / (b.y - a.y), winding});
+		}
+	}
+	void SoftwareRasterizer::AddQuad(RawMatrix const& transform, RawPoint const& from, RawPoint const& to, float thick)
+	{
+		auto const dx{to.x - from.x};
+		auto const dy{to.y - from.y};
+		auto const length{std::sqrt(dx * dx + dy * dy)};
+		if (length == 0.f)
+		{
+			return;
+		}
+
+		// flat caps, same as direct2d's default stroke style.
+		auto const scale{thick * 0.5f / length};
+		auto const nx{-dy * scale};
+		auto const ny{dx * scale};
+		RawPoint const corners[]{
+			transform.Apply({from.x + nx, from.y + ny}), transform.Apply({to.x + nx, to.y + ny}),
+			transform.Apply({to.x - nx, to.y - ny}), transform.Apply({from.x - nx, from.y - ny}),
+		};
+		AddContour(corners, Orientation::Positive);
+	}
+	void SoftwareRasterizer::AddEllipse(RawMatrix const& transform, RawPoint const& center, float rx, float ry, Orientation orientation)
+	{
+		// enough segments to keep the error under a quarter of a pixel.
+		auto const radius{std::max(rx, ry) * transform.AverageScale()};
+		auto const segments{std::clamp(
+			static_cast<int>(std::ceil(std::numbers::pi_v<float> * std::sqrt(2.f * radius))), 8, 1024
+		)};
+		auto const step{2.f * std::numbers::pi_v<float> / static_cast<float>(segments)};
+
+		scratchPoints_.clear();
+		for (int i{}; i < segments; ++i)
+		{
+			auto const angle{step * static_cast<float>(i)};
+			scratchPoints_.push_back(transform.Apply({center.x + rx * std::cos(angle), center.y + ry * std::sin(angle)}));
+		}
+		AddContour(scratchPoints_, orientation);
+	}
+	void SoftwareRasterizer::FillEdges(PixelBuffer& target, std::uint32_t pixel, RawRect const& clip)
+	{
+		if (edges_.empty())
+		{
+			return;
+		}
+
+		std::ranges::sort(edges_, {}, &Edge::y0);
+		auto minY{edges_.front().y0};
+		auto maxY{edges_.front().y1};
+		for (auto const& edge : edges_)
+		{
+			maxY = std::max(maxY, edge.y1);
+		}
+
+		auto const pixels{ClipOf(clip, target)};
+		auto const rows{CentersIn(minY, maxY, pixels.top, pixels.bottom)};
+		activeEdges_.clear();
+		auto nextEdge{edges_.begin()};
+
+		for (auto y{rows.first}; y < rows.last; ++y)
+		{
+			auto const sampleY{static_cast<float>(y) + 0.5f};
+			for (; nextEdge != edges_.end() and nextEdge->y0 <= sampleY; ++nextEdge)
+			{
+				activeEdges_.push_back(&*nextEdge);
+			}
+			std::erase_if(activeEdges_, [sampleY](Edge const* pEdge) { return pEdge->y1 <= sampleY; });
+
+			crossings_.clear();
+			for (auto const pEdge : activeEdges_)
+			{
+				crossings_.push_back({pEdge->x0 + (sampleY - pEdge->y0) * pEdge->dxdy, pEdge->winding});
+			}
+			std::ranges::sort(crossings_, {}, &Crossing::x);
+
+			auto const row{target.Row(static_cast<std::size_t>(y))};
+			int winding{};
+			for (std::size_t i{}, lim{crossings_.size()}; i + 1U < lim; ++i)
+			{
+				winding += crossings_[i].winding;
+				if (winding == 0)
+				{
+					continue;
+				}
+
+				auto const span{CentersIn(crossings_[i].x, crossings_[i + 1U].x, pixels.left, pixels.right)};
+				if (not span.IsEmpty())
+				{
+					FillSpan(row.data() + span.first, static_cast<std::size_t>(span.last - span.first), pixel);
+					++stats_.spans;
+					stats_.pixels += static_cast<std::uint64_t>(span.last - span.first);
+				}
+			}
+		}
+	}
+	void SoftwareRasterizer::FillAxisAlignedRect(PixelBuffer& target, RawRect const& rect, std::uint32_t pixel, RawRect const& clip)
+	{
+		auto const pixels{ClipOf(clip, target)};
+		auto const cols{CentersIn(rect.left, rect.right, pixels.left, pixels.right)};
+		auto const rows{CentersIn(rect.top, rect.bottom, pixels.top, pixels.bottom)};
+		if (cols.IsEmpty())
+		{
+			return;
+		}
+
+		for (auto y{rows.first}; y < rows.last; ++y)
+		{
+			FillSpan(target.Row(static_cast<std::size_t>(y)).data() + cols.first, static_cast<std::size_t>(cols.last - cols.first), pixel);
+			++stats_.spans;
+			stats_.pixels += static_cast<std::uint64_t>(cols.last - cols.first);
+		}
+	}
+}
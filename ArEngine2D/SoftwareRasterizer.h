@@ -0,0 +1,381 @@
+#pragma once
+
+#include "RawTypes.h"
+#include "PixelBuffer.h"
+#include "DrawCommandBuffer.h"
+#include "JobSystem.h"
+#include "Testing/ArTest20.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief draws a DrawCommandBuffer into a PixelBuffer on the cpu, without any windows dependency.
+	 *		  shapes are turned into polygons and filled with the nonzero rule, sampling at pixel
+	 *		  centers (no anti aliasing). text commands are skipped.
+	*/
+	class SoftwareRasterizer
+	{
+	public:
+
+		struct Stats
+		{
+			std::uint64_t commands;
+			// commands the rasterizer can not draw (text).
+			std::uint64_t skippedCommands;
+			std::uint64_t spans;
+			std::uint64_t pixels;
+			// RenderTiled only; binnedCommands counts a command once for every tile it touches.
+			std::uint64_t tiles;
+			std::uint64_t binnedCommands;
+		};
+
+		constexpr static std::uint32_t sc_DefaultTileSize{64U};
+
+	public:
+
+		SoftwareRasterizer() = default;
+
+	public:
+
+		/**
+		 * @brief draws the commands in their current order.
+		 * @param images => the resource of every sprite command is an index into this span.
+		*/
+		void Render(DrawCommandBuffer const& buffer, PixelBuffer& target, std::span<PixelBuffer const* const> images = {});
+
+		/**
+		 * @brief same as Render, but nothing outside of clip is touched.
+		*/
+		void RenderClipped(DrawCommandBuffer const& buffer, PixelBuffer& target, std::span<PixelBuffer const* const> images, RawRect const& clip);
+
+		/**
+		 * @brief same result as Render, pixel for pixel. the target is cut into tiles, every command
+		 *		  is binned into the tiles its bounds touch, then the tiles are drawn in parallel.
+		*/
+		void RenderTiled(DrawCommandBuffer const& buffer, PixelBuffer& target, std::span<PixelBuffer const* const> images,
+			JobSystem& jobs, std::uint32_t tileSize = sc_DefaultTileSize
+		);
+
+		/**
+		 * @return a rectangle (in target pixels) containing everything the command may touch, whichever
+		 *		   backend draws it; infinite for Clear, and for text laid out without a known size.
+		*/
+		static RawRect DeviceBounds(DrawCommandBuffer const& buffer, DrawCommand const& cmd) noexcept;
+
+		/**
+		 * @brief counters of every call since the last ResetStats.
+		*/
+		Stats const& GetStats() const noexcept;
+		void ResetStats() noexcept;
+
+		/**
+		 * @brief fills (or blends, if the pixel is not opaque) count pixels starting at pDst.
+		 *		  uses SSE2 when available.
+		*/
+		static void FillSpan(std::uint32_t* pDst, std::size_t count, std::uint32_t pixel) noexcept;
+
+	private:
+
+		struct Edge
+		{
+			float x0;
+			float y0;
+			float y1;
+			float dxdy;
+			// +1 going down, -1 going up.
+			int winding;
+		};
+
+		struct Crossing
+		{
+			float x;
+			int winding;
+		};
+
+		// forcing the orientation of a contour makes overlapping parts of a shape add up
+		// (or cut a hole) under the nonzero rule, no matter how the transform flips it.
+		enum class Orientation
+		{
+			Keep,
+			Positive,
+			Negative,
+		};
+
+	private:
+		void RasterizeCommand(DrawCommandBuffer const& buffer, DrawCommand const& cmd, PixelBuffer& target,
+			std::span<PixelBuffer const* const> images, RawRect const& clip
+		);
+
+		// the points must already be transformed.
+		void AddContour(std::span<RawPoint const> points, Orientation orientation);
+		void AddQuad(RawMatrix const& transform, RawPoint const& from, RawPoint const& to, float thick);
+		void AddEllipse(RawMatrix const& transform, RawPoint const& center, float rx, float ry, Orientation orientation);
+		void FillEdges(PixelBuffer& target, std::uint32_t pixel, RawRect const& clip);
+		void FillAxisAlignedRect(PixelBuffer& target, RawRect const& rect, std::uint32_t pixel, RawRect const& clip);
+
+	private:
+		// RenderTiled; a tile is drawn by a rasterizer no other tile is using at the time.
+		std::vector<std::unique_ptr<SoftwareRasterizer>> tileRasterizers_{};
+		std::vector<SoftwareRasterizer*> freeTileRasterizers_{};
+		std::vector<RawRect> commandBounds_{};
+		// the commands of tile i are tileCommands_[tileOffsets_[i], tileOffsets_[i + 1]), in draw order.
+		std::vector<std::uint32_t> tileOffsets_{};
+		std::vector<std::uint32_t> tileCommands_{};
+
+		std::vector<Edge> edges_{};
+		std::vector<Edge const*> activeEdges_{};
+		std::vector<Crossing> crossings_{};
+		std::vector<RawPoint> scratchPoints_{};
+		Stats stats_{};
+	};
+
+	inline void TestSoftwareRasterizer()
+	{
+		using namespace ArTest;
+		std::ofstream file{"SoftwareRasterizerTestResults.txt"};
+		Tester tester{file};
+
+		constexpr std::uint32_t black{0xFF'00'00'00U};
+		constexpr std::uint32_t white{0xFF'FF'FF'FFU};
+		constexpr RawColor whiteColor{1.f, 1.f, 1.f, 1.f};
+
+		auto const countOf = [](PixelBuffer const& buffer, std::uint32_t pixel) {
+			std::size_t count{};
+			for (auto const p : buffer.Pixels())
+			{
+				count += (p == pixel);
+			}
+			return count;
+		};
+
+		tester.NewTest("FillSpan") = [&] {
+			PixelBuffer buffer{11U, 1U, black};
+			SoftwareRasterizer::FillSpan(buffer.Row(0U).data() + 1, 9U, white);
+			tester.PassIfEqual(std::uint32_t{buffer.At(0U, 0U)}, std::uint32_t{black});
+			tester.PassIfEqual(std::uint32_t{buffer.At(1U, 0U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{buffer.At(9U, 0U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{buffer.At(10U, 0U)}, std::uint32_t{black});
+
+			// half transparent white over black.
+			SoftwareRasterizer::FillSpan(buffer.Row(0U).data(), 1U, 0x80'80'80'80U);
+			tester.PassIfEqual(std::uint32_t{buffer.At(0U, 0U)}, std::uint32_t{0xFF'80'80'80U});
+		};
+
+		tester.NewTest("Clear and rectangles") = [&] {
+			PixelBuffer target{8U, 8U};
+			DrawCommandBuffer buffer{};
+			buffer.AddClear({0.f, 0.f, 0.f, 1.f});
+			buffer.SetColor(whiteColor);
+			buffer.AddRectangle({2.f, 2.f, 6.f, 4.f}, 1.f, true);
+
+			SoftwareRasterizer rasterizer{};
+			rasterizer.Render(buffer, target);
+			tester.PassIfEqual(countOf(target, white), std::size_t{8U});
+			tester.PassIfEqual(std::uint32_t{target.At(2U, 2U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{target.At(5U, 3U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{target.At(6U, 3U)}, std::uint32_t{black});
+		};
+
+		tester.NewTest("Transformed rectangle is a polygon") = [&] {
+			PixelBuffer target{8U, 8U, black};
+			DrawCommandBuffer buffer{};
+			// 45 degrees.
+			constexpr float c{0.70710678f};
+			buffer.SetTransform({c, c, -c, c, 4.f, 4.f});
+			buffer.SetColor(whiteColor);
+			buffer.AddRectangle({-1.f, -1.f, 1.f, 1.f}, 1.f, true);
+
+			SoftwareRasterizer rasterizer{};
+			rasterizer.Render(buffer, target);
+			tester.PassIfEqual(std::uint32_t{target.At(3U, 3U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{target.At(4U, 4U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{target.At(2U, 2U)}, std::uint32_t{black});
+		};
+
+		tester.NewTest("Stroked shapes are hollow") = [&] {
+			PixelBuffer target{16U, 16U, black};
+			DrawCommandBuffer buffer{};
+			buffer.SetColor(whiteColor);
+			buffer.AddRectangle({2.f, 2.f, 14.f, 14.f}, 2.f, false);
+			buffer.AddEllipse({8.f, 8.f}, 2.f, 2.f, 1.f, false);
+
+			SoftwareRasterizer rasterizer{};
+			rasterizer.Render(buffer, target);
+			tester.PassIfEqual(std::uint32_t{target.At(1U, 8U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{target.At(3U, 3U)}, std::uint32_t{black});
+			tester.PassIfEqual(std::uint32_t{target.At(8U, 8U)}, std::uint32_t{black});
+			tester.PassIfEqual(std::uint32_t{target.At(9U, 8U)}, std::uint32_t{white});
+		};
+
+		tester.NewTest("Polygons use nonzero") = [&] {
+			PixelBuffer target{10U, 10U, black};
+			DrawCommandBuffer buffer{};
+			buffer.SetColor(whiteColor);
+			std::array const tri{RawPoint{0.f, 0.f}, RawPoint{10.f, 0.f}, RawPoint{0.f, 10.f}};
+			buffer.AddPolygon(tri, 1.f, true);
+			buffer.AddLine({0.f, 9.5f}, {10.f, 9.5f}, 1.f);
+
+			SoftwareRasterizer rasterizer{};
+			rasterizer.Render(buffer, target);
+			tester.PassIfEqual(std::uint32_t{target.At(1U, 1U)}, std::uint32_t{white});
+			tester.PassIfEqual(std::uint32_t{target.At(8U, 8U)}, std::uint32_t{black});
+			tester.PassIfEqual(std::uint32_t{target.At(8U, 9U)}, std::uint32_t{white});
+			// 45 triangle pixels, and the line is on the row below the triangle.
+			tester.PassIfEqual(countOf(target, white), std::size_t{45U + 10U});
+		};
+
+		tester.NewTest("Clipping and text") = [&] {
+			PixelBuffer target{8U, 8U, black};
+			DrawCommandBuffer buffer{};
+			buffer.SetColor(whiteColor);
+			buffer.AddRectangle({0.f, 0.f, 8.f, 8.f}, 1.f, true);
+			buffer.AddText("skipped", {}, 10.f, 0U, 0U);
+
+			SoftwareRasterizer rasterizer{};
+			rasterizer.RenderClipped(buffer, target, {}, {0.f, 0.f, 4.f, 8.f});
+			tester.PassIfEqual(countOf(target, white), std::size_t{32U});
+			tester.PassIfEqual(rasterizer.GetStats().skippedCommands, std::uint64_t{1U});
+		};
+
+		tester.NewTest("Sprites") = [&] {
+			PixelBuffer image{2U, 2U, white};
+			PixelBuffer const* const images[]{&image};
+			PixelBuffer target{4U, 4U, black};
+			DrawCommandBuffer buffer{};
+			buffer.AddSprite(0U, {1.f, 1.f, 3.f, 3.f}, {0.f, 0.f, 2.f, 2.f}, 1.f, 0U);
+
+			SoftwareRasterizer rasterizer{};
+			rasterizer.Render(buffer, target, images);
+			tester.PassIfEqual(countOf(target, white), std::size_t{4U});
+			tester.PassIfEqual(std::uint32_t{target.At(1U, 1U)}, std::uint32_t{white});
+		};
+
+		tester.NewTest("Tiled matches Render") = [&] {
+			PixelBuffer image{3U, 3U, 0x80'00'80'00U};
+			image.At(1U, 1U) = white;
+			PixelBuffer const* const images[]{&image};
+
+			DrawCommandBuffer buffer{};
+			buffer.AddClear({0.f, 0.f, 0.f, 1.f});
+			buffer.SetTransform({0.9f, 0.3f, -0.3f, 0.9f, 20.f, -5.f});
+			for (int i{}; i < 40; ++i)
+			{
+				auto const f{static_cast<float>(i)};
+				buffer.SetColor({f / 40.f, 0.5f, 1.f - f / 40.f, 0.6f});
+				buffer.AddEllipse({f * 3.f, f * 2.f}, 9.f, 5.f, 2.f, i % 2 == 0);
+				buffer.AddRectangle({f * 2.f, 40.f, f * 2.f + 13.f, 61.f}, 3.f, i % 3 == 0);
+				buffer.AddLine({0.f, f * 4.f}, {130.f, 100.f - f}, 1.5f);
+				buffer.AddSprite(0U, {f * 3.f, 70.f, f * 3.f + 7.f, 77.f}, {0.f, 0.f, 3.f, 3.f}, 0.7f, static_cast<std::uint8_t>(i % 2));
+			}
+
+			PixelBuffer expected{133U, 97U};
+			SoftwareRasterizer single{};
+			single.Render(buffer, expected, images);
+
+			for (std::size_t const threads : {1U, 3U})
+			{
+				JobSystem jobs{threads};
+				for (std::uint32_t const tileSize : {16U, 50U})
+				{
+					PixelBuffer tiled{133U, 97U};
+					SoftwareRasterizer rasterizer{};
+					rasterizer.RenderTiled(buffer, tiled, images, jobs, tileSize);
+					tester.PassIf(tiled == expected);
+					tester.PassIfEqual(rasterizer.GetStats().pixels, single.GetStats().pixels);
+				}
+			}
+
+			// another thread that is not a worker helps with the tiles while waiting for its own jobs.
+			JobSystem jobs{3U};
+			std::atomic<bool> bDrawing{true};
+			std::thread other{[&] {
+				while (bDrawing.load())
+				{
+					jobs.ParallelFor(8U, [](std::size_t) { std::this_thread::yield(); });
+				}
+			}};
+			SoftwareRasterizer rasterizer{};
+			bool bSame{true};
+			for (int frame{}; frame < 20; ++frame)
+			{
+				PixelBuffer tiled{133U, 97U};
+				rasterizer.RenderTiled(buffer, tiled, images, jobs, 16U);
+				bSame = bSame and tiled == expected;
+			}
+			bDrawing = false;
+			other.join();
+			tester.PassIf(bSame);
+		};
+
+		tester.OutputResults();
+	}
+
+	/**
+	 * @brief times RenderTiled on a scene like the Editor's grid (a filled block, an arrow and an
+	 *		  outline per cell, under a zoomed camera) with 1 to maxThreads threads.
+	 *		  writes the results to SoftwareRasterizerBenchmark.txt.
+	*/
+	inline void BenchmarkSoftwareRasterizer(std::size_t maxThreads = std::thread::hardware_concurrency(),
+		std::size_t width = 1920U, std::size_t height = 1080U, std::size_t frames = 20U)
+	{
+		std::ofstream file{"SoftwareRasterizerBenchmark.txt"};
+
+		constexpr float blockWidth{64.f};
+		constexpr std::size_t gridSide{64U};
+		DrawCommandBuffer scene{};
+		scene.AddClear({0.83f, 0.83f, 0.83f, 1.f});
+		scene.SetTransform({0.75f, 0.f, 0.f, 0.75f, -100.f, -60.f});
+		for (std::size_t row{}; row < gridSide; ++row)
+		{
+			for (std::size_t col{}; col < gridSide; ++col)
+			{
+				auto const x{static_cast<float>(col) * blockWidth};
+				auto const y{static_cast<float>(row) * blockWidth};
+				auto const hue{static_cast<float>((row * 7U + col * 3U) % 10U) / 10.f};
+				scene.SetColor({hue, 1.f - hue, 0.5f, 1.f});
+				scene.AddRectangle({x, y, x + blockWidth, y + blockWidth}, 1.f, true);
+
+				scene.SetColor({0.5f, 0.5f, 0.5f, 1.f});
+				auto const mid{y + blockWidth * 0.5f};
+				auto const tip{x + blockWidth * 0.75f};
+				scene.AddLine({x + blockWidth * 0.25f, mid}, {tip, mid}, 1.f);
+				scene.AddLine({tip, mid}, {tip - 8.f, mid - 8.f}, 1.f);
+				scene.AddLine({tip, mid}, {tip - 8.f, mid + 8.f}, 1.f);
+				scene.AddRectangle({x, y, x + blockWidth, y + blockWidth}, 1.f, false);
+			}
+		}
+
+		PixelBuffer expected{width, height};
+		SoftwareRasterizer{}.Render(scene, expected);
+
+		file << "scene: " << scene.Size() << " commands, " << width << 'x' << height << ", " << frames << " frames\n";
+		double baseline{};
+		for (std::size_t threads{1U}, lim{std::max<std::size_t>(maxThreads, 1U)}; threads <= lim; ++threads)
+		{
+			JobSystem jobs{threads};
+			SoftwareRasterizer rasterizer{};
+			PixelBuffer target{width, height};
+
+			auto const start{std::chrono::steady_clock::now()};
+			for (std::size_t i{}; i < frames; ++i)
+			{
+				rasterizer.RenderTiled(scene, target, {}, jobs);
+			}
+			std::chrono::duration<double, std::milli> const elapsed{std::chrono::steady_clock::now() - start};
+
+			auto const msPerFrame{elapsed.count() / static_cast<double>(frames)};
+			baseline = (threads == 1U) ? msPerFrame : baseline;
+			file << threads << " threads: " << msPerFrame << " ms/frame, speedup " << baseline / msPerFrame
+				 << ", stolen jobs " << jobs.StolenJobs()
+				 << (target == expected ? ", identical\n" : ", MISMATCH\n");
+		}
+	}
+}
@@ -2,6 +2,10 @@
 
 #include "IEngineError.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
 namespace ArEngine2D {
 	Sprite::Sprite(self const& that)
 	{
@@ -21,13 +25,58 @@ namespace ArEngine2D {
 		MoveFromSprite(rhs);
 		return *this;
 	}
-	void Sprite::Initialize(std::wstring_view fileName)
+	Sprite Sprite::Clone() const
+	{
+		InitializationCheck();
+		auto const source{SourceRectU(RectU())};
+		auto pData{std::make_shared<SharedData>()};
+		HANDLE_GRAPHICS_ERROR(s_pRenderTarget_->CreateBitmap(
+			D2D1::SizeU(source.right - source.left, source.bottom - source.top),
+			D2D1::BitmapProperties(PixelFormat()), &pData->pImage
+		));
+		HANDLE_GRAPHICS_ERROR(pData->pImage->CopyFromBitmap(nullptr, pData_->pImage.Get(), &source));
+		if (pData_->pPixels and IsView())
+		{
+			auto pPixels{std::make_shared<PixelBuffer>(source.right - source.left, source.bottom - source.top)};
+			for (UINT32 y{source.top}; y < source.bottom; ++y)
+			{
+				auto const srcRow{pData_->pPixels->Row(y).subspan(source.left, source.right - source.left)};
+				std::ranges::copy(srcRow, pPixels->Row(y - source.top).begin());
+			}
+			pData->pPixels = std::move(pPixels);
+		}
+		else
+		{
+			// never modified in place, sharing them is as good as copying them.
+			pData->pPixels = pData_->pPixels;
+			pData->pMips = pData_->pMips;
+		}
+		Sprite clone{};
+		clone.pData_ = std::move(pData);
+		clone.InitializeMinorMembers();
+		return clone;
+	}
+	Sprite Sprite::View(D2D1_RECT_U const& region) const
+	{
+		InitializationCheck();
+		AR2D_ASSERT(region.left < region.right and region.top < region.bottom
+			and region.right <= static_cast<UINT32>(width_) and region.bottom <= static_cast<UINT32>(height_),
+			"Sprite view out of the sprite");
+
+		Sprite view{*this};
+		view.origin_ = {origin_.x + region.left, origin_.y + region.top};
+		view.width_ = static_cast<float>(region.right - region.left);
+		view.height_ = static_cast<float>(region.bottom - region.top);
+		return view;
+	}
+	void Sprite::Initialize(std::wstring_view fileName, bool bMipmapped)
 	{
 		// Safety checks so, I don't get confused with a nullptr runtime exception
 		AR2D_ASSERT(s_pRenderTarget_, "Did not call InternalInitialization");
 		AR2D_ASSERT(not IsInitialized(), "Double initialization of Sprite");
 
 		// Cheap to construct so, no need to pollute the class with static data members
+		auto pData{std::make_shared<SharedData>()};
 		Details::Ptr<IWICBitmapDecoder> pDecoder{};
 		Details::Ptr<IWICBitmapFrameDecode> pOnlyFrame{};
 		Details::Ptr<IWICFormatConverter> pConverter{};
@@ -46,45 +95,112 @@ namespace ArEngine2D {
 		));
 		// Use the converter through the render target
 		HANDLE_GRAPHICS_ERROR(s_pRenderTarget_->CreateBitmapFromWicBitmap(
-			pConverter.Get(), nullptr, &pImage_
+			pConverter.Get(), nullptr, &pData->pImage
 		));
+		// the software rasterizer can not read direct2d bitmaps back, so it gets its own copy.
+		// the mip levels are made from the same copy.
+		if (s_bKeepPixels_ or bMipmapped)
+		{
+			UINT width{};
+			UINT height{};
+			HANDLE_GRAPHICS_ERROR(pConverter->GetSize(&width, &height));
+			auto pPixels{std::make_shared<PixelBuffer>(width, height)};
+			HANDLE_GRAPHICS_ERROR(pConverter->CopyPixels(nullptr, static_cast<UINT>(pPixels->Pitch()),
+				static_cast<UINT>(pPixels->Pitch() * height), reinterpret_cast<BYTE*>(pPixels->Pixels().data())
+			));
+			if (bMipmapped)
+			{
+				pData->pMips = BuildMips(*pPixels);
+			}
+			if (s_bKeepPixels_)
+			{
+				pData->pPixels = std::move(pPixels);
+			}
+		}
+		pData_ = std::move(pData);
 		// minor members are there for performance purposes.
 		InitializeMinorMembers();
 	}
-	void Sprite::CopyFromMemory(void const* pData, D2D1_RECT_U const& whereTo, std::size_t pitch)
+	void Sprite::Initialize(PixelBuffer const& pixels, bool bMipmapped)
 	{
-		InitializationCheck();
-		HANDLE_GRAPHICS_ERROR(pImage_->CopyFromMemory(&whereTo, pData, static_cast<UINT32>(pitch)));
+		AR2D_ASSERT(s_pRenderTarget_, "Did not call InternalInitialization");
+		AR2D_ASSERT(not IsInitialized(), "Double initialization of Sprite");
+		AR2D_ASSERT(pixels.Width() and pixels.Height(), "Sprite initialized from empty pixels");
 
-		// size may have changed.
-		auto const size{pImage_->GetSize()};
-		width_ = size.width;
-		height_ = size.height;
+		auto pData{std::make_shared<SharedData>()};
+		pData->pImage = CreateBitmap(pixels);
+		if (s_bKeepPixels_)
+		{
+			pData->pPixels = std::make_shared<PixelBuffer const>(pixels);
+		}
+		if (bMipmapped)
+		{
+			pData->pMips = BuildMips(pixels);
+		}
+		pData_ = std::move(pData);
+		InitializeMinorMembers();
+	}
+	void Sprite::CopyFromMemory(void const* pData, D2D1_RECT_U const& whereToInView, std::size_t pitch)
+	{
+		InitializationCheck();
+		auto const whereTo{SourceRectU(whereToInView)};
+		// the levels would show the old data, for every copy.
+		pData_->pMips.reset();
+		HANDLE_GRAPHICS_ERROR(pData_->pImage->CopyFromMemory(&whereTo, pData, static_cast<UINT32>(pitch)));
+		if (pData_->pPixels)
+		{
+			auto pPixels{std::make_shared<PixelBuffer>(*pData_->pPixels)};
+			auto const pBytes{static_cast<std::byte const*>(pData)};
+			for (UINT32 y{whereTo.top}; y < whereTo.bottom; ++y)
+			{
+				std::memcpy(&pPixels->At(whereTo.left, y), pBytes + (y - whereTo.top) * pitch,
+					(whereTo.right - whereTo.left) * sizeof(std::uint32_t)
+				);
+			}
+			pData_->pPixels = std::move(pPixels);
+		}
 	}
-	void Sprite::CopyFromSpriteRect(Sprite const& that, D2D1_RECT_U const& from, D2D1_POINT_2U const& whereTo)
+	void Sprite::CopyFromSpriteRect(Sprite const& that, D2D1_RECT_U const& fromInView, D2D1_POINT_2U const& whereToInView)
 	{
 		InitializationCheck();
-		HANDLE_GRAPHICS_ERROR(pImage_->CopyFromBitmap(&whereTo, that.pImage_.Get(), &from));
+		auto const from{that.SourceRectU(fromInView)};
+		D2D1_POINT_2U const whereTo{origin_.x + whereToInView.x, origin_.y + whereToInView.y};
+		pData_->pMips.reset();
+		HANDLE_GRAPHICS_ERROR(pData_->pImage->CopyFromBitmap(&whereTo, that.pData_->pImage.Get(), &from));
+		// that may share the data with the current sprite, so read its pixels before replacing them.
+		if (auto const& pSource{that.pData_->pPixels}; pData_->pPixels and pSource)
+		{
+			auto pPixels{std::make_shared<PixelBuffer>(*pData_->pPixels)};
+			for (UINT32 y{from.top}; y < from.bottom; ++y)
+			{
+				auto const srcRow{pSource->Row(y).subspan(from.left, from.right - from.left)};
+				std::ranges::copy(srcRow, pPixels->Row(whereTo.y + (y - from.top)).begin() + whereTo.x);
+			}
+			pData_->pPixels = std::move(pPixels);
+		}
 	}
 	void Sprite::CopyFromSprite(Sprite const& that)
 	{
 		assert(that.IsInitialized() && "Tried to copy from an uninitialized Sprite");
-		CopyFromSpriteRect(that, that.RectU(), {});
+		this->pData_ = that.pData_;
+		this->origin_ = that.origin_;
 		this->width_ = that.width_;
 		this->height_ = that.height_;
 	}
 	void Sprite::MoveFromSprite(Sprite& that) noexcept
 	{
 		assert(that.IsInitialized() && "Tried to move from an uninitialized Sprite");
-		pImage_ = std::move(that.pImage_);
+		pData_ = std::move(that.pData_);
+		this->origin_ = that.origin_;
 		this->width_ = that.width_;
 		this->height_ = that.height_;
 	}
-	void Sprite::InternalInitialization(Details::Ptr<ID2D1HwndRenderTarget> pRenderTarget)
+	void Sprite::InternalInitialization(Details::Ptr<ID2D1RenderTarget> pRenderTarget, bool bKeepPixels)
 	{
 		assert(not s_pRenderTarget_ && "Double internal initialization of Sprite");
 		// So the user does not have to pass gfx to every Sprite.
 		s_pRenderTarget_ = std::move(pRenderTarget);
+		s_bKeepPixels_ = bKeepPixels;
 		// Commenting this out will make the program crash on exit for some reason.
 		HANDLE_GRAPHICS_ERROR(CoInitialize(nullptr));
 		HANDLE_GRAPHICS_ERROR(CoCreateInstance(
@@ -106,20 +222,75 @@ namespace ArEngine2D {
 		InitializationCheck();
 		return height_;
 	}
-	Details::Ptr<ID2D1Bitmap> Sprite::D2DPtr() const
+	Details::Ptr<ID2D1Bitmap> Sprite::D2DPtr(std::size_t level) const
+	{
+		InitializationCheck();
+		if (level == 0U)
+		{
+			return pData_->pImage;
+		}
+		assert(level <= MipLevelCount() && "Sprite mip level out of range");
+		return pData_->pMips->bitmaps[level - 1U];
+	}
+	std::size_t Sprite::MipLevelCount() const noexcept
+	{
+		return pData_ and pData_->pMips ? pData_->pMips->bitmaps.size() : 0U;
+	}
+	std::shared_ptr<PixelBuffer const> Sprite::MipPixels(std::size_t level) const
+	{
+		InitializationCheck();
+		if (level == 0U)
+		{
+			return pData_->pPixels;
+		}
+		assert(level <= MipLevelCount() && "Sprite mip level out of range");
+		return pData_->pMips->pixels.empty() ? nullptr : pData_->pMips->pixels[level - 1U];
+	}
+	D2D1_RECT_F Sprite::MipSourceRect(D2D1_RECT_F const& rect, std::size_t level) const noexcept
+	{
+		auto const source{SourceRect(rect)};
+		auto const scale{std::ldexp(1.f, -static_cast<int>(level))};
+		return {source.left * scale, source.top * scale, source.right * scale, source.bottom * scale};
+	}
+	std::shared_ptr<PixelBuffer const> const& Sprite::Pixels() const noexcept
 	{
 		InitializationCheck();
-		return pImage_;
+		return pData_->pPixels;
 	}
 	D2D1_PIXEL_FORMAT Sprite::PixelFormat() const
 	{
 		InitializationCheck();
-		return pImage_->GetPixelFormat();
+		return pData_->pImage->GetPixelFormat();
 	}
 	D2D1_SIZE_U Sprite::PixelSize() const
 	{
 		InitializationCheck();
-		return pImage_->GetPixelSize();
+		return pData_->pImage->GetPixelSize();
+	}
+	std::size_t Sprite::ByteSize() const
+	{
+		auto const size{PixelSize()};
+		return std::size_t{size.width} * size.height * sizeof(std::uint32_t);
+	}
+	D2D1_POINT_2U Sprite::Origin() const noexcept
+	{
+		return origin_;
+	}
+	bool Sprite::IsView() const
+	{
+		InitializationCheck();
+		auto const size{PixelSize()};
+		return origin_.x or origin_.y or static_cast<UINT32>(width_) != size.width or static_cast<UINT32>(height_) != size.height;
+	}
+	D2D1_RECT_F Sprite::SourceRect(D2D1_RECT_F const& rect) const noexcept
+	{
+		auto const x{static_cast<float>(origin_.x)};
+		auto const y{static_cast<float>(origin_.y)};
+		return {rect.left + x, rect.top + y, rect.right + x, rect.bottom + y};
+	}
+	D2D1_RECT_U Sprite::SourceRectU(D2D1_RECT_U const& rect) const noexcept
+	{
+		return {rect.left + origin_.x, rect.top + origin_.y, rect.right + origin_.x, rect.bottom + origin_.y};
 	}
 	D2D1_RECT_U Sprite::RectU() const
 	{
@@ -131,15 +302,44 @@ namespace ArEngine2D {
 		InitializationCheck();
 		return {0.f, 0.f, Width(), Height()};
 	}
+	Details::Ptr<ID2D1Bitmap> Sprite::CreateBitmap(PixelBuffer const& pixels)
+	{
+		// 0xAARRGGBB in memory is exactly BGRA with premultiplied alpha.
+		auto const properties{D2D1::BitmapProperties(
+			D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)
+		)};
+		Details::Ptr<ID2D1Bitmap> pBitmap{};
+		HANDLE_GRAPHICS_ERROR(s_pRenderTarget_->CreateBitmap(
+			D2D1::SizeU(static_cast<UINT32>(pixels.Width()), static_cast<UINT32>(pixels.Height())),
+			pixels.Pixels().data(), static_cast<UINT32>(pixels.Pitch()), properties, &pBitmap
+		));
+		return pBitmap;
+	}
+	std::shared_ptr<Sprite::MipData const> Sprite::BuildMips(PixelBuffer const& pixels)
+	{
+		auto pMips{std::make_shared<MipData>()};
+		auto levels{MipChain::Build(pixels)};
+		pMips->bitmaps.reserve(levels.size());
+		for (auto& level : levels)
+		{
+			pMips->bitmaps.push_back(CreateBitmap(level));
+			if (s_bKeepPixels_)
+			{
+				pMips->pixels.push_back(std::make_shared<PixelBuffer const>(std::move(level)));
+			}
+		}
+		return pMips;
+	}
 	void Sprite::InitializeMinorMembers()
 	{
-		auto const size{pImage_->GetSize()};
+		auto const size{pData_->pImage->GetSize()};
+		origin_ = {};
 		width_ = size.width;
 		height_ = size.height;
 	}
 	bool Sprite::IsInitialized() const noexcept
 	{
-		return pImage_;
+		return pData_ != nullptr;
 	}
 	void Sprite::InitializationCheck() const noexcept
 	{
@@ -148,15 +348,13 @@ namespace ArEngine2D {
 	void SpriteSheet::Initialize(std::wstring_view fileName, float frameWidth, float frameHeight, std::uint32_t frameCount)
 	{
 		base::Initialize(fileName);
-		if (std::fmod(Width(), frameWidth) or
-			std::fmod(Height(), frameHeight))
-		{
-			throw EngineError{"Invalid SpriteSheet dimensions passed; sheet width must be a multiple of frame width"};
-		}
-		this->frameWidth_  = frameWidth;
-		this->frameHeight_ = frameHeight;
-		this->frameCount_  = frameCount_;
-		InitializeMinorMembers();
+		InitializeFrames(frameWidth, frameHeight, frameCount);
+	}
+	void SpriteSheet::Initialize(Sprite const& sprite, float frameWidth, float frameHeight, std::uint32_t frameCount)
+	{
+		AR2D_ASSERT(not IsInitialized(), "Double initialization of SpriteSheet");
+		base::operator=(sprite);
+		InitializeFrames(frameWidth, frameHeight, frameCount);
 	}
 	float SpriteSheet::FrameWidth() const
 	{
@@ -208,6 +406,18 @@ namespace ArEngine2D {
 			static_cast<UINT32>(rectF.bottom),
 		};
 	}
+	void SpriteSheet::InitializeFrames(float frameWidth, float frameHeight, std::uint32_t frameCount)
+	{
+		if (std::fmod(Width(), frameWidth) or
+			std::fmod(Height(), frameHeight))
+		{
+			throw EngineError{"Invalid SpriteSheet dimensions passed; sheet width must be a multiple of frame width"};
+		}
+		this->frameWidth_  = frameWidth;
+		this->frameHeight_ = frameHeight;
+		this->frameCount_  = frameCount;
+		InitializeMinorMembers();
+	}
 	void SpriteSheet::InitializeMinorMembers()
 	{
 		rowFrameCount_ = static_cast<std::uint32_t>(Width() / FrameWidth());
@@ -229,6 +439,18 @@ namespace ArEngine2D {
 		using namespace std::chrono_literals;
 		Initialize(fileName, frameWidth, frameHeight, frameCount, frameTimeSeconds * 1s);
 	}
+	void AnimationSpriteSheet::Initialize(Sprite const& sprite, float frameWidth, float frameHeight, std::uint32_t frameCount,
+		std::chrono::duration<float> frameTime)
+	{
+		base::Initialize(sprite, frameWidth, frameHeight, frameCount);
+		this->frameTime_ = frameTime;
+	}
+	void AnimationSpriteSheet::Initialize(Sprite const& sprite, float frameWidth, float frameHeight, std::uint32_t frameCount,
+		float frameTimeSeconds)
+	{
+		using namespace std::chrono_literals;
+		Initialize(sprite, frameWidth, frameHeight, frameCount, frameTimeSeconds * 1s);
+	}
 	void AnimationSpriteSheet::Update(std::chrono::duration<float> dt) noexcept
 	{
 		InitializationCheck();
@@ -2,10 +2,14 @@
 
 #include "ImplUtil.h"
 #include "EngineCore.h"
+#include "PixelBuffer.h"
+#include "MipChain.h"
 
 #include <string>
 #include <string_view>
 #include <chrono>
+#include <memory>
+#include <vector>
 
 #include <wincodec.h>
 #include <d2d1.h>
@@ -25,11 +29,13 @@ namespace ArEngine2D {
 	private:
 		inline static Details::Ptr<IWICImagingFactory> s_pImagingFactory_{};
 		inline static Details::Ptr<ID2D1RenderTarget> s_pRenderTarget_{};
+		inline static bool s_bKeepPixels_{};
 	public:
 
 		Sprite() = default; // can't (and shouldn't) do loading in the constructor.
 
 		// sprites copied or moved from must be initialized.
+		// copies share the bitmap (with its pixels and mip levels), use Clone for one of your own.
 		Sprite(self const& that);
 		Sprite(self&& that) noexcept;
 		self& operator=(self const& rhs);
@@ -37,12 +43,32 @@ namespace ArEngine2D {
 
 	public:
 
+		/**
+		 * @return a sprite with a bitmap of its own, holding the same data (only the view, for views).
+		*/
+		Sprite Clone() const;
+
+		/**
+		 * @return a sprite that shares the bitmap, but only shows region of it; how atlas pages
+		 *		  hand out their images. every other function treats the region as the whole sprite.
+		 * @param region => relative to the current sprite, which may be a view itself.
+		*/
+		Sprite View(D2D1_RECT_U const& region) const;
+
 		/**
 		 * @brief used to initialize the data.
 		 * @param fileName => the name of the file containing the data, 
 		 *					  does not have to be a bitmap.
+		 * @param bMipmapped => also makes a box filtered mip chain, which Grafix draws from
+		 *						when the sprite is scaled down (see MipChain).
 		*/
-		void Initialize(std::wstring_view fileName);
+		void Initialize(std::wstring_view fileName, bool bMipmapped = false);
+
+		/**
+		 * @brief used to initialize the data from pixels already in memory.
+		 * @param pixels => premultiplied 0xAARRGGBB pixels; must not be empty.
+		*/
+		void Initialize(PixelBuffer const& pixels, bool bMipmapped = false);
 
 		/**
 		 * @return true if Sprite::Initialize was already called.
@@ -51,19 +77,22 @@ namespace ArEngine2D {
 
 		/**
 		 * @brief copies data from memory into the current sprite.
+		 *		  the bitmap is shared with every copy (and view) of the sprite, so they all see the
+		 *		  change; all of them lose their mip levels.
 		 * @param pData => pointer to the buffer containing the data.
-		 * @param whereTo => region inside the current sprite to be replaced.
+		 * @param whereToInView => region inside the current sprite to be replaced.
 		 * @param pitch => the width of the data.
 		*/
-		void CopyFromMemory(void const* pData, D2D1_RECT_U const& whereTo, std::size_t pitch);
+		void CopyFromMemory(void const* pData, D2D1_RECT_U const& whereToInView, std::size_t pitch);
 
 		/**
-		 * @brief copies data from another sprite.
+		 * @brief copies data from another sprite; every copy of the current sprite sees the change,
+		 *		  and loses its mip levels.
 		 * @param that => the other sprite.
-		 * @param from => rectangle inside the other sprite containing the data.
-		 * @param whereTo => point inside the current sprite where the data will end up.
+		 * @param fromInView => rectangle inside the other sprite containing the data.
+		 * @param whereToInView => point inside the current sprite where the data will end up.
 		*/
-		void CopyFromSpriteRect(Sprite const& that, D2D1_RECT_U const& from, D2D1_POINT_2U const& whereTo);
+		void CopyFromSpriteRect(Sprite const& that, D2D1_RECT_U const& fromInView, D2D1_POINT_2U const& whereToInView);
 
 		/**
 		 * @brief same as the copy constructor.
@@ -80,7 +109,7 @@ namespace ArEngine2D {
 		/**
 		 * @brief users may not call this function.
 		*/
-		static void InternalInitialization(Details::Ptr<ID2D1HwndRenderTarget> pRenderTarget);
+		static void InternalInitialization(Details::Ptr<ID2D1RenderTarget> pRenderTarget, bool bKeepPixels = false);
 
 	public:
 
@@ -102,8 +131,30 @@ namespace ArEngine2D {
 		/**
 		 * @return a pointer to a direct2d bitmap containing the data.
 		 *		   users may not release the data through this pointer.
+		 * @param level => 0 is the full size bitmap, the rest are mip levels.
+		*/
+		Details::Ptr<ID2D1Bitmap> D2DPtr(std::size_t level = 0U) const;
+
+		/**
+		 * @return the number of mip levels after the full size one; 0 unless initialized mipmapped.
+		 *		   copying data into the sprite (or any copy of it) drops them.
 		*/
-		Details::Ptr<ID2D1Bitmap> D2DPtr() const;
+		std::size_t MipLevelCount() const noexcept;
+
+		/**
+		 * @return the cpu copy of a level, null unless Grafix runs headless.
+		*/
+		std::shared_ptr<PixelBuffer const> MipPixels(std::size_t level) const;
+
+		/**
+		 * @return same as SourceRect, in the coordinates of the level.
+		*/
+		D2D1_RECT_F MipSourceRect(D2D1_RECT_F const& rect, std::size_t level) const noexcept;
+
+		/**
+		 * @return a cpu copy of the pixels of the whole bitmap, only kept when Grafix runs headless (null otherwise).
+		*/
+		std::shared_ptr<PixelBuffer const> const& Pixels() const noexcept;
 
 		/**
 		 * @return the pixel format of the sprite.
@@ -111,10 +162,31 @@ namespace ArEngine2D {
 		D2D1_PIXEL_FORMAT PixelFormat() const;
 
 		/**
-		 * @return the pixel size of the sprite.
+		 * @return the pixel size of the bitmap, which is bigger than the sprite for views.
 		*/
 		D2D1_SIZE_U PixelSize() const;
 
+		/**
+		 * @return the bytes the bitmap takes, shared by every copy of the sprite.
+		*/
+		std::size_t ByteSize() const;
+
+		/**
+		 * @return where the sprite starts in its bitmap; zero unless it's a view.
+		*/
+		D2D1_POINT_2U Origin() const noexcept;
+
+		/**
+		 * @return true if the sprite only shows a part of its bitmap.
+		*/
+		bool IsView() const;
+
+		/**
+		 * @return rect (relative to the sprite) moved to where it is in the bitmap; what draw calls sample.
+		*/
+		D2D1_RECT_F SourceRect(D2D1_RECT_F const& rect) const noexcept;
+		D2D1_RECT_U SourceRectU(D2D1_RECT_U const& rect) const noexcept;
+
 		/**
 		 * @return a rectangle with the extact same condinates and size of the sprite.
 		*/
@@ -127,6 +199,26 @@ namespace ArEngine2D {
 
 	private:
 
+		struct MipData
+		{
+			std::vector<Details::Ptr<ID2D1Bitmap>> bitmaps;
+			// only kept when Grafix runs headless.
+			std::vector<std::shared_ptr<PixelBuffer const>> pixels;
+		};
+
+		// everything copies and views of a sprite share, so a change through one shows in all of them.
+		struct SharedData
+		{
+			Details::Ptr<ID2D1Bitmap> pImage;
+			// replaced on every change, never modified in place, so a frame still using them keeps them intact.
+			std::shared_ptr<PixelBuffer const> pPixels;
+			std::shared_ptr<MipData const> pMips;
+		};
+
+	private:
+
+		static Details::Ptr<ID2D1Bitmap> CreateBitmap(PixelBuffer const& pixels);
+		static std::shared_ptr<MipData const> BuildMips(PixelBuffer const& pixels);
 		void InitializeMinorMembers();
 		
 	protected:
@@ -134,7 +226,8 @@ namespace ArEngine2D {
 		void InitializationCheck() const noexcept;
 
 	private:
-		Details::Ptr<ID2D1Bitmap> pImage_;
+		std::shared_ptr<SharedData> pData_;
+		D2D1_POINT_2U origin_{};
 		float width_;
 		float height_;
 	};
@@ -157,11 +250,6 @@ namespace ArEngine2D {
 
 	public:
 
-		/**
-		 * @brief used to initialize the data.
-		*/
-
-
 		/**
 		 * @brief used to initialize the data.
 		 * @param fileName => the name of the file containing the data,
@@ -175,6 +263,12 @@ namespace ArEngine2D {
 		*/
 		void Initialize(std::wstring_view fileName, float frameWidth, float frameHeight, std::uint32_t frameCount = {});
 
+		/**
+		 * @brief same as above, but the frames come from a sprite that's already loaded (usually
+		 *		  a view into an atlas page), which the sheet shares.
+		*/
+		void Initialize(Sprite const& sprite, float frameWidth, float frameHeight, std::uint32_t frameCount = {});
+
 	public:
 
 		/**
@@ -220,6 +314,8 @@ namespace ArEngine2D {
 		D2D1_RECT_U FrameRectU(std::uint32_t number) const;
 
 	private:
+		// throws if the frames do not tile the sheet.
+		void InitializeFrames(float frameWidth, float frameHeight, std::uint32_t frameCount);
 		// initializes optimization related members that may be removed in the future.
 		void InitializeMinorMembers();
 
@@ -280,6 +376,15 @@ namespace ArEngine2D {
 		void Initialize(std::wstring_view fileName, float frameWidth, float frameHeight, std::uint32_t frameCount, 
 			float frameTimeSeconds);
 
+		/**
+		 * @brief same as above, but the frames come from a sprite that's already loaded (usually
+		 *		  a view into an atlas page), which the sheet shares.
+		*/
+		void Initialize(Sprite const& sprite, float frameWidth, float frameHeight, std::uint32_t frameCount,
+			std::chrono::duration<float> frameTime);
+		void Initialize(Sprite const& sprite, float frameWidth, float frameHeight, std::uint32_t frameCount,
+			float frameTimeSeconds);
+
 		/**
 		 * @brief basically adds dt to an internal timer.
 		 *		  this function does nothing when the animation is paused.
@@ -0,0 +1,45 @@
+#include "SpriteAtlas.h"
+
+#include "IEngineError.h"
+
+namespace ArEngine2D {
+	void SpriteAtlas::Initialize(TextureAtlas const& atlas)
+	{
+		AR2D_ASSERT(pages_.empty(), "Double initialization of SpriteAtlas");
+		pages_.resize(atlas.Pages().size());
+		for (std::size_t page{}; page < pages_.size(); ++page)
+		{
+			pages_[page].Initialize(atlas.Pages()[page]);
+		}
+
+		sprites_.reserve(atlas.Regions().size());
+		for (auto const& [name, region] : atlas.Regions())
+		{
+			sprites_.emplace(name, pages_[region.page].View({
+				region.x, region.y, region.x + region.width, region.y + region.height
+			}));
+		}
+	}
+	Sprite const& SpriteAtlas::Get(std::string_view name) const
+	{
+		if (auto const pSprite{Find(name)})
+		{
+			return *pSprite;
+		}
+		throw EngineError{"No sprite named " + std::string{name} + " in the atlas"};
+	}
+	Sprite const* SpriteAtlas::Find(std::string_view name) const
+	{
+		auto const it{sprites_.find(std::string{name})};
+		return it == sprites_.end() ? nullptr : &it->second;
+	}
+	std::size_t SpriteAtlas::PageCount() const noexcept
+	{
+		return pages_.size();
+	}
+	Sprite const& SpriteAtlas::Page(std::size_t page) const
+	{
+		assert(page < pages_.size() && "SpriteAtlas page out of range");
+		return pages_[page];
+	}
+}
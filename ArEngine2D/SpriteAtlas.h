@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Sprite.h"
+#include "TextureAtlas.h"
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief the pages of a TextureAtlas as bitmaps, and every image in it as a view into its page.
+	 *		  sprites from the same page share one bitmap, so they batch together.
+	*/
+	class SpriteAtlas
+	{
+	public:
+
+		SpriteAtlas() = default;
+
+	public:
+
+		/**
+		 * @brief uploads the pages; the atlas is not needed afterwards.
+		*/
+		void Initialize(TextureAtlas const& atlas);
+
+		/**
+		 * @brief throws EngineError if there is no image with that name.
+		*/
+		Sprite const& Get(std::string_view name) const;
+
+		/**
+		 * @return nullptr if there is no image with that name.
+		*/
+		Sprite const* Find(std::string_view name) const;
+
+	public:
+
+		std::size_t PageCount() const noexcept;
+		Sprite const& Page(std::size_t page) const;
+
+	private:
+		std::vector<Sprite> pages_{};
+		std::unordered_map<std::string, Sprite> sprites_{};
+	};
+}
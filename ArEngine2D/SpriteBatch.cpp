@@ -0,0 +1,184 @@
+#include "SpriteBatch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <tuple>
+
+namespace ArEngine2D {
+	namespace {
+		std::uint32_t Lerp(std::uint32_t lhs, std::uint32_t rhs, float t) noexcept
+		{
+			std::uint32_t res{};
+			for (std::uint32_t shift{}; shift < 32U; shift += 8U)
+			{
+				auto const l{static_cast<float>((lhs >> shift) & 0xFFU)};
+				auto const r{static_cast<float>((rhs >> shift) & 0xFFU)};
+				res |= static_cast<std::uint32_t>(l + (r - l) * t + 0.5f) << shift;
+			}
+			return res;
+		}
+	}
+
+	void SpriteBatch::Begin() noexcept
+	{
+		entries_.clear();
+		groups_.clear();
+		bGrouped_ = true;
+	}
+	void SpriteBatch::Push(std::uint64_t image, RawRect const& src, RawMatrix const& transform, float opacity, std::uint8_t interpolation)
+	{
+		entries_.push_back({image, src, transform, opacity, interpolation});
+		bGrouped_ = false;
+	}
+	void SpriteBatch::GroupEntries()
+	{
+		std::ranges::stable_sort(entries_, [](SpriteBatchEntry const& lhs, SpriteBatchEntry const& rhs) {
+			return std::tie(lhs.image, lhs.interpolation) < std::tie(rhs.image, rhs.interpolation);
+		});
+
+		groups_.clear();
+		for (std::uint32_t i{}, lim{static_cast<std::uint32_t>(entries_.size())}; i < lim; ++i)
+		{
+			auto const& entry{entries_[i]};
+			if (groups_.empty() or groups_.back().image != entry.image or groups_.back().interpolation != entry.interpolation)
+			{
+				groups_.push_back({entry.image, entry.interpolation, i, 0U});
+			}
+			++groups_.back().count;
+		}
+		bGrouped_ = true;
+	}
+	void SpriteBatch::Composite(PixelBuffer& target, std::span<PixelBuffer const> images)
+	{
+		if (not bGrouped_)
+		{
+			GroupEntries();
+		}
+
+		for (auto const& group : groups_)
+		{
+			assert(group.image < images.size() && "SpriteBatch image handle out of range");
+			auto const& image{images[static_cast<std::size_t>(group.image)]};
+			for (auto const& entry : Entries().subspan(group.first, group.count))
+			{
+				CompositeEntry(target, image, entry, {
+					0.f, 0.f, static_cast<float>(target.Width()), static_cast<float>(target.Height())
+				});
+			}
+		}
+	}
+	std::span<SpriteBatchEntry const> SpriteBatch::Entries() const noexcept
+	{
+		return entries_;
+	}
+	std::span<SpriteBatch::Group const> SpriteBatch::Groups() const noexcept
+	{
+		assert(bGrouped_ && "Call GroupEntries after pushing");
+		return groups_;
+	}
+	std::size_t SpriteBatch::Size() const noexcept
+	{
+		return entries_.size();
+	}
+	bool SpriteBatch::IsEmpty() const noexcept
+	{
+		return entries_.empty();
+	}
+	bool SpriteBatch::IsGrouped() const noexcept
+	{
+		return bGrouped_;
+	}
+	void SpriteBatch::CompositeEntry(PixelBuffer& target, PixelBuffer const& image, SpriteBatchEntry const& entry, RawRect const& clip)
+	{
+		auto const& src{entry.src};
+		auto const& transform{entry.transform};
+		auto const opacity{entry.opacity};
+		auto const interpolation{entry.interpolation};
+		if (src.IsEmpty() or image.IsEmpty() or opacity <= 0.f or not transform.IsInvertible())
+		{
+			return;
+		}
+
+		RawRect const local{0.f, 0.f, src.Width(), src.Height()};
+		auto const bounds{transform.ApplyToRect(local).Intersection(clip).Intersection({
+			0.f, 0.f, static_cast<float>(target.Width()), static_cast<float>(target.Height())
+		})};
+		if (bounds.IsEmpty())
+		{
+			return;
+		}
+
+		// the texels the source rect covers, clamped to the image.
+		auto const texLeft{std::max(static_cast<int>(std::floor(src.left)), 0)};
+		auto const texTop{std::max(static_cast<int>(std::floor(src.top)), 0)};
+		auto const texRight{std::min(static_cast<int>(std::ceil(src.right)), static_cast<int>(image.Width())) - 1};
+		auto const texBottom{std::min(static_cast<int>(std::ceil(src.bottom)), static_cast<int>(image.Height())) - 1};
+		if (texRight < texLeft or texBottom < texTop)
+		{
+			return;
+		}
+		// the whole part of the source offset is added after flooring, so a sprite samples the same
+		// texels wherever it sits in its image (atlas pages rely on that).
+		auto const srcLeft{std::floor(src.left)};
+		auto const srcTop{std::floor(src.top)};
+		auto const fracLeft{src.left - srcLeft};
+		auto const fracTop{src.top - srcTop};
+		auto const originX{static_cast<int>(srcLeft)};
+		auto const originY{static_cast<int>(srcTop)};
+		auto const texel = [&](int x, int y) {
+			return image.At(static_cast<std::size_t>(std::clamp(x, texLeft, texRight)),
+				static_cast<std::size_t>(std::clamp(y, texTop, texBottom)));
+		};
+
+		auto const coverage{static_cast<std::uint32_t>(std::min(opacity, 1.f) * 256.f + 0.5f)};
+		auto const inv{transform.Inverted()};
+		auto const xBegin{static_cast<int>(std::floor(bounds.left))};
+		auto const xEnd{static_cast<int>(std::ceil(bounds.right))};
+		auto const yBegin{static_cast<int>(std::floor(bounds.top))};
+		auto const yEnd{static_cast<int>(std::ceil(bounds.bottom))};
+
+		for (auto y{yBegin}; y < yEnd; ++y)
+		{
+			auto const row{target.Row(static_cast<std::size_t>(y))};
+			// the local position of the pixel center. it's computed from the start of the row instead
+			// of stepped, so a pixel samples the same texel no matter where the clip starts.
+			auto const rowStart{inv.Apply({0.5f, static_cast<float>(y) + 0.5f})};
+			for (auto x{xBegin}; x < xEnd; ++x)
+			{
+				RawPoint const pos{
+					rowStart.x + static_cast<float>(x) * inv.m11, rowStart.y + static_cast<float>(x) * inv.m12
+				};
+				if (pos.x < 0.f or pos.y < 0.f or pos.x >= local.right or pos.y >= local.bottom)
+				{
+					continue;
+				}
+
+				std::uint32_t sample{};
+				if (interpolation == sc_NearestNeighbor)
+				{
+					sample = texel(originX + static_cast<int>(std::floor(fracLeft + pos.x)),
+						originY + static_cast<int>(std::floor(fracTop + pos.y)));
+				}
+				else
+				{
+					auto const u{fracLeft + pos.x - 0.5f};
+					auto const v{fracTop + pos.y - 0.5f};
+					auto const floorU{std::floor(u)};
+					auto const floorV{std::floor(v)};
+					auto const x0{originX + static_cast<int>(floorU)};
+					auto const y0{originY + static_cast<int>(floorV)};
+					auto const fx{u - floorU};
+					auto const fy{v - floorV};
+					sample = Lerp(
+						Lerp(texel(x0, y0), texel(x0 + 1, y0), fx),
+						Lerp(texel(x0, y0 + 1), texel(x0 + 1, y0 + 1), fx),
+						fy
+					);
+				}
+
+				auto& dst{row[static_cast<std::size_t>(x)]};
+				dst = PixelBuffer::BlendOver(dst, sample, coverage);
+			}
+		}
+	}
+}
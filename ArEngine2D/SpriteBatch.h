@@ -0,0 +1,183 @@
+#pragma once
+
+#include "RawTypes.h"
+#include "PixelBuffer.h"
+#include "Testing/ArTest20.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief one sprite of a batch; the source rect is drawn into the rect
+	 *		  {0, 0, src width, src height}, which is then moved by transform.
+	*/
+	struct SpriteBatchEntry
+	{
+		// a handle only the backend knows how to use.
+		std::uint64_t image;
+		RawRect src;
+		RawMatrix transform;
+		float opacity;
+		std::uint8_t interpolation;
+	};
+
+	/**
+	 * @brief collects a lot of sprites, so they can be drawn with one call per (image, interpolation) pair.
+	 *		  does not depend on direct2d; Grafix uses it for the real thing, and Composite
+	 *		  draws it on the cpu.
+	 *
+	 *		  grouping changes the draw order, so overlapping sprites of different images
+	 *		  may not be drawn in the order they were pushed.
+	*/
+	class SpriteBatch
+	{
+	public:
+
+		// same values as D2D1_BITMAP_INTERPOLATION_MODE.
+		constexpr static std::uint8_t sc_NearestNeighbor{0U};
+		constexpr static std::uint8_t sc_Linear{1U};
+
+		/**
+		 * @brief a range of entries that share the same image and interpolation mode.
+		*/
+		struct Group
+		{
+			std::uint64_t image;
+			std::uint8_t interpolation;
+			std::uint32_t first;
+			std::uint32_t count;
+		};
+
+	public:
+
+		SpriteBatch() = default;
+
+	public:
+
+		/**
+		 * @brief removes every entry; does not free any memory.
+		*/
+		void Begin() noexcept;
+
+		void Push(std::uint64_t image, RawRect const& src, RawMatrix const& transform,
+			float opacity = 1.f, std::uint8_t interpolation = sc_Linear
+		);
+
+		/**
+		 * @brief stable sorts the entries by (image, interpolation), then builds the groups.
+		 *		  pushing after this call requires another call before using Groups.
+		*/
+		void GroupEntries();
+
+		/**
+		 * @brief groups the entries if needed, then draws them onto target (source over).
+		 * @param images => the image handle of every entry is an index into this span.
+		*/
+		void Composite(PixelBuffer& target, std::span<PixelBuffer const> images);
+
+		/**
+		 * @brief draws a single sprite onto target (source over); nothing outside of clip is touched.
+		 *		  the image handle of the entry is ignored.
+		*/
+		static void CompositeEntry(PixelBuffer& target, PixelBuffer const& image, SpriteBatchEntry const& entry, RawRect const& clip);
+
+	public:
+
+		std::span<SpriteBatchEntry const> Entries() const noexcept;
+		std::span<Group const> Groups() const noexcept;
+		std::size_t Size() const noexcept;
+		bool IsEmpty() const noexcept;
+		bool IsGrouped() const noexcept;
+
+	private:
+		std::vector<SpriteBatchEntry> entries_{};
+		std::vector<Group> groups_{};
+		bool bGrouped_{true};
+	};
+
+	inline void TestSpriteBatch()
+	{
+		using namespace ArTest;
+		std::ofstream file{"SpriteBatchTestResults.txt"};
+		Tester tester{file};
+
+		constexpr std::uint32_t red{0xFF'FF'00'00U};
+		constexpr std::uint32_t blue{0xFF'00'00'FFU};
+		constexpr std::uint32_t black{0xFF'00'00'00U};
+
+		tester.NewTest("Grouping") = [&] {
+			SpriteBatch batch{};
+			batch.Begin();
+			batch.Push(1U, {}, RawMatrix::Identity());
+			batch.Push(0U, {}, RawMatrix::Identity());
+			batch.Push(1U, {}, RawMatrix::Translation(1.f, 0.f));
+			batch.Push(1U, {}, RawMatrix::Identity(), 1.f, SpriteBatch::sc_NearestNeighbor);
+			tester.PassIf(not batch.IsGrouped());
+			batch.GroupEntries();
+
+			auto const groups{batch.Groups()};
+			tester.PassIfEqual(groups.size(), std::size_t{3U});
+			tester.PassIfEqual(groups[0].image, std::uint64_t{0U});
+			tester.PassIfEqual(groups[1].image, std::uint64_t{1U});
+			tester.PassIfEqual(groups[1].interpolation, SpriteBatch::sc_NearestNeighbor);
+			tester.PassIfEqual(groups[2].count, std::uint32_t{2U});
+			// stable: the identity one was pushed first.
+			tester.PassIf(batch.Entries()[groups[2].first].transform == RawMatrix::Identity());
+		};
+
+		tester.NewTest("Pack and BlendOver") = [&] {
+			tester.PassIfEqual(PixelBuffer::Pack({1.f, 0.f, 0.f, 1.f}), std::uint32_t{red});
+			tester.PassIfEqual(PixelBuffer::Pack({1.f, 1.f, 1.f, 0.f}), std::uint32_t{0U});
+			tester.PassIfEqual(PixelBuffer::BlendOver(blue, red), std::uint32_t{red});
+			tester.PassIfEqual(PixelBuffer::BlendOver(blue, red, 0U), std::uint32_t{blue});
+			tester.PassIfEqual(PixelBuffer::BlendOver(blue, 0U), std::uint32_t{blue});
+		};
+
+		tester.NewTest("Composite copies") = [&] {
+			PixelBuffer image{2U, 2U, red};
+			image.At(1U, 1U) = blue;
+			PixelBuffer target{4U, 4U, black};
+
+			SpriteBatch batch{};
+			batch.Push(0U, {0.f, 0.f, 2.f, 2.f}, RawMatrix::Translation(1.f, 1.f), 1.f, SpriteBatch::sc_NearestNeighbor);
+			batch.Composite(target, std::span{&image, 1U});
+
+			tester.PassIfEqual(std::uint32_t{target.At(0U, 0U)}, std::uint32_t{black});
+			tester.PassIfEqual(std::uint32_t{target.At(1U, 1U)}, std::uint32_t{red});
+			tester.PassIfEqual(std::uint32_t{target.At(2U, 2U)}, std::uint32_t{blue});
+			tester.PassIfEqual(std::uint32_t{target.At(3U, 3U)}, std::uint32_t{black});
+		};
+
+		tester.NewTest("Composite scales and clips") = [&] {
+			PixelBuffer image{2U, 1U, red};
+			image.At(1U, 0U) = blue;
+			PixelBuffer target{3U, 2U, black};
+
+			SpriteBatch batch{};
+			RawMatrix const doubled{2.f, 0.f, 0.f, 2.f, 0.f, 0.f};
+			batch.Push(0U, {0.f, 0.f, 2.f, 1.f}, doubled, 1.f, SpriteBatch::sc_NearestNeighbor);
+			batch.Composite(target, std::span{&image, 1U});
+
+			tester.PassIfEqual(std::uint32_t{target.At(0U, 1U)}, std::uint32_t{red});
+			tester.PassIfEqual(std::uint32_t{target.At(1U, 0U)}, std::uint32_t{red});
+			tester.PassIfEqual(std::uint32_t{target.At(2U, 1U)}, std::uint32_t{blue});
+		};
+
+		tester.NewTest("Composite opacity") = [&] {
+			PixelBuffer image{1U, 1U, 0xFF'FF'FF'FFU};
+			PixelBuffer target{1U, 1U, black};
+
+			SpriteBatch batch{};
+			batch.Push(0U, {0.f, 0.f, 1.f, 1.f}, RawMatrix::Identity(), 0.5f);
+			batch.Composite(target, std::span{&image, 1U});
+
+			auto const gray{target.At(0U, 0U) & 0xFFU};
+			tester.PassIfGreaterEq(gray, 126U);
+			tester.PassIfLessEq(gray, 129U);
+		};
+
+		tester.OutputResults();
+	}
+}
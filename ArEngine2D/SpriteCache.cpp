@@ -0,0 +1,16 @@
+#include "SpriteCache.h"
+
+namespace ArEngine2D {
+	SpriteCache::SpriteCache(std::size_t budget, bool bMipmapped)
+		: AssetCache<Sprite>{
+			[bMipmapped](std::filesystem::path const& path) {
+				Sprite sprite{};
+				sprite.Initialize(path.native(), bMipmapped);
+				return sprite;
+			},
+			[](Sprite const& sprite) { return sprite.ByteSize(); },
+			budget
+		}
+	{
+	}
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include "AssetCache.h"
+#include "Sprite.h"
+
+namespace ArEngine2D {
+	/**
+	 * @brief sprites by file name; ten cars using the same png cost one decode and one bitmap.
+	 *		  the budget counts the bytes of the bitmaps.
+	*/
+	class SpriteCache : public AssetCache<Sprite>
+	{
+	public:
+
+		/**
+		 * @param bMipmapped => loads every sprite with a mip chain (see Sprite::Initialize).
+		*/
+		explicit SpriteCache(std::size_t budget = sc_NoBudget, bool bMipmapped = false);
+	};
+}
@@ -0,0 +1,59 @@
+#include "SpriteLoader.h"
+
+#include <chrono>
+
+namespace ArEngine2D {
+	PendingSprite::PendingSprite(std::shared_ptr<State> pState) noexcept
+		: pState_{std::move(pState)}
+	{
+	}
+	bool PendingSprite::IsValid() const noexcept
+	{
+		return pState_ != nullptr;
+	}
+	bool PendingSprite::IsReady() const
+	{
+		assert(IsValid() && "Use of an empty PendingSprite");
+		// the future gives its pixels away once, to the first Get.
+		return not pState_->pixels.valid()
+			or pState_->pixels.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+	}
+	Sprite const& PendingSprite::Get()
+	{
+		assert(IsValid() && "Use of an empty PendingSprite");
+		auto& state{*pState_};
+		if (not state.sprite.IsInitialized())
+		{
+			auto const pixels{state.pixels.valid() ? state.pixels.get() : std::nullopt};
+			if (not pixels or pixels->IsEmpty())
+			{
+				throw EngineError{"Failed to decode " + state.path.string()};
+			}
+			state.sprite.Initialize(*pixels);
+		}
+		return state.sprite;
+	}
+
+	SpriteLoader::SpriteLoader(JobSystem& jobs) noexcept
+		: jobs_{jobs}
+	{
+	}
+	SpriteLoader::~SpriteLoader()
+	{
+		// a failed decode is reported by its PendingSprite, so the decodes never throw.
+		jobs_.Wait(pending_);
+	}
+	PendingSprite SpriteLoader::Load(std::filesystem::path path)
+	{
+		auto pState{std::make_shared<PendingSprite::State>()};
+		pState->path = path;
+
+		// a JobSystem job has to be copyable, a packaged_task is not.
+		auto pTask{std::make_shared<std::packaged_task<std::optional<PixelBuffer>()>>(
+			[path = std::move(path)] { return ImageDecoder::DecodeFile(path); })};
+		pState->pixels = pTask->get_future();
+		jobs_.Submit([pTask] { (*pTask)(); }, pending_);
+
+		return PendingSprite{std::move(pState)};
+	}
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include "Sprite.h"
+#include "ImageDecoder.h"
+#include "JobSystem.h"
+#include "ISingle.h"
+
+#include <filesystem>
+#include <future>
+#include <memory>
+#include <optional>
+
+namespace ArEngine2D {
+	/**
+	 * @brief a sprite being decoded by a SpriteLoader. copies share the same sprite.
+	 *		  the pixels are decoded on a loader thread; the bitmap is created by the first
+	 *		  call to Get, which must happen on the thread that draws.
+	*/
+	class PendingSprite
+	{
+	public:
+
+		PendingSprite() = default;
+
+	public:
+
+		/**
+		 * @return false for default constructed handles.
+		*/
+		bool IsValid() const noexcept;
+
+		/**
+		 * @return true once Get would not block; never blocks.
+		*/
+		bool IsReady() const;
+
+		/**
+		 * @brief waits for the pixels if they are not decoded yet, and uploads them on the first call.
+		 *		  throws EngineError if the file could not be decoded.
+		*/
+		Sprite const& Get();
+
+	private:
+		friend class SpriteLoader;
+
+		struct State
+		{
+			std::filesystem::path path;
+			std::future<std::optional<PixelBuffer>> pixels;
+			Sprite sprite;
+		};
+
+		explicit PendingSprite(std::shared_ptr<State> pState) noexcept;
+
+	private:
+		std::shared_ptr<State> pState_{};
+	};
+
+	/**
+	 * @brief decodes sprites on the workers of a JobSystem (Engine::jobs, usually), so loading levels
+	 *		  does not stall drawing. only the decoding runs there; direct2d only ever sees the final
+	 *		  pixels. a single threaded JobSystem decodes right away, inside Load.
+	*/
+	class SpriteLoader : Details::ISingle
+	{
+	public:
+
+		/**
+		 * @param jobs => where files are decoded; must outlive the loader.
+		*/
+		explicit SpriteLoader(JobSystem& jobs) noexcept;
+
+		// finishes whatever it queued first, so no decoder outlives the loader.
+		~SpriteLoader();
+
+	public:
+
+		/**
+		 * @brief queues the file to be decoded; any format ImageDecoder supports.
+		*/
+		PendingSprite Load(std::filesystem::path path);
+
+	private:
+		JobSystem& jobs_;
+		// the decodes still running; other users of the JobSystem are not waited for.
+		JobCounter pending_{};
+	};
+}
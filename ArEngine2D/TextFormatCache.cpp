@@ -0,0 +1,99 @@
+#include "TextFormatCache.h"
+
+#include "IEngineError.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace ArEngine2D {
+	std::size_t TextFormatCache::KeyHash::operator()(Key const& key) const noexcept
+	{
+		auto const sizeBits{std::bit_cast<std::uint32_t>(key.size)};
+		std::size_t hash{key.family};
+		hash = hash * 31U + sizeBits;
+		hash = hash * 31U + static_cast<std::size_t>(key.weight);
+		return hash;
+	}
+	TextFormatCache::TextFormatCache(std::size_t capacity)
+		: formats_{capacity}
+	{ }
+	void TextFormatCache::Initialize(Details::Ptr<IDWriteFactory> pFactory)
+	{
+		assert(not pFactory_ && "double initialization of TextFormatCache");
+		pFactory_ = std::move(pFactory);
+	}
+	TextFormatCache::FamilyID TextFormatCache::RegisterFamily(std::wstring_view family)
+	{
+		if (auto const it{std::ranges::find(families_, family)}; it != families_.end())
+		{
+			return static_cast<FamilyID>(it - families_.begin());
+		}
+		families_.emplace_back(family);
+		return static_cast<FamilyID>(families_.size() - 1U);
+	}
+	std::wstring_view TextFormatCache::FamilyName(FamilyID family) const noexcept
+	{
+		assert(family < families_.size() && "Invalid font family id");
+		return families_[family];
+	}
+	IDWriteTextFormat* TextFormatCache::Get(FamilyID family, float size, FontWeight weight)
+	{
+		assert(pFactory_ && "Use of uninitialized TextFormatCache");
+		assert(family < families_.size() && "Invalid font family id");
+
+		auto const& pFormat{formats_.FindOrCreate({family, size, weight}, [&] {
+			Details::Ptr<IDWriteTextFormat> pNewFormat{};
+			HANDLE_GRAPHICS_ERROR(pFactory_->CreateTextFormat(
+				families_[family].c_str(), nullptr, ToDWriteWeight(weight), DWRITE_FONT_STYLE_NORMAL,
+				DWRITE_FONT_STRETCH_NORMAL, size, L"", &pNewFormat
+			));
+			return pNewFormat;
+		})};
+		return pFormat.Get();
+	}
+	std::wstring_view TextFormatCache::Widen(std::string_view str)
+	{
+		if (str.size() > wideBuffer_.capacity())
+		{
+			++wideGrowths_;
+		}
+		// assign does not shrink the capacity, so this stops allocating after a few frames.
+		wideBuffer_.assign(str.begin(), str.end());
+		return wideBuffer_;
+	}
+	void TextFormatCache::ResetCounters() noexcept
+	{
+		formats_.ResetCounters();
+		wideGrowths_ = 0U;
+	}
+	std::uint64_t TextFormatCache::Hits() const noexcept
+	{
+		return formats_.Hits();
+	}
+	std::uint64_t TextFormatCache::Misses() const noexcept
+	{
+		return formats_.Misses();
+	}
+	std::uint64_t TextFormatCache::Evictions() const noexcept
+	{
+		return formats_.Evictions();
+	}
+	std::uint64_t TextFormatCache::Allocations() const noexcept
+	{
+		return formats_.Misses() + wideGrowths_;
+	}
+	DWRITE_FONT_WEIGHT TextFormatCache::ToDWriteWeight(FontWeight weight)
+	{
+		switch (weight)
+		{
+		case FontWeight::Light:
+			return DWRITE_FONT_WEIGHT_LIGHT;
+		case FontWeight::Normal:
+			return DWRITE_FONT_WEIGHT_NORMAL;
+		case FontWeight::Bold:
+			return DWRITE_FONT_WEIGHT_BOLD;
+		default:
+			throw EngineError{"Invalid FontWeight passed to TextFormatCache"};
+		}
+	}
+}
@@ -0,0 +1,111 @@
+#pragma once
+
+#include "ImplUtil.h"
+#include "LruCache.h"
+
+#include <dwrite.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace ArEngine2D {
+	enum class FontWeight : std::uint32_t
+	{
+		Light,
+		Normal,
+		Bold,
+	};
+
+	/**
+	 * @brief owns every IDWriteTextFormat used by Grafix, so drawing the same kind of text
+	 *		  every frame does not create a new format every time.
+	*/
+	class TextFormatCache : Details::ISingle
+	{
+	public:
+
+		// index of a font family registered through RegisterFamily.
+		using FamilyID = std::uint32_t;
+
+	private:
+		constexpr static std::size_t sc_DefaultCapacity{32U};
+
+		struct Key
+		{
+			FamilyID family;
+			float size;
+			FontWeight weight;
+
+			bool operator==(Key const& rhs) const noexcept = default;
+		};
+
+		struct KeyHash
+		{
+			std::size_t operator()(Key const& key) const noexcept;
+		};
+
+	public:
+
+		explicit TextFormatCache(std::size_t capacity = sc_DefaultCapacity);
+
+	public:
+
+		/**
+		 * @brief users may not call this function.
+		*/
+		void Initialize(Details::Ptr<IDWriteFactory> pFactory);
+
+		/**
+		 * @brief registering the same family twice returns the same id.
+		 * @return an id that can be used to look up formats of that family.
+		*/
+		FamilyID RegisterFamily(std::wstring_view family);
+
+		/**
+		 * @return the name the family was registered with.
+		*/
+		std::wstring_view FamilyName(FamilyID family) const noexcept;
+
+		/**
+		 * @brief creates the format only if it's not in the cache already.
+		 * @return a format owned by the cache, valid until it gets evicted.
+		*/
+		IDWriteTextFormat* Get(FamilyID family, float size, FontWeight weight);
+
+		/**
+		 * @brief converts an ascii string into a wide string stored in a reused buffer.
+		 * @return a view that's valid until the next call to this function.
+		*/
+		std::wstring_view Widen(std::string_view str);
+
+		/**
+		 * @brief sets all the counters back to zero, called once every frame.
+		*/
+		void ResetCounters() noexcept;
+
+	public:
+
+		std::uint64_t Hits() const noexcept;
+		std::uint64_t Misses() const noexcept;
+		std::uint64_t Evictions() const noexcept;
+
+		/**
+		 * @return how many times text allocated memory since the last reset;
+		 *		   counts created formats and wide buffer growths.
+		*/
+		std::uint64_t Allocations() const noexcept;
+
+	private:
+		static DWRITE_FONT_WEIGHT ToDWriteWeight(FontWeight weight);
+
+	private:
+		Details::Ptr<IDWriteFactory> pFactory_{};
+		LruCache<Key, Details::Ptr<IDWriteTextFormat>, KeyHash> formats_;
+		std::vector<std::wstring> families_{};
+
+		// reused by Widen, only grows.
+		std::wstring wideBuffer_{};
+		std::uint64_t wideGrowths_{};
+	};
+}
@@ -0,0 +1,124 @@
+#include "TextLayout.h"
+
+#include "IEngineError.h"
+
+#include <limits>
+
+namespace ArEngine2D {
+	TextLayout::TextLayout(std::string_view text, float size)
+		: text_{text}, size_{size}
+	{ }
+	void TextLayout::SetText(std::string_view text)
+	{
+		if (text == text_)
+		{
+			return;
+		}
+		// assign keeps the capacity, so a label that keeps changing stops allocating.
+		text_.assign(text);
+		Invalidate();
+	}
+	void TextLayout::SetSize(float size)
+	{
+		if (size == size_)
+		{
+			return;
+		}
+		size_ = size;
+		Invalidate();
+	}
+	void TextLayout::SetFont(std::wstring_view family, FontWeight weight)
+	{
+		AR2D_ASSERT(s_pFormatCache_, "Did not call InternalInitialization");
+		auto const newFamily{s_pFormatCache_->RegisterFamily(family)};
+		if (newFamily == family_ and weight == weight_)
+		{
+			return;
+		}
+		family_ = newFamily;
+		weight_ = weight;
+		Invalidate();
+	}
+	void TextLayout::InternalInitialization(Details::Ptr<IDWriteFactory> pFactory, TextFormatCache* pFormatCache)
+	{
+		assert(not s_pDWriteFactory_ && "Double internal initialization of TextLayout");
+		s_pDWriteFactory_ = std::move(pFactory);
+		s_pFormatCache_ = pFormatCache;
+	}
+	std::uint64_t TextLayout::BuildCount() noexcept
+	{
+		return s_BuildCount_;
+	}
+	void TextLayout::ResetBuildCount() noexcept
+	{
+		s_BuildCount_ = 0U;
+	}
+	std::string_view TextLayout::Text() const noexcept
+	{
+		return text_;
+	}
+	float TextLayout::Size() const noexcept
+	{
+		return size_;
+	}
+	TextFormatCache::FamilyID TextLayout::Family() const noexcept
+	{
+		return family_;
+	}
+	FontWeight TextLayout::Weight() const noexcept
+	{
+		return weight_;
+	}
+	float TextLayout::Width() const
+	{
+		LazyEval();
+		return width_;
+	}
+	float TextLayout::Height() const
+	{
+		LazyEval();
+		return height_;
+	}
+	D2D1_SIZE_F TextLayout::Bounds() const
+	{
+		LazyEval();
+		return {width_, height_};
+	}
+	Details::Ptr<IDWriteTextLayout> const& TextLayout::D2DPtr() const
+	{
+		LazyEval();
+		return pLayout_;
+	}
+	void TextLayout::Invalidate() noexcept
+	{
+		bUpToDate_ = false;
+	}
+	void TextLayout::LazyEval() const
+	{
+		if (bUpToDate_)
+		{
+			return;
+		}
+
+		AR2D_ASSERT(s_pDWriteFactory_, "Did not call InternalInitialization");
+
+		// same conversion Grafix::DrawStringRect does, so both end up the same size.
+		auto const fontSize{size_ * (1.f / 0.55f)};
+		auto const pFormat{s_pFormatCache_->Get(family_, fontSize, weight_)};
+		auto const wstr{s_pFormatCache_->Widen(text_)};
+
+		pLayout_.Reset();
+		HANDLE_GRAPHICS_ERROR(s_pDWriteFactory_->CreateTextLayout(
+			wstr.data(), static_cast<UINT32>(wstr.size()), pFormat,
+			std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), &pLayout_
+		));
+
+		DWRITE_TEXT_METRICS metrics{};
+		HANDLE_GRAPHICS_ERROR(pLayout_->GetMetrics(&metrics));
+		width_ = metrics.widthIncludingTrailingWhitespace;
+		height_ = metrics.height;
+
+		++s_BuildCount_;
+		bUpToDate_ = true;
+	}
+}
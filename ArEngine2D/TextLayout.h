@@ -0,0 +1,120 @@
+#pragma once
+
+#include "ImplUtil.h"
+#include "EngineCore.h"
+#include "TextFormatCache.h"
+
+#include <dwrite.h>
+#include <d2d1.h>
+
+#include <string>
+#include <string_view>
+
+namespace ArEngine2D {
+	/**
+	 * @brief a piece of text that's shaped once and then drawn as many times as needed.
+	 *		  shaping happens lazily, and only again after the text, size or font changes.
+	*/
+	class TextLayout
+	{
+	private:
+		using self = TextLayout;
+
+	private:
+		inline static Details::Ptr<IDWriteFactory> s_pDWriteFactory_{};
+		inline static TextFormatCache* s_pFormatCache_{};
+		inline static std::uint64_t s_BuildCount_{};
+
+	public:
+
+		TextLayout() = default;
+		TextLayout(std::string_view text, float size);
+
+		TextLayout(self const&)				  = default;
+		TextLayout(self&&) noexcept			  = default;
+		self& operator=(self const&)		  = default;
+		self& operator=(self&&) noexcept	  = default;
+
+	public:
+
+		/**
+		 * @brief does nothing (and does not invalidate the layout) if the text did not change.
+		*/
+		void SetText(std::string_view text);
+
+		/**
+		 * @brief does nothing (and does not invalidate the layout) if the size did not change.
+		 * @param size => same units as the size passed to Grafix::DrawString.
+		*/
+		void SetSize(float size);
+
+		/**
+		 * @brief the family defaults to the first one registered by Grafix.
+		*/
+		void SetFont(std::wstring_view family, FontWeight weight = FontWeight::Normal);
+
+	public:
+
+		/**
+		 * @brief users may not call this function.
+		*/
+		static void InternalInitialization(Details::Ptr<IDWriteFactory> pFactory, TextFormatCache* pFormatCache);
+
+		/**
+		 * @return the number of layouts shaped since the last call to ResetBuildCount.
+		*/
+		static std::uint64_t BuildCount() noexcept;
+
+		/**
+		 * @brief users may not call this function.
+		*/
+		static void ResetBuildCount() noexcept;
+
+	public:
+
+		std::string_view Text() const noexcept;
+		float Size() const noexcept;
+		TextFormatCache::FamilyID Family() const noexcept;
+		FontWeight Weight() const noexcept;
+
+		/**
+		 * @brief shapes the text if it's out of date.
+		 * @return the measured width of the text (including trailing white space).
+		*/
+		float Width() const;
+
+		/**
+		 * @brief shapes the text if it's out of date.
+		 * @return the measured height of the text.
+		*/
+		float Height() const;
+
+		/**
+		 * @brief shapes the text if it's out of date.
+		 * @return both width and height of the text.
+		*/
+		D2D1_SIZE_F Bounds() const;
+
+		/**
+		 * @brief shapes the text if it's out of date.
+		 * @return a pointer to the shaped layout; users may not release the data through this pointer.
+		*/
+		Details::Ptr<IDWriteTextLayout> const& D2DPtr() const;
+
+	private:
+		void Invalidate() noexcept;
+		void LazyEval() const;
+
+	private:
+		std::string text_{};
+		float size_{};
+		TextFormatCache::FamilyID family_{};
+		FontWeight weight_{FontWeight::Normal};
+
+		// lazy eval
+		mutable bool bUpToDate_{};
+		mutable Details::Ptr<IDWriteTextLayout> pLayout_{};
+		mutable float width_{};
+		mutable float height_{};
+	};
+}
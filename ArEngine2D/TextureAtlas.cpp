@@ -0,0 +1,331 @@
+#include "TextureAtlas.h"
+#include "ImageDecoder.h"
+#include "ImageFile.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+
+namespace ArEngine2D {
+	namespace {
+		constexpr std::string_view sc_ManifestTag{"ar2d_atlas"};
+		constexpr std::uint32_t sc_ManifestVersion{1U};
+
+		std::filesystem::path PagePath(std::filesystem::path const& directory, std::string_view stem, std::size_t page,
+			std::string_view extension)
+		{
+			return directory / (std::string{stem} + '_' + std::to_string(page) + std::string{extension});
+		}
+		std::filesystem::path ManifestPath(std::filesystem::path const& directory, std::string_view stem)
+		{
+			return directory / (std::string{stem} + ".atlas");
+		}
+	}
+
+	RawRect AtlasRegion::Rect() const noexcept
+	{
+		return {
+			static_cast<float>(x), static_cast<float>(y), static_cast<float>(x + width), static_cast<float>(y + height)
+		};
+	}
+
+	SkylinePacker::SkylinePacker(std::uint32_t pageWidth, std::uint32_t pageHeight)
+		: pageWidth_{pageWidth}, pageHeight_{pageHeight}
+	{
+		assert(pageWidth and pageHeight && "SkylinePacker pages must not be empty");
+	}
+	std::optional<AtlasRegion> SkylinePacker::Insert(std::uint32_t width, std::uint32_t height)
+	{
+		if (width > pageWidth_ or height > pageHeight_)
+		{
+			return std::nullopt;
+		}
+
+		for (std::size_t page{}; page <= pages_.size(); ++page)
+		{
+			if (page == pages_.size())
+			{
+				pages_.push_back({Segment{0U, 0U, pageWidth_}});
+			}
+
+			// the lowest top wins, the narrowest segment breaks ties.
+			auto& skyline{pages_[page]};
+			auto bestIndex{skyline.size()};
+			auto bestTop{std::numeric_limits<std::uint32_t>::max()};
+			auto bestWidth{std::numeric_limits<std::uint32_t>::max()};
+			for (std::size_t i{}; i < skyline.size(); ++i)
+			{
+				auto const y{FitAt(skyline, i, width, height)};
+				if (y and (*y + height < bestTop or (*y + height == bestTop and skyline[i].width < bestWidth)))
+				{
+					bestIndex = i;
+					bestTop = *y + height;
+					bestWidth = skyline[i].width;
+				}
+			}
+			if (bestIndex == skyline.size())
+			{
+				continue;
+			}
+
+			AtlasRegion const region{static_cast<std::uint32_t>(page), skyline[bestIndex].x, bestTop - height, width, height};
+			Place(skyline, bestIndex, width, bestTop);
+			return region;
+		}
+		// a fresh page always fits the rectangle.
+		assert(false && "SkylinePacker could not place a rectangle on an empty page");
+		return std::nullopt;
+	}
+	std::size_t SkylinePacker::PageCount() const noexcept
+	{
+		return pages_.size();
+	}
+	std::uint32_t SkylinePacker::PageWidth() const noexcept
+	{
+		return pageWidth_;
+	}
+	std::uint32_t SkylinePacker::PageHeight() const noexcept
+	{
+		return pageHeight_;
+	}
+	std::optional<std::uint32_t> SkylinePacker::FitAt(Skyline const& skyline, std::size_t index, std::uint32_t width,
+		std::uint32_t height) const
+	{
+		if (skyline[index].x + width > pageWidth_)
+		{
+			return std::nullopt;
+		}
+
+		// the rectangle rests on the highest segment under it.
+		std::uint32_t y{};
+		std::uint32_t covered{};
+		for (auto i{index}; covered < width; ++i)
+		{
+			assert(i < skyline.size());
+			y = std::max(y, skyline[i].y);
+			covered += skyline[i].width;
+		}
+		if (y + height > pageHeight_)
+		{
+			return std::nullopt;
+		}
+		return y;
+	}
+	void SkylinePacker::Place(Skyline& skyline, std::size_t index, std::uint32_t width, std::uint32_t top)
+	{
+		auto const x{skyline[index].x};
+		skyline.insert(skyline.begin() + static_cast<std::ptrdiff_t>(index), Segment{x, top, width});
+
+		// cut what the new segment covers out of the ones after it.
+		auto const right{x + width};
+		auto next{index + 1U};
+		while (next < skyline.size() and skyline[next].x < right)
+		{
+			auto& segment{skyline[next]};
+			auto const segmentRight{segment.x + segment.width};
+			if (segmentRight <= right)
+			{
+				skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(next));
+				continue;
+			}
+			segment.width = segmentRight - right;
+			segment.x = right;
+			break;
+		}
+
+		// neighbours at the same height are one segment.
+		for (std::size_t i{1U}; i < skyline.size();)
+		{
+			if (skyline[i - 1U].y == skyline[i].y)
+			{
+				skyline[i - 1U].width += skyline[i].width;
+				skyline.erase(skyline.begin() + static_cast<std::ptrdiff_t>(i));
+			}
+			else
+			{
+				++i;
+			}
+		}
+	}
+
+	TextureAtlas::TextureAtlas(std::uint32_t pageWidth, std::uint32_t pageHeight, std::uint32_t padding)
+		: pageWidth_{pageWidth}, pageHeight_{pageHeight}, padding_{padding}, packer_{std::in_place, pageWidth, pageHeight}
+	{
+	}
+	std::optional<TextureAtlas> TextureAtlas::Pack(std::vector<NamedImage> images, std::uint32_t pageWidth,
+		std::uint32_t pageHeight, std::uint32_t padding)
+	{
+		std::ranges::stable_sort(images, std::ranges::greater{}, [](NamedImage const& image) {
+			return image.second.Height();
+		});
+
+		TextureAtlas atlas{pageWidth, pageHeight, padding};
+		for (auto& [name, image] : images)
+		{
+			if (not atlas.Add(std::move(name), image))
+			{
+				return std::nullopt;
+			}
+		}
+		return atlas;
+	}
+	std::optional<TextureAtlas> TextureAtlas::PackFiles(std::span<std::filesystem::path const> files,
+		std::uint32_t pageWidth, std::uint32_t pageHeight, std::uint32_t padding)
+	{
+		std::vector<NamedImage> images{};
+		images.reserve(files.size());
+		for (auto const& path : files)
+		{
+			auto pixels{ImageDecoder::DecodeFile(path)};
+			if (not pixels)
+			{
+				return std::nullopt;
+			}
+			images.emplace_back(path.stem().string(), std::move(*pixels));
+		}
+		return Pack(std::move(images), pageWidth, pageHeight, padding);
+	}
+	std::optional<AtlasRegion> TextureAtlas::Add(std::string name, PixelBuffer const& image)
+	{
+		assert(packer_ && "Tried to add to a loaded TextureAtlas");
+		assert(not lut_.contains(name) && "TextureAtlas image names must be unique");
+		if (image.IsEmpty())
+		{
+			return std::nullopt;
+		}
+
+		auto const width{static_cast<std::uint32_t>(image.Width())};
+		auto const height{static_cast<std::uint32_t>(image.Height())};
+		auto const padded{packer_->Insert(width + 2U * padding_, height + 2U * padding_)};
+		if (not padded)
+		{
+			return std::nullopt;
+		}
+
+		AtlasRegion const region{padded->page, padded->x + padding_, padded->y + padding_, width, height};
+		if (region.page == pages_.size())
+		{
+			pages_.emplace_back(pageWidth_, pageHeight_);
+			usedArea_.push_back(0U);
+		}
+		Blit(image, region);
+		usedArea_[region.page] += std::uint64_t{width} * height;
+
+		lut_.emplace(name, regions_.size());
+		regions_.emplace_back(std::move(name), region);
+		return region;
+	}
+	bool TextureAtlas::Save(std::filesystem::path const& directory, std::string_view stem, std::string_view extension) const
+	{
+		for (std::size_t page{}; page < pages_.size(); ++page)
+		{
+			if (not ImageFile::Save(pages_[page], PagePath(directory, stem, page, extension)))
+			{
+				return false;
+			}
+		}
+
+		std::ofstream file{ManifestPath(directory, stem)};
+		file << sc_ManifestTag << ' ' << sc_ManifestVersion << '\n'
+			 << pageWidth_ << ' ' << pageHeight_ << ' ' << padding_ << ' ' << pages_.size() << ' ' << regions_.size() << '\n';
+		for (auto const& [name, region] : regions_)
+		{
+			file << std::quoted(name) << ' ' << region.page << ' ' << region.x << ' ' << region.y << ' '
+				 << region.width << ' ' << region.height << '\n';
+		}
+		return static_cast<bool>(file);
+	}
+	std::optional<TextureAtlas> TextureAtlas::Load(std::filesystem::path const& directory, std::string_view stem,
+		std::string_view extension)
+	{
+		std::ifstream file{ManifestPath(directory, stem)};
+		std::string tag{};
+		std::uint32_t version{};
+		std::uint32_t pageWidth{};
+		std::uint32_t pageHeight{};
+		std::uint32_t padding{};
+		std::size_t pageCount{};
+		std::size_t regionCount{};
+		file >> tag >> version >> pageWidth >> pageHeight >> padding >> pageCount >> regionCount;
+		if (not file or tag != sc_ManifestTag or version != sc_ManifestVersion or not pageWidth or not pageHeight)
+		{
+			return std::nullopt;
+		}
+
+		TextureAtlas atlas{pageWidth, pageHeight, padding};
+		atlas.packer_.reset();
+		for (std::size_t page{}; page < pageCount; ++page)
+		{
+			auto pixels{ImageDecoder::DecodeFile(PagePath(directory, stem, page, extension))};
+			if (not pixels or pixels->Width() != pageWidth or pixels->Height() != pageHeight)
+			{
+				return std::nullopt;
+			}
+			atlas.pages_.push_back(std::move(*pixels));
+			atlas.usedArea_.push_back(0U);
+		}
+		for (std::size_t i{}; i < regionCount; ++i)
+		{
+			std::string name{};
+			AtlasRegion region{};
+			file >> std::quoted(name) >> region.page >> region.x >> region.y >> region.width >> region.height;
+			if (not file or region.page >= pageCount or region.x + region.width > pageWidth
+				or region.y + region.height > pageHeight)
+			{
+				return std::nullopt;
+			}
+			atlas.usedArea_[region.page] += std::uint64_t{region.width} * region.height;
+			atlas.lut_.emplace(name, atlas.regions_.size());
+			atlas.regions_.emplace_back(std::move(name), region);
+		}
+		return atlas;
+	}
+	AtlasRegion const* TextureAtlas::Find(std::string_view name) const
+	{
+		auto const it{lut_.find(std::string{name})};
+		return it == lut_.end() ? nullptr : &regions_[it->second].second;
+	}
+	std::span<PixelBuffer const> TextureAtlas::Pages() const noexcept
+	{
+		return pages_;
+	}
+	std::span<std::pair<std::string, AtlasRegion> const> TextureAtlas::Regions() const noexcept
+	{
+		return regions_;
+	}
+	float TextureAtlas::PageUsage(std::size_t page) const
+	{
+		assert(page < pages_.size() && "TextureAtlas page out of range");
+		return static_cast<float>(static_cast<double>(usedArea_[page]) / (static_cast<double>(pageWidth_) * pageHeight_));
+	}
+	std::uint32_t TextureAtlas::PageWidth() const noexcept
+	{
+		return pageWidth_;
+	}
+	std::uint32_t TextureAtlas::PageHeight() const noexcept
+	{
+		return pageHeight_;
+	}
+	std::uint32_t TextureAtlas::Padding() const noexcept
+	{
+		return padding_;
+	}
+	void TextureAtlas::Blit(PixelBuffer const& image, AtlasRegion const& region)
+	{
+		auto& page{pages_[region.page]};
+		auto const pad{static_cast<std::int64_t>(padding_)};
+		auto const width{static_cast<std::int64_t>(region.width)};
+		auto const height{static_cast<std::int64_t>(region.height)};
+		// the padding repeats the nearest edge pixel, like a clamped sampler would.
+		for (auto y{-pad}; y < height + pad; ++y)
+		{
+			auto const srcRow{image.Row(static_cast<std::size_t>(std::clamp<std::int64_t>(y, 0, height - 1)))};
+			auto const dstRow{page.Row(static_cast<std::size_t>(region.y + y))};
+			for (auto x{-pad}; x < width + pad; ++x)
+			{
+				dstRow[static_cast<std::size_t>(region.x + x)] = srcRow[static_cast<std::size_t>(std::clamp<std::int64_t>(x, 0, width - 1))];
+			}
+		}
+	}
+}
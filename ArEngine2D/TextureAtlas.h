@@ -0,0 +1,298 @@
+#pragma once
+
+#include "RawTypes.h"
+#include "PixelBuffer.h"
+#include "SpriteBatch.h"
+#include "Testing/ArTest20.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief where an image ended up inside an atlas.
+	*/
+	struct AtlasRegion
+	{
+		std::uint32_t page;
+		std::uint32_t x;
+		std::uint32_t y;
+		std::uint32_t width;
+		std::uint32_t height;
+
+		RawRect Rect() const noexcept;
+		bool operator==(AtlasRegion const& rhs) const noexcept = default;
+	};
+
+	/**
+	 * @brief places rectangles on fixed size pages with the skyline bottom-left heuristic: every page
+	 *		  keeps the top edge of what was placed so far, and a rectangle goes wherever its top would
+	 *		  be the lowest. a new page is started when none of the others has room.
+	*/
+	class SkylinePacker
+	{
+	public:
+
+		SkylinePacker(std::uint32_t pageWidth, std::uint32_t pageHeight);
+
+	public:
+
+		/**
+		 * @return nothing if the rectangle is bigger than a page.
+		*/
+		std::optional<AtlasRegion> Insert(std::uint32_t width, std::uint32_t height);
+
+	public:
+
+		std::size_t PageCount() const noexcept;
+		std::uint32_t PageWidth() const noexcept;
+		std::uint32_t PageHeight() const noexcept;
+
+	private:
+
+		struct Segment
+		{
+			std::uint32_t x;
+			std::uint32_t y;
+			std::uint32_t width;
+		};
+		using Skyline = std::vector<Segment>;
+
+	private:
+		// the y a rectangle starting at segment index would sit at, if it fits.
+		std::optional<std::uint32_t> FitAt(Skyline const& skyline, std::size_t index, std::uint32_t width, std::uint32_t height) const;
+		static void Place(Skyline& skyline, std::size_t index, std::uint32_t width, std::uint32_t top);
+
+	private:
+		std::uint32_t pageWidth_;
+		std::uint32_t pageHeight_;
+		std::vector<Skyline> pages_{};
+	};
+
+	/**
+	 * @brief packs named images into a few big pages, so they can share a bitmap (and a sprite batch).
+	 *		  every image is surrounded by padding pixels copied from its own edges, so filtering
+	 *		  near an edge never picks up the neighbours.
+	 *		  does not depend on direct2d; SpriteAtlas uploads the pages.
+	*/
+	class TextureAtlas
+	{
+	public:
+
+		using NamedImage = std::pair<std::string, PixelBuffer>;
+
+		constexpr static std::uint32_t sc_DefaultPageSize{2048U};
+		constexpr static std::uint32_t sc_DefaultPadding{1U};
+
+	public:
+
+		explicit TextureAtlas(std::uint32_t pageWidth = sc_DefaultPageSize, std::uint32_t pageHeight = sc_DefaultPageSize,
+			std::uint32_t padding = sc_DefaultPadding);
+
+	public:
+
+		/**
+		 * @brief packs the images tallest first, which wastes less space than adding them one by one.
+		 * @return nothing if one of them does not fit in a page.
+		*/
+		static std::optional<TextureAtlas> Pack(std::vector<NamedImage> images, std::uint32_t pageWidth = sc_DefaultPageSize,
+			std::uint32_t pageHeight = sc_DefaultPageSize, std::uint32_t padding = sc_DefaultPadding);
+
+		/**
+		 * @brief decodes the files with ImageDecoder, and packs them named after their stems.
+		 * @return nothing if a file can not be decoded, or does not fit in a page.
+		*/
+		static std::optional<TextureAtlas> PackFiles(std::span<std::filesystem::path const> files,
+			std::uint32_t pageWidth = sc_DefaultPageSize, std::uint32_t pageHeight = sc_DefaultPageSize,
+			std::uint32_t padding = sc_DefaultPadding);
+
+		/**
+		 * @brief adds one more image, on a new page if the others are full.
+		 *		  names must be unique; atlases that were loaded can not be added to.
+		 * @return nothing if the image does not fit in a page.
+		*/
+		std::optional<AtlasRegion> Add(std::string name, PixelBuffer const& image);
+
+		/**
+		 * @brief writes every page as <stem>_<page><extension>, and the regions to <stem>.atlas.
+		 * @return false if any of the files could not be written.
+		*/
+		bool Save(std::filesystem::path const& directory, std::string_view stem, std::string_view extension = ".png") const;
+
+		/**
+		 * @brief reads back what Save wrote; the pages are decoded with ImageDecoder.
+		*/
+		static std::optional<TextureAtlas> Load(std::filesystem::path const& directory, std::string_view stem,
+			std::string_view extension = ".png");
+
+	public:
+
+		/**
+		 * @return nullptr if there is no image with that name.
+		*/
+		AtlasRegion const* Find(std::string_view name) const;
+
+		std::span<PixelBuffer const> Pages() const noexcept;
+
+		/**
+		 * @return every region, in the order the images were added.
+		*/
+		std::span<std::pair<std::string, AtlasRegion> const> Regions() const noexcept;
+
+		/**
+		 * @return the fraction of the page covered by images, padding not included.
+		*/
+		float PageUsage(std::size_t page) const;
+
+		std::uint32_t PageWidth() const noexcept;
+		std::uint32_t PageHeight() const noexcept;
+		std::uint32_t Padding() const noexcept;
+
+	private:
+		void Blit(PixelBuffer const& image, AtlasRegion const& region);
+
+	private:
+		std::uint32_t pageWidth_;
+		std::uint32_t pageHeight_;
+		std::uint32_t padding_;
+		// loaded atlases do not have one.
+		std::optional<SkylinePacker> packer_;
+
+		std::vector<PixelBuffer> pages_{};
+		std::vector<std::uint64_t> usedArea_{};
+		std::vector<std::pair<std::string, AtlasRegion>> regions_{};
+		std::unordered_map<std::string, std::size_t> lut_{};
+	};
+
+	inline void TestTextureAtlas()
+	{
+		using namespace ArTest;
+		std::ofstream file{"TextureAtlasTestResults.txt"};
+		Tester tester{file};
+
+		// every image gets its own color, with a white corner.
+		auto const makeImage = [](std::size_t width, std::size_t height, std::uint32_t seed) {
+			PixelBuffer image{width, height, 0xFF'00'00'00U | (seed * 0x00'25'49'6DU & 0x00'FF'FF'FFU)};
+			image.At(width - 1U, height - 1U) = 0xFF'FF'FF'FFU;
+			return image;
+		};
+
+		tester.NewTest("Skyline never overlaps") = [&] {
+			SkylinePacker packer{64U, 64U};
+			std::vector<AtlasRegion> placed{};
+			for (std::uint32_t i{}; i < 40U; ++i)
+			{
+				auto const region{packer.Insert(5U + i % 7U * 3U, 4U + i % 5U * 4U)};
+				tester.PassIf(region.has_value());
+				placed.push_back(*region);
+			}
+			tester.PassIf(not packer.Insert(65U, 1U).has_value());
+
+			bool bOverlaps{};
+			bool bOutside{};
+			for (std::size_t i{}; i < placed.size(); ++i)
+			{
+				auto const& a{placed[i]};
+				bOutside = bOutside or a.x + a.width > 64U or a.y + a.height > 64U;
+				for (std::size_t j{i + 1U}; j < placed.size(); ++j)
+				{
+					auto const& b{placed[j]};
+					bOverlaps = bOverlaps or (a.page == b.page and a.x < b.x + b.width and b.x < a.x + a.width
+						and a.y < b.y + b.height and b.y < a.y + a.height);
+				}
+			}
+			tester.PassIf(not bOverlaps);
+			tester.PassIf(not bOutside);
+			tester.PassIfGreaterEq(packer.PageCount(), 2U);
+		};
+
+		tester.NewTest("Usage and padding") = [&] {
+			TextureAtlas atlas{32U, 32U, 1U};
+			auto const region{atlas.Add("a", makeImage(8U, 4U, 1U))};
+			tester.PassIf(region.has_value());
+			tester.PassIf(atlas.Find("a") != nullptr);
+			tester.PassIf(atlas.Find("b") == nullptr);
+			tester.PassIfEqual(atlas.PageUsage(0U), 32.f / 1024.f);
+
+			// the padding repeats the edges.
+			auto const& page{atlas.Pages()[0U]};
+			tester.PassIfEqual(page.At(region->x - 1U, region->y - 1U), page.At(region->x, region->y));
+			tester.PassIfEqual(page.At(region->x + 8U, region->y + 4U), 0xFF'FF'FF'FFU);
+			tester.PassIf(not atlas.Add("big", PixelBuffer{31U, 31U}).has_value());
+		};
+
+		tester.NewTest("Drawing from the atlas matches the files") = [&] {
+			std::vector<TextureAtlas::NamedImage> images{};
+			for (std::uint32_t i{}; i < 12U; ++i)
+			{
+				images.emplace_back("image" + std::to_string(i), makeImage(3U + i % 4U * 2U, 2U + i % 3U * 3U, i + 1U));
+			}
+			auto const atlas{TextureAtlas::Pack(images, 32U, 32U)};
+			tester.PassIf(atlas.has_value());
+
+			// scaled and rotated, with both filters.
+			RawMatrix const transform{1.7f, 0.4f, -0.4f, 1.7f, 9.3f, 4.1f};
+			RawRect const clip{0.f, 0.f, 40.f, 40.f};
+			bool bSame{true};
+			for (auto const interpolation : {SpriteBatch::sc_NearestNeighbor, SpriteBatch::sc_Linear})
+			{
+				for (auto const& [name, image] : images)
+				{
+					PixelBuffer expected{40U, 40U, 0xFF'10'10'10U};
+					PixelBuffer actual{expected};
+					SpriteBatchEntry entry{0U, {0.f, 0.f, static_cast<float>(image.Width()), static_cast<float>(image.Height())},
+						transform, 1.f, interpolation
+					};
+					SpriteBatch::CompositeEntry(expected, image, entry, clip);
+
+					auto const& region{*atlas->Find(name)};
+					entry.src = region.Rect();
+					SpriteBatch::CompositeEntry(actual, atlas->Pages()[region.page], entry, clip);
+					bSame = bSame and actual == expected;
+				}
+			}
+			tester.PassIf(bSame);
+		};
+
+		tester.NewTest("Save and load") = [&] {
+			TextureAtlas atlas{16U, 16U};
+			atlas.Add("one", makeImage(5U, 5U, 3U));
+			atlas.Add("two words", makeImage(12U, 9U, 4U));
+			auto const directory{std::filesystem::temp_directory_path()};
+			// ppm has no alpha, which the opaque test images do not need.
+			tester.PassIf(atlas.Save(directory, "ar2d_atlas_test", ".ppm"));
+
+			auto const loaded{TextureAtlas::Load(directory, "ar2d_atlas_test", ".ppm")};
+			tester.PassIf(loaded.has_value());
+			tester.PassIfEqual(loaded->Pages().size(), atlas.Pages().size());
+			auto const& region{*atlas.Find("two words")};
+			tester.PassIf(*loaded->Find("two words") == region);
+			// only the images, the empty parts of the page lose their alpha.
+			bool bSame{true};
+			for (auto y{region.y}; y < region.y + region.height; ++y)
+			{
+				for (auto x{region.x}; x < region.x + region.width; ++x)
+				{
+					bSame = bSame and loaded->Pages()[region.page].At(x, y) == atlas.Pages()[region.page].At(x, y);
+				}
+			}
+			tester.PassIf(bSame);
+			tester.PassIfEqual(loaded->PageUsage(1U), atlas.PageUsage(1U));
+
+			std::filesystem::remove(directory / "ar2d_atlas_test.atlas");
+			for (std::size_t page{}; page < atlas.Pages().size(); ++page)
+			{
+				std::filesystem::remove(directory / ("ar2d_atlas_test_" + std::to_string(page) + ".ppm"));
+			}
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -0,0 +1,233 @@
+#include "TraceWriter.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <optional>
+
+namespace ArEngine2D {
+	namespace {
+		using Clock = ProfiledZone::Clock;
+
+		void WriteString(std::ostream& out, std::string_view text)
+		{
+			out << '"';
+			for (auto const c : text)
+			{
+				switch (c)
+				{
+				case '"':  out << "\\\""; break;
+				case '\\': out << "\\\\"; break;
+				case '\n': out << "\\n";  break;
+				case '\t': out << "\\t";  break;
+				default:
+					if (static_cast<unsigned char>(c) < 0x20U)
+					{
+						out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c)
+							<< std::dec << std::setfill(' ');
+					}
+					else
+					{
+						out << c;
+					}
+				}
+			}
+			out << '"';
+		}
+
+		// the first event of a trace goes without a comma.
+		class EventWriter
+		{
+		public:
+
+			EventWriter(std::ostream& out, Clock::time_point origin) : out_{out}, origin_{origin}
+			{
+			}
+
+			void ThreadName(std::size_t thread, std::string_view name)
+			{
+				Begin("thread_name", "M", thread);
+				out_ << ",\"args\":{\"name\":";
+				WriteString(out_, name);
+				out_ << "}}";
+			}
+
+			void Complete(std::string_view name, std::string_view category, std::size_t thread,
+				Clock::time_point begin, Clock::time_point end)
+			{
+				Begin(name, "X", thread);
+				out_ << ",\"cat\":\"" << category << "\",\"ts\":" << Microseconds(begin - origin_)
+					 << ",\"dur\":" << Microseconds(end - begin) << '}';
+			}
+
+		private:
+			void Begin(std::string_view name, std::string_view phase, std::size_t thread)
+			{
+				out_ << (bFirst_ ? "\n" : ",\n") << "{\"name\":";
+				WriteString(out_, name);
+				out_ << ",\"ph\":\"" << phase << "\",\"pid\":1,\"tid\":" << thread;
+				bFirst_ = false;
+			}
+
+			static double Microseconds(Clock::duration duration)
+			{
+				return std::chrono::duration<double, std::micro>{duration}.count();
+			}
+
+		private:
+			std::ostream& out_;
+			Clock::time_point const origin_;
+			bool bFirst_{true};
+		};
+	}
+
+	TraceCapture TraceCapture::FromProfiler(Profiler const& profiler, std::size_t frameCount)
+	{
+		auto const& frames{profiler.Frames()};
+		auto const count{std::min(frameCount, frames.size())};
+		return {
+			{frames.end() - static_cast<std::ptrdiff_t>(count), frames.end()},
+			profiler.ThreadNames()
+		};
+	}
+
+	void WriteTrace(std::ostream& out, TraceCapture const& capture)
+	{
+		// a frame begins where the one before it ended; the first one, where its first zone began.
+		auto origin{Clock::time_point::max()};
+		for (auto const& frame : capture.frames)
+		{
+			origin = std::min(origin, frame.end);
+			for (auto const& zone : frame.zones)
+			{
+				origin = std::min(origin, zone.begin);
+			}
+		}
+
+		auto const flags{out.flags()};
+		auto const precision{out.precision()};
+		out << "{\"traceEvents\":[" << std::fixed << std::setprecision(3);
+		EventWriter events{out, origin};
+		for (std::size_t thread{}; thread < capture.threadNames.size(); ++thread)
+		{
+			events.ThreadName(thread, capture.threadNames[thread]);
+		}
+		auto const framesThread{capture.threadNames.size()};
+		events.ThreadName(framesThread, "Frames");
+
+		std::optional<Clock::time_point> lastEnd{};
+		for (auto const& frame : capture.frames)
+		{
+			for (auto const& zone : frame.zones)
+			{
+				events.Complete(zone.name, "zone", zone.thread, zone.begin, zone.end);
+			}
+
+			auto begin{lastEnd};
+			if (not begin and not frame.zones.empty())
+			{
+				begin = std::ranges::min(frame.zones, {}, &ProfiledZone::begin).begin;
+			}
+			if (begin)
+			{
+				events.Complete("Frame " + std::to_string(frame.index), "frame", framesThread, *begin, frame.end);
+			}
+			lastEnd = frame.end;
+		}
+		out << "\n],\"displayTimeUnit\":\"ms\"}";
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	TraceWriter::TraceWriter() : thread_{[this](std::stop_token stop) { Loop(stop); }}
+	{
+	}
+	TraceWriter::~TraceWriter()
+	{
+		thread_.request_stop();
+	}
+	void TraceWriter::Write(std::filesystem::path file, TraceCapture capture)
+	{
+		{
+			std::scoped_lock lock{mutex_};
+			RethrowError();
+			queue_.emplace_back(std::move(file), std::move(capture));
+		}
+		changed_.notify_all();
+	}
+	void TraceWriter::Wait()
+	{
+		std::unique_lock lock{mutex_};
+		changed_.wait(lock, [this] { return queue_.empty() and not bWriting_; });
+		RethrowError();
+	}
+	std::size_t TraceWriter::WrittenCount() const
+	{
+		std::scoped_lock lock{mutex_};
+		return writtenCount_;
+	}
+	void TraceWriter::Loop(std::stop_token stop)
+	{
+		std::unique_lock lock{mutex_};
+		while (true)
+		{
+			// once stopped, it keeps going until the queue is empty.
+			changed_.wait(lock, stop, [this] { return not queue_.empty(); });
+			if (queue_.empty())
+			{
+				return;
+			}
+
+			auto const [file, capture]{std::move(queue_.front())};
+			queue_.pop_front();
+			bWriting_ = true;
+			lock.unlock();
+
+			std::exception_ptr pError{};
+			try
+			{
+				WriteFile(file, capture);
+			}
+			catch (...)
+			{
+				pError = std::current_exception();
+			}
+
+			lock.lock();
+			bWriting_ = false;
+			if (pError)
+			{
+				pError_ = pError;
+			}
+			else
+			{
+				++writtenCount_;
+			}
+			changed_.notify_all();
+		}
+	}
+	void TraceWriter::RethrowError()
+	{
+		if (pError_)
+		{
+			std::rethrow_exception(std::exchange(pError_, nullptr));
+		}
+	}
+	void TraceWriter::WriteFile(std::filesystem::path const& file, TraceCapture const& capture)
+	{
+		auto temporary{file};
+		temporary += ".tmp";
+		{
+			std::ofstream out{temporary, std::ios::binary};
+			if (not out)
+			{
+				throw std::runtime_error{"Failed to create " + temporary.string()};
+			}
+			WriteTrace(out, capture);
+			if (not out.flush())
+			{
+				throw std::runtime_error{"Failed to write " + temporary.string()};
+			}
+		}
+		std::filesystem::rename(temporary, file);
+	}
+}
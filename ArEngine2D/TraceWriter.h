@@ -0,0 +1,193 @@
+#pragma once
+
+#include "ISingle.h"
+#include "Profiler.h"
+#include "Testing/ArTest20.h"
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief a copy of some of the frames a Profiler kept, which can be written on another thread.
+	*/
+	struct TraceCapture
+	{
+		std::vector<ProfiledFrame> frames;
+		// indexed by ProfiledZone::thread.
+		std::vector<std::string> threadNames;
+
+		/**
+		 * @brief copies the last frameCount frames of the profiler (all of them if it kept fewer).
+		*/
+		static TraceCapture FromProfiler(Profiler const& profiler, std::size_t frameCount = Profiler::sc_DefaultHistory);
+	};
+
+	/**
+	 * @brief writes the capture as Chrome trace event JSON, which Perfetto (ui.perfetto.dev) and
+	 *		  chrome://tracing open: every zone is a complete event on the track of its thread,
+	 *		  and every frame is one on a "Frames" track of its own, from the end of the frame
+	 *		  before it to its own. times are in microseconds from the first thing in the capture.
+	*/
+	void WriteTrace(std::ostream& out, TraceCapture const& capture);
+
+	/**
+	 * @brief writes captures to files on a thread of its own, one after the other, so the one who
+	 *		  captures only pays for the copy. a file is written next to its path first, and only
+	 *		  renamed to it once it's complete.
+	 *		  what fails on the thread is thrown again by the next Write or Wait.
+	*/
+	class TraceWriter : Details::ISingle
+	{
+	public:
+
+		TraceWriter();
+
+		/**
+		 * @brief writes everything that was queued, then stops the thread.
+		*/
+		~TraceWriter();
+
+	public:
+
+		/**
+		 * @brief queues the capture to be written to file.
+		*/
+		void Write(std::filesystem::path file, TraceCapture capture);
+
+		/**
+		 * @brief blocks until every queued capture is written.
+		*/
+		void Wait();
+
+		/**
+		 * @return the captures written so far.
+		*/
+		std::size_t WrittenCount() const;
+
+	private:
+		void Loop(std::stop_token stop);
+		// throws what the thread failed with last; the mutex must be held.
+		void RethrowError();
+		static void WriteFile(std::filesystem::path const& file, TraceCapture const& capture);
+
+	private:
+		mutable std::mutex mutex_{};
+		std::condition_variable_any changed_{};
+		std::deque<std::pair<std::filesystem::path, TraceCapture>> queue_{};
+		bool bWriting_{};
+		std::size_t writtenCount_{};
+		std::exception_ptr pError_{};
+
+		// last, so it starts after everything it uses.
+		std::jthread thread_;
+	};
+
+	inline void TestTraceWriter()
+	{
+		using namespace ArTest;
+		std::ofstream file{"TraceWriterTestResults.txt"};
+		Tester tester{file};
+
+		auto const count = [](std::string const& text, std::string_view what) {
+			std::size_t found{};
+			for (auto pos{text.find(what)}; pos != std::string::npos; pos = text.find(what, pos + what.size()))
+			{
+				++found;
+			}
+			return found;
+		};
+
+		tester.NewTest("Trace events") = [&] {
+			Profiler profiler{};
+			profiler.SetThreadName("Main \"1\"");
+			for (int frame{}; frame < 3; ++frame)
+			{
+				AR2D_PROFILE_ZONE(profiler, "Update");
+				{
+					AR2D_PROFILE_ZONE(profiler, "Inner");
+				}
+				std::thread worker{[&] { AR2D_PROFILE_ZONE(profiler, "Work"); }};
+				worker.join();
+			}
+			profiler.EndFrame();
+			{
+				AR2D_PROFILE_ZONE(profiler, "Update");
+			}
+			profiler.EndFrame();
+
+			auto const capture{TraceCapture::FromProfiler(profiler)};
+			tester.PassIfEqual(capture.frames.size(), std::size_t{2U});
+			tester.PassIfEqual(capture.threadNames.size(), std::size_t{2U});
+			tester.PassIfEqual(std::uint64_t{TraceCapture::FromProfiler(profiler, 1U).frames.front().index}, std::uint64_t{1U});
+
+			std::ostringstream out{};
+			WriteTrace(out, capture);
+			auto const json{std::move(out).str()};
+			tester.PassIfEqual(json.find("{\"traceEvents\":["), std::size_t{0U});
+			tester.PassIfEqual(json.back(), '}');
+			tester.PassIfEqual(count(json, "{"), count(json, "}"));
+			tester.PassIfEqual(count(json, "\"ph\":\"X\""), std::size_t{12U});
+			tester.PassIfEqual(count(json, "\"name\":\"Update\""), std::size_t{4U});
+			tester.PassIfEqual(count(json, "\"name\":\"Work\""), std::size_t{3U});
+			tester.PassIfEqual(count(json, "\"name\":\"Frame 1\""), std::size_t{1U});
+			tester.PassIfEqual(count(json, "\"name\":\"thread_name\""), std::size_t{3U});
+			// escaped.
+			tester.PassIfEqual(count(json, "\"Main \\\"1\\\"\""), std::size_t{1U});
+			tester.PassIfEqual(count(json, "\"ts\":-"), std::size_t{0U});
+		};
+
+		tester.NewTest("Written in the background") = [&] {
+			Profiler profiler{};
+			for (int frame{}; frame < 10; ++frame)
+			{
+				{
+					AR2D_PROFILE_ZONE(profiler, "Frame");
+				}
+				profiler.EndFrame();
+			}
+
+			auto const path{std::filesystem::temp_directory_path() / "ArEngine2DTraceWriterTest.json"};
+			TraceWriter writer{};
+			writer.Write(path, TraceCapture::FromProfiler(profiler, 5U));
+			writer.Write(path, TraceCapture::FromProfiler(profiler));
+			writer.Wait();
+			tester.PassIfEqual(writer.WrittenCount(), std::size_t{2U});
+
+			std::ifstream in{path};
+			std::string const json{std::istreambuf_iterator<char>{in}, std::istreambuf_iterator<char>{}};
+			in.close();
+			// the second capture, which has every frame.
+			tester.PassIfEqual(count(json, "\"cat\":\"frame\""), std::size_t{10U});
+			tester.PassIf(not std::filesystem::exists(path.string() + ".tmp"));
+			std::filesystem::remove(path);
+
+			bool bThrew{};
+			writer.Write(std::filesystem::path{"missing directory"} / "trace.json", TraceCapture::FromProfiler(profiler));
+			try
+			{
+				writer.Wait();
+			}
+			catch (std::runtime_error const&)
+			{
+				bThrew = true;
+			}
+			tester.PassIf(bThrew);
+			tester.PassIfEqual(writer.WrittenCount(), std::size_t{2U});
+		};
+
+		tester.OutputResults();
+	}
+}
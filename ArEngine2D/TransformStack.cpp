@@ -0,0 +1,47 @@
+#include "TransformStack.h"
+
+#include <cassert>
+
+namespace ArEngine2D {
+	TransformStack::TransformStack()
+	{
+		composed_.reserve(sc_InitialCapacity);
+		levels_.reserve(sc_InitialCapacity);
+		composed_.push_back(RawMatrix::Identity());
+	}
+	void TransformStack::Push(RawMatrix const& transform)
+	{
+		levels_.push_back(static_cast<std::uint32_t>(composed_.size()));
+		composed_.push_back(composed_.back() * transform);
+	}
+	void TransformStack::Pop() noexcept
+	{
+		assert(not levels_.empty() && "Tried to pop an empty transform stack");
+		// shrinking a vector never frees, so the next push is allocation free.
+		composed_.resize(levels_.back());
+		levels_.pop_back();
+	}
+	void TransformStack::Append(RawMatrix const& transform)
+	{
+		composed_.push_back(composed_.back() * transform);
+	}
+	void TransformStack::Undo() noexcept
+	{
+		assert(composed_.size() > 1U and (levels_.empty() or composed_.size() > levels_.back() + 1U)
+			&& "Tried to undo a transform that was never appended");
+		composed_.pop_back();
+	}
+	void TransformStack::Reset() noexcept
+	{
+		composed_.resize(1U);
+		levels_.clear();
+	}
+	RawMatrix const& TransformStack::Top() const noexcept
+	{
+		return composed_.back();
+	}
+	std::size_t TransformStack::Depth() const noexcept
+	{
+		return levels_.size();
+	}
+}
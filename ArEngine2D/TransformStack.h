@@ -0,0 +1,172 @@
+#pragma once
+
+#include "RawTypes.h"
+#include "Testing/ArTest20.h"
+
+#include <chrono>
+#include <cstdint>
+#include <stack>
+#include <vector>
+
+namespace ArEngine2D {
+	/**
+	 * @brief the transforms pushed while drawing, in two flat arrays that only ever grow, so pushing
+	 *		  and popping does not allocate once the deepest hierarchy was seen. every level keeps the
+	 *		  composed matrix, so the current transform is always a read away.
+	 *		  does not depend on direct2d; Grafix keeps its transforms in one.
+	*/
+	class TransformStack
+	{
+	public:
+
+		constexpr static std::size_t sc_InitialCapacity{64U};
+
+	public:
+
+		TransformStack();
+
+	public:
+
+		/**
+		 * @brief starts a new level; the transform is applied after everything pushed so far.
+		*/
+		void Push(RawMatrix const& transform);
+
+		/**
+		 * @brief drops the current level, along with everything appended to it.
+		*/
+		void Pop() noexcept;
+
+		/**
+		 * @brief same as Push, but undone one at a time with Undo, and all at once by Pop.
+		*/
+		void Append(RawMatrix const& transform);
+		void Undo() noexcept;
+
+		/**
+		 * @brief back to the identity, with nothing pushed; keeps the memory.
+		*/
+		void Reset() noexcept;
+
+	public:
+
+		RawMatrix const& Top() const noexcept;
+
+		/**
+		 * @return the number of levels pushed and not popped yet.
+		*/
+		std::size_t Depth() const noexcept;
+
+	private:
+		// composed_[0] is always the identity.
+		std::vector<RawMatrix> composed_{};
+		// where every level starts in composed_.
+		std::vector<std::uint32_t> levels_{};
+	};
+
+	inline void TestTransformStack()
+	{
+		using namespace ArTest;
+		std::ofstream file{"TransformStackTestResults.txt"};
+		Tester tester{file};
+
+		constexpr auto a{RawMatrix::Translation(1.f, 0.f)};
+		constexpr auto b{RawMatrix{2.f, 0.f, 0.f, 2.f, 0.f, 0.f}};
+		constexpr auto c{RawMatrix::Translation(0.f, 5.f)};
+
+		tester.NewTest("Push and pop") = [&] {
+			TransformStack stack{};
+			tester.PassIf(stack.Top() == RawMatrix::Identity());
+			stack.Push(a);
+			stack.Push(b);
+			tester.PassIf(stack.Top() == a * b);
+			tester.PassIfEqual(stack.Depth(), 2U);
+			stack.Pop();
+			tester.PassIf(stack.Top() == a);
+			stack.Pop();
+			tester.PassIf(stack.Top() == RawMatrix::Identity());
+		};
+
+		tester.NewTest("Append and undo") = [&] {
+			TransformStack stack{};
+			stack.Push(a);
+			stack.Append(b);
+			stack.Append(c);
+			tester.PassIf(stack.Top() == a * b * c);
+			stack.Undo();
+			tester.PassIf(stack.Top() == a * b);
+			stack.Append(c);
+			// popping drops the appends of the level too.
+			stack.Pop();
+			tester.PassIf(stack.Top() == RawMatrix::Identity());
+			tester.PassIfEqual(stack.Depth(), 0U);
+
+			stack.Push(c);
+			stack.Reset();
+			tester.PassIf(stack.Top() == RawMatrix::Identity());
+			tester.PassIfEqual(stack.Depth(), 0U);
+		};
+
+		tester.OutputResults();
+	}
+
+	/**
+	 * @brief compares the stack against the nested std::stack Grafix used to keep, over push and pop
+	 *		  sequences as deep as depth; writes TransformStackBenchmark.txt.
+	*/
+	inline void BenchmarkTransformStack(std::size_t depth = 32U, std::size_t rounds = 100'000U)
+	{
+		std::ofstream file{"TransformStackBenchmark.txt"};
+		constexpr auto step{RawMatrix{0.99f, 0.01f, -0.01f, 0.99f, 1.f, 2.f}};
+		using Ms = std::chrono::duration<double, std::milli>;
+
+		// keeps the work from being optimized away.
+		float sink{};
+
+		auto const nestedStart{std::chrono::steady_clock::now()};
+		for (std::size_t round{}; round < rounds; ++round)
+		{
+			std::stack<std::stack<RawMatrix>> nested{};
+			nested.push({});
+			nested.top().push(RawMatrix::Identity());
+			auto current{RawMatrix::Identity()};
+			for (std::size_t i{}; i < depth; ++i)
+			{
+				nested.push({});
+				nested.top().push(current);
+				current = current * step;
+				sink += current.dx;
+			}
+			for (std::size_t i{}; i < depth; ++i)
+			{
+				current = nested.top().top();
+				nested.pop();
+				sink += current.dx;
+			}
+		}
+		Ms const nestedTime{std::chrono::steady_clock::now() - nestedStart};
+
+		TransformStack stack{};
+		auto const flatStart{std::chrono::steady_clock::now()};
+		for (std::size_t round{}; round < rounds; ++round)
+		{
+			stack.Reset();
+			for (std::size_t i{}; i < depth; ++i)
+			{
+				stack.Push(step);
+				sink += stack.Top().dx;
+			}
+			for (std::size_t i{}; i < depth; ++i)
+			{
+				stack.Pop();
+				sink += stack.Top().dx;
+			}
+		}
+		Ms const flatTime{std::chrono::steady_clock::now() - flatStart};
+
+		file << rounds << " rounds of " << depth << " pushes and pops\n"
+			 << "nested std::stack: " << nestedTime.count() << " ms\n"
+			 << "TransformStack: " << flatTime.count() << " ms, speedup " << nestedTime.count() / flatTime.count() << '\n'
+			 << "(checksum " << sink << ")\n";
+	}
+}
@@ -0,0 +1,71 @@
+#include "UpdateThread.h"
+
+#include <cassert>
+
+namespace ArEngine2D {
+	UpdateThread::UpdateThread(Update update)
+		: update_{std::move(update)}, thread_{[this](std::stop_token stop) { Loop(stop); }}
+	{
+		assert(update_ && "UpdateThread needs an update to run");
+	}
+	UpdateThread::~UpdateThread()
+	{
+		if (bRunning_)
+		{
+			done_.acquire();
+		}
+		thread_.request_stop();
+		start_.release();
+	}
+	void UpdateThread::Start(float dt)
+	{
+		assert(not bRunning_ && "Tried to start an update before waiting for the last one");
+		dt_ = dt;
+		bRunning_ = true;
+		start_.release();
+	}
+	void UpdateThread::Wait()
+	{
+		if (not bRunning_)
+		{
+			return;
+		}
+		done_.acquire();
+		bRunning_ = false;
+		if (pError_)
+		{
+			std::rethrow_exception(std::exchange(pError_, nullptr));
+		}
+	}
+	bool UpdateThread::IsRunning() const noexcept
+	{
+		return bRunning_;
+	}
+	UpdateThread::Clock::duration UpdateThread::LastDuration() const noexcept
+	{
+		return lastDuration_;
+	}
+	void UpdateThread::Loop(std::stop_token stop)
+	{
+		while (true)
+		{
+			start_.acquire();
+			if (stop.stop_requested())
+			{
+				return;
+			}
+
+			auto const start{Clock::now()};
+			try
+			{
+				update_(dt_);
+			}
+			catch (...)
+			{
+				pError_ = std::current_exception();
+			}
+			lastDuration_ = Clock::now() - start;
+			done_.release();
+		}
+	}
+}
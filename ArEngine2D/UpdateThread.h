@@ -0,0 +1,255 @@
+#pragma once
+
+#include "ISingle.h"
+#include "FrameState.h"
+#include "FixedTimestep.h"
+#include "Testing/ArTest20.h"
+
+#include <chrono>
+#include <exception>
+#include <functional>
+#include <semaphore>
+#include <stdexcept>
+#include <thread>
+
+namespace ArEngine2D {
+	/**
+	 * @brief one thread that runs the update whenever it's told to, so the caller can draw meanwhile.
+	 *		  Start and Wait alternate, and both are called from the same thread; between a Wait and
+	 *		  the next Start the update is not running, which is when the two sides hand data over.
+	 *		  what the update throws is thrown again by Wait.
+	*/
+	class UpdateThread : Details::ISingle
+	{
+	public:
+
+		using Update = std::function<void(float)>;
+		using Clock = std::chrono::steady_clock;
+
+	public:
+
+		explicit UpdateThread(Update update);
+
+		/**
+		 * @brief waits for a running update, then stops the thread.
+		*/
+		~UpdateThread();
+
+	public:
+
+		/**
+		 * @brief runs update(dt) on the thread; the last one must have been waited for.
+		*/
+		void Start(float dt);
+
+		/**
+		 * @brief blocks until the update that was started is done, and rethrows what it threw.
+		*/
+		void Wait();
+
+	public:
+
+		bool IsRunning() const noexcept;
+
+		/**
+		 * @return how long the last finished update took; only valid after Wait.
+		*/
+		Clock::duration LastDuration() const noexcept;
+
+	private:
+		void Loop(std::stop_token stop);
+
+	private:
+		Update update_;
+		std::binary_semaphore start_{0};
+		std::binary_semaphore done_{0};
+		bool bRunning_{};
+
+		// written by the thread before done_ is released, read after it was acquired.
+		float dt_{};
+		Clock::duration lastDuration_{};
+		std::exception_ptr pError_{};
+
+		// last, so it starts after everything it uses.
+		std::jthread thread_;
+	};
+
+	/**
+	 * @brief times a loop that spins updateMs then drawMs every frame, once one after the other and
+	 *		  once with the update on an UpdateThread; writes FramePipeliningBenchmark.txt.
+	 *		  the frame time is how often a frame is presented, the latency is from the start of the
+	 *		  update (when input is read) to the end of the draw that shows it.
+	*/
+	inline void BenchmarkFramePipelining(double updateMs = 8.0, double drawMs = 8.0, std::size_t frames = 240U)
+	{
+		using Ms = std::chrono::duration<double, std::milli>;
+		using Clock = UpdateThread::Clock;
+		std::ofstream file{"FramePipeliningBenchmark.txt"};
+
+		auto const spin = [](double ms) {
+			auto const end{Clock::now() + std::chrono::duration_cast<Clock::duration>(Ms{ms})};
+			while (Clock::now() < end)
+			{
+			}
+		};
+
+		Ms serialLatency{};
+		auto const serialStart{Clock::now()};
+		for (std::size_t frame{}; frame < frames; ++frame)
+		{
+			auto const updateStart{Clock::now()};
+			spin(updateMs);
+			spin(drawMs);
+			serialLatency += Clock::now() - updateStart;
+		}
+		Ms const serialTime{Clock::now() - serialStart};
+
+		// the same order as Engine: start the next update, draw the last one, wait, hand over.
+		Ms pipelinedLatency{};
+		Clock::time_point pendingStart{};
+		Clock::time_point drawnStart{};
+		UpdateThread updates{[&](float) { spin(updateMs); }};
+		auto const pipelinedStart{Clock::now()};
+		for (std::size_t frame{}; frame <= frames; ++frame)
+		{
+			if (frame < frames)
+			{
+				pendingStart = Clock::now();
+				updates.Start(0.f);
+			}
+			if (frame > 0U)
+			{
+				spin(drawMs);
+				pipelinedLatency += Clock::now() - drawnStart;
+			}
+			if (frame < frames)
+			{
+				updates.Wait();
+				drawnStart = pendingStart;
+			}
+		}
+		Ms const pipelinedTime{Clock::now() - pipelinedStart};
+
+		auto const count{static_cast<double>(frames)};
+		file << frames << " frames, " << updateMs << " ms update, " << drawMs << " ms draw\n"
+			 << "serial: " << serialTime.count() / count << " ms/frame (" << 1000.0 * count / serialTime.count()
+			 << " fps), latency " << serialLatency.count() / count << " ms\n"
+			 << "pipelined: " << pipelinedTime.count() / count << " ms/frame (" << 1000.0 * count / pipelinedTime.count()
+			 << " fps), latency " << pipelinedLatency.count() / count << " ms\n";
+	}
+
+	inline void TestUpdateThread()
+	{
+		using namespace ArTest;
+		std::ofstream file{"UpdateThreadTestResults.txt"};
+		Tester tester{file};
+
+		tester.NewTest("Runs on another thread") = [&] {
+			std::thread::id updateThreadId{};
+			float seenDt{};
+			UpdateThread updates{[&](float dt) {
+				updateThreadId = std::this_thread::get_id();
+				seenDt = dt;
+			}};
+			tester.PassIf(not updates.IsRunning());
+			updates.Start(0.25f);
+			tester.PassIf(updates.IsRunning());
+			updates.Wait();
+			tester.PassIf(not updates.IsRunning());
+			tester.PassIf(updateThreadId != std::this_thread::get_id());
+			tester.PassIfEqual(float{seenDt}, 0.25f);
+		};
+
+		tester.NewTest("Errors reach Wait") = [&] {
+			UpdateThread updates{[](float dt) {
+				if (dt < 0.f)
+				{
+					throw std::runtime_error{"negative"};
+				}
+			}};
+			updates.Start(-1.f);
+			bool bThrew{};
+			try
+			{
+				updates.Wait();
+			}
+			catch (std::runtime_error const&)
+			{
+				bThrew = true;
+			}
+			tester.PassIf(bThrew);
+			// the thread keeps going.
+			updates.Start(1.f);
+			updates.Wait();
+			tester.PassIf(not updates.IsRunning());
+		};
+
+		tester.NewTest("Frame state handoff") = [&] {
+			FrameState<int> state{-1};
+			int simulated{};
+			UpdateThread updates{[&](float) { state.Back() = ++simulated; }};
+
+			// every draw sees the frame that was published before it, never the one being made.
+			bool bInOrder{true};
+			for (int frame{}; frame < 100; ++frame)
+			{
+				updates.Start(0.f);
+				bInOrder = bInOrder and state.Front() == (frame == 0 ? -1 : frame);
+				updates.Wait();
+				state.Publish();
+			}
+			tester.PassIf(bInOrder);
+			tester.PassIfEqual(state.Front(), 100);
+			tester.PassIfEqual(state.PublishCount(), std::size_t{100U});
+		};
+
+		tester.NewTest("Frames without steps publish nothing") = [&] {
+			// like Engine: the update makes one state per fixed step, and only frames that ran a
+			// step hand it over; frames of 4 ms at 10 ms steps often run none.
+			FixedTimestep timestep{0.01f};
+			FrameState<int> state{0};
+			int simulated{};
+			std::uint32_t steps{};
+			UpdateThread updates{[&](float dt) {
+				steps = timestep.Advance(dt);
+				for (std::uint32_t step{}; step < steps; ++step)
+				{
+					state.Back() = ++simulated;
+				}
+			}};
+
+			bool bNeverBack{true};
+			std::size_t emptyFrames{};
+			for (int frame{}; frame < 100; ++frame)
+			{
+				auto const drawn{state.Front()};
+				updates.Start(0.004f);
+				updates.Wait();
+				if (steps == 0U)
+				{
+					++emptyFrames;
+					continue;
+				}
+				state.Publish();
+				bNeverBack = bNeverBack and state.Front() > drawn and state.Front() == simulated;
+			}
+			tester.PassIf(bNeverBack);
+			tester.PassIfGreater(std::size_t{emptyFrames}, std::size_t{0U});
+			tester.PassIfEqual(state.Front(), int{simulated});
+		};
+
+		tester.NewTest("Destroyed while running") = [&] {
+			bool bFinished{};
+			{
+				UpdateThread updates{[&](float) {
+					std::this_thread::sleep_for(std::chrono::milliseconds{5});
+					bFinished = true;
+				}};
+				updates.Start(0.f);
+			}
+			tester.PassIf(bFinished);
+		};
+
+		tester.OutputResults();
+	}
+}
@@ -15,6 +15,10 @@ namespace ArEngine2D
 	{
 		Initialize();
 	}
+	Window::Window(std::int32_t width, std::int32_t height)
+		: handle_{}, width_{width}, height_{height}, x_{}, y_{}, bHeadless_{true}
+	{
+	}
 	Window::~Window()
 	{
 		if (handle_)
@@ -26,7 +30,21 @@ namespace ArEngine2D
 	void Window::UpdateTitle() noexcept
 	{
 		// may fail yes but, I have never had it fail on me.
-		SetWindowTextA(handle_, title_.data());
+		if (not bHeadless_)
+		{
+			SetWindowTextA(handle_, title_.data());
+		}
+	}
+	void Window::Close() noexcept
+	{
+		if (bHeadless_)
+		{
+			bCloseRequested_ = true;
+		}
+		else
+		{
+			PostMessageW(handle_, WM_CLOSE, 0U, 0U);
+		}
 	}
 	void Window::Initialize()
 	{
@@ -82,6 +100,11 @@ namespace ArEngine2D
 	}
 	auto Window::ProcessMessages() noexcept -> bool
 	{
+		if (bHeadless_)
+		{
+			return not bCloseRequested_;
+		}
+
 		MSG msg{};
 		while (PeekMessageW(&msg, handle_, 0U, 0U, PM_REMOVE))
 		{
@@ -91,6 +114,15 @@ namespace ArEngine2D
 
 		return IsWindow(handle_);
 	}
+	void Window::WaitForMessages(DWORD milliseconds) noexcept
+	{
+		if (bHeadless_)
+		{
+			return;
+		}
+		// also wakes for input that was already queued but not read yet.
+		MsgWaitForMultipleObjectsEx(0U, nullptr, milliseconds, QS_ALLINPUT, MWMO_INPUTAVAILABLE);
+	}
 	void Window::InputUpdate() noexcept
 	{
 		keyboard.FrameUpdate();
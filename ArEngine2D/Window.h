@@ -28,6 +28,12 @@ namespace ArEngine2D {
 		 * @param height => the actual height of the client area.
 		*/
 		Window(std::string_view title, std::int32_t width, std::int32_t height, std::int32_t x = 0, std::int32_t y = 0);
+
+		/**
+		 * @brief headless constructor; no actual window is created, and there is no input.
+		 *		  the engine keeps running until Close is called.
+		*/
+		Window(std::int32_t width, std::int32_t height);
 		~Window();
 
 	public:
@@ -45,9 +51,16 @@ namespace ArEngine2D {
 		*/
 		void UpdateTitle() noexcept;
 
+		/**
+		 * @brief asks the window to close; the engine stops after the current frame.
+		*/
+		void Close() noexcept;
+
 	protected:
 		void Initialize();
 		auto ProcessMessages() noexcept -> bool;
+		// blocks until input or another message arrives, or the time runs out; returns right away headless.
+		void WaitForMessages(DWORD milliseconds) noexcept;
 		
 		void InputUpdate() noexcept;
 
@@ -109,6 +122,12 @@ namespace ArEngine2D {
 		constexpr auto IsRawInputEnabled() const noexcept
 		{ return s_bRawInputEnabled_; }
 
+		/**
+		 * @return true if this window was made with the headless constructor.
+		*/
+		constexpr auto IsHeadless() const noexcept
+		{ return bHeadless_; }
+
 	public:
 
 		/**
@@ -133,6 +152,9 @@ namespace ArEngine2D {
 		std::string title_;
 		std::wstring wtitle_;
 
+		bool bHeadless_{};
+		bool bCloseRequested_{};
+
 		inline static bool s_bRawInputEnabled_{};
 		inline static bool s_bRawInputInitialized_{};
 		std::vector<std::byte> rawInputData{};
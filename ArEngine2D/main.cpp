@@ -4,14 +4,25 @@
 #include <filesystem>
 #include <execution>
 #include <iostream>
+#include <string_view>
 
 #include "Random.h"
 #include "GuiGame.h"
 
 
 //INT WinMain(_In_ HINSTANCE, _In_opt_ HINSTANCE, _In_ PSTR, _In_ INT)
-int main()
+// ArEngine2D.exe --headless [frames] [output dir] renders without a window, saving captures and timings.
+int main(int argc, char* argv[])
 {
+	if (argc > 1 and std::string_view{argv[1]} == "--headless")
+	{
+		auto const frames{argc > 2 ? static_cast<std::uint32_t>(std::stoul(argv[2])) : 300U};
+		std::filesystem::path const outputDir{argc > 3 ? argv[3] : "Captures"};
+		ArGui::GuiGame engine{1280, 720};
+		engine.RunFrames(frames, outputDir, 60U);
+		return 0;
+	}
+
 	ArGui::GuiGame engine{"my eng", 1280, 720};
 	engine.Run();
 	return 0;